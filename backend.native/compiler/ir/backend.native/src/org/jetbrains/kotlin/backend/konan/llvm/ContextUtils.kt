@@ -459,6 +459,7 @@ internal class Llvm(val context: Context, val llvmModule: LLVMModuleRef) {
     val isInstanceOfClassFastFunction = importRtFunction("IsInstanceOfClassFast")
     val throwExceptionFunction = importRtFunction("ThrowException")
     val appendToInitalizersTail = importRtFunction("AppendToInitializersTail")
+    val visitGlobalRoot = importRtFunction("VisitGlobalRoot")
     val addTLSRecord = importRtFunction("AddTLSRecord")
     val clearTLSRecord = importRtFunction("ClearTLSRecord")
     val lookupTLS = importRtFunction("LookupTLS")
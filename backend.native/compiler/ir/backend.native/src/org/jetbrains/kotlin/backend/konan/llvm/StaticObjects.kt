@@ -26,14 +26,30 @@ private fun StaticData.objHeader(typeInfo: ConstPointer): Struct {
     return Struct(runtime.objHeaderType, permanentTag(typeInfo))
 }
 
-private fun StaticData.arrayHeader(typeInfo: ConstPointer, length: Int): Struct {
+private fun StaticData.arrayHeader(typeInfo: ConstPointer, length: Int, hashCode: Int = 0): Struct {
     assert (length >= 0)
-    return Struct(runtime.arrayHeaderType, permanentTag(typeInfo), Int32(length))
+    // Must match ArrayHeader in C++, which has the string hash code field on 64-bit targets only.
+    return if (getStructElements(runtime.arrayHeaderType).size > 2) {
+        Struct(runtime.arrayHeaderType, permanentTag(typeInfo), Int32(length), Int32(hashCode))
+    } else {
+        Struct(runtime.arrayHeaderType, permanentTag(typeInfo), Int32(length))
+    }
+}
+
+// Must match computeHashCode() in KString.cpp: text fitting into Latin-1 is hashed as such, and as UTF-16 otherwise.
+// Targets with the hash code field are little-endian.
+private fun stringHashCode(value: String): Int {
+    val bytes = if (value.all { it.toInt() < 0x100 }) {
+        ByteArray(value.length) { value[it].toByte() }
+    } else {
+        ByteArray(value.length * Char.SIZE_BYTES) { (value[it / 2].toInt() shr (8 * (it % 2))).toByte() }
+    }
+    return localHash(bytes).toInt()
 }
 
 internal fun StaticData.createKotlinStringLiteral(value: String): ConstPointer {
     val elements = value.toCharArray().map(::Char16)
-    val objRef = createConstKotlinArray(context.ir.symbols.string.owner, elements)
+    val objRef = createConstKotlinArray(context.ir.symbols.string.owner, elements, stringHashCode(value))
     return objRef
 }
 
@@ -42,7 +58,7 @@ private fun StaticData.createRef(objHeaderPtr: ConstPointer) = objHeaderPtr.bitc
 internal fun StaticData.createConstKotlinArray(arrayClass: IrClass, elements: List<LLVMValueRef>) =
         createConstKotlinArray(arrayClass, elements.map { constValue(it) }).llvm
 
-internal fun StaticData.createConstKotlinArray(arrayClass: IrClass, elements: List<ConstValue>): ConstPointer {
+internal fun StaticData.createConstKotlinArray(arrayClass: IrClass, elements: List<ConstValue>, hashCode: Int = 0): ConstPointer {
     val typeInfo = arrayClass.typeInfoPtr
 
     val bodyElementType: LLVMTypeRef = elements.firstOrNull()?.llvmType ?: int8Type
@@ -54,7 +70,7 @@ internal fun StaticData.createConstKotlinArray(arrayClass: IrClass, elements: Li
     val global = this.createGlobal(compositeType, "")
 
     val objHeaderPtr = global.pointer.getElementPtr(0)
-    val arrayHeader = arrayHeader(typeInfo, elements.size)
+    val arrayHeader = arrayHeader(typeInfo, elements.size, hashCode)
 
     global.setInitializer(Struct(compositeType, arrayHeader, arrayBody))
     global.setConstant(true)
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.container_cache
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+
+class Holder(var value: Any?)
+
+// Allocates objects of various sizes filled with non-zero data, and drops them.
+fun churn(round: Int) {
+    val holder = Holder(null)
+    for (index in 0 until 300) {
+        val size = (index * 7 + round) % 40 + 1
+        holder.value = when (index % 4) {
+            0 -> IntArray(size) { -1 }
+            1 -> LongArray(size) { -1L }
+            2 -> Array<Any?>(size) { holder }
+            else -> Holder(holder)
+        }
+    }
+    holder.value = null
+}
+
+// Arrays are not initialized by the generated code, so they must come from zeroed memory.
+fun checkZeroed(round: Int) {
+    for (index in 0 until 300) {
+        val size = (index * 7 + round) % 40 + 1
+        assertTrue(IntArray(size).all { it == 0 })
+        assertTrue(LongArray(size).all { it == 0L })
+        assertTrue(arrayOfNulls<Any>(size).all { it == null })
+        // Cached hash codes must not be taken from a reused container.
+        val string = "item".repeat(size % 5 + 1) + index
+        assertEquals(string.toCharArray().concatToString().hashCode(), string.hashCode())
+    }
+}
+
+fun checkLimit(limit: Long) {
+    GC.containerCacheLimit = limit
+    assertEquals(limit, GC.containerCacheLimit)
+    assertTrue(GC.containerCacheSize <= limit)
+    repeat(10) { round ->
+        churn(round)
+        GC.collect()
+        assertTrue(GC.containerCacheSize <= limit, "cache of ${GC.containerCacheSize} bytes exceeds $limit")
+        checkZeroed(round)
+    }
+}
+
+@Test fun runTest() {
+    val defaultLimit = GC.containerCacheLimit
+    checkLimit(64 * 1024L)
+    checkLimit(1024L)
+    // Lowering the limit trims the cache right away.
+    GC.containerCacheLimit = 0L
+    assertEquals(0L, GC.containerCacheSize)
+    checkLimit(0L)
+    assertFailsWith<IllegalArgumentException> {
+        GC.containerCacheLimit = -1L
+    }
+    GC.containerCacheLimit = defaultLimit
+    println("OK")
+}
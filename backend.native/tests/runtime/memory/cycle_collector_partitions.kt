@@ -0,0 +1,99 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+import kotlin.native.ref.*
+import kotlin.test.*
+
+class Node(val next: AtomicReference<Any?>)
+
+// Ring of atomics, which are likely to land in different rootset partitions.
+fun makeRing(size: Int): AtomicReference<Any?> {
+    val first = AtomicReference<Any?>(null)
+    var current = first
+    repeat(size - 1) {
+        val next = AtomicReference<Any?>(null)
+        current.value = Node(next).freeze()
+        current = next
+    }
+    current.value = Node(first).freeze()
+    return first
+}
+
+fun ringSize(head: AtomicReference<Any?>): Int {
+    var size = 1
+    var current = (head.value as Node).next
+    while (current !== head) {
+        size++
+        current = (current.value as Node).next
+    }
+    return size
+}
+
+fun makeGarbageRing(size: Int) = WeakReference(makeRing(size))
+
+fun allCleared(weaks: List<WeakReference<AtomicReference<Any?>>>) = weaks.all { it.get() == null }
+
+fun collectCycles() {
+    GC.collect()
+    GC.collectCyclic()
+    repeat(10) {
+        Worker.current.park(10 * 1000L)
+        Worker.current.processQueue()
+        GC.collect()
+    }
+}
+
+fun main() {
+    GC.cyclicCollectorEnabled = true
+    assertTrue(GC.cyclicCollectorThreads > 0)
+    GC.cyclicCollectorThreads = 3
+    assertEquals(3, GC.cyclicCollectorThreads)
+    assertFailsWith<IllegalArgumentException> {
+        GC.cyclicCollectorThreads = 0
+    }
+
+    val alive = makeRing(50)
+    val garbage = List(20) { makeGarbageRing(it + 1) }
+    withWorker {
+        collectCycles()
+        // Garbage is released on the other worker, not on the main one.
+        executeAfter(0L, {
+            GC.collect()
+        }.freeze())
+        collectCycles()
+    }
+    assertEquals(50, ringSize(alive))
+    // Released rings are destroyed once their atomics are cleared, which may take a few more rounds.
+    repeat(100) {
+        if (!allCleared(garbage)) collectCycles()
+    }
+    assertTrue(allCleared(garbage), "Garbage rings must be reclaimed")
+
+    // Atomics are destroyed and removed from the rootset while the collector visits their partitions.
+    val worker = Worker.start()
+    val future = worker.execute(TransferMode.SAFE, { 200 }) { count ->
+        repeat(count) {
+            makeRing(it % 10 + 1)
+            AtomicReference<Any?>(null)
+        }
+        count
+    }
+    while (future.state == FutureState.SCHEDULED) {
+        GC.collectCyclic()
+        Worker.current.park(1000L)
+    }
+    assertEquals(200, future.result)
+    worker.requestTermination().result
+    collectCycles()
+    assertEquals(50, ringSize(alive))
+
+    GC.cyclicCollectorThreads = 1
+    assertEquals(1, GC.cyclicCollectorThreads)
+    collectCycles()
+    assertEquals(50, ringSize(alive))
+    println("OK")
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.cycles_concurrent
+
+import kotlin.test.*
+import kotlin.native.ref.*
+import kotlin.native.internal.GC
+
+class Node(var next: Node?, val payload: Int)
+
+@Test fun runTest() {
+    if (Platform.memoryModel == MemoryModel.RELAXED) {
+        assertFailsWith<IllegalArgumentException> {
+            GC.concurrentCycleCollection = true
+        }
+        println("OK")
+        return
+    }
+    GC.concurrentCycleCollection = true
+    assertTrue(GC.concurrentCycleCollection)
+    val oldThreshold = GC.threshold
+    val oldCollectCyclesThreshold = GC.collectCyclesThreshold
+    GC.threshold = 100
+    GC.collectCyclesThreshold = 10
+    val alive = createLoop(0)
+    val weakRefs = Array(1000) { createWeakLoop(it) }
+    GC.collect()
+    weakRefs.forEach { assertNull(it.get()) }
+    // Cycle still referenced from the stack must survive.
+    assertEquals(alive, alive.next!!.next)
+    assertTrue(GC.pausePercentileMicros(99.0) >= GC.pausePercentileMicros(50.0))
+    assertFailsWith<IllegalArgumentException> {
+        GC.pausePercentileMicros(101.0)
+    }
+    GC.threshold = oldThreshold
+    GC.collectCyclesThreshold = oldCollectCyclesThreshold
+    GC.concurrentCycleCollection = false
+    println("OK")
+}
+
+private fun createLoop(index: Int): Node {
+    val first = Node(null, index)
+    first.next = Node(first, index)
+    return first
+}
+
+private fun createWeakLoop(index: Int): WeakReference<Node> = WeakReference(createLoop(index))
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.cycles_incremental
+
+import kotlin.test.*
+import kotlin.native.ref.*
+import kotlin.native.internal.GC
+
+class Node(var next: Node?, var other: Node?, val payload: Int)
+
+@Test fun runTest() {
+    assertFailsWith<IllegalArgumentException> {
+        GC.pauseTargetMicros = -1
+    }
+    if (Platform.memoryModel == MemoryModel.RELAXED) {
+        println("OK")
+        return
+    }
+    val oldThreshold = GC.threshold
+    val oldCollectCyclesThreshold = GC.collectCyclesThreshold
+    GC.pauseTargetMicros = 1
+    assertEquals(1L, GC.pauseTargetMicros)
+    GC.threshold = 300
+    GC.collectCyclesThreshold = 10
+    val alive = createLoop(0, null)
+    // Garbage cycles referring to each other, so that slices meet candidates of other slices.
+    var previous: Node? = null
+    val weakRefs = Array(5000) {
+        val loop = createLoop(it, previous)
+        previous = loop
+        WeakReference(loop)
+    }
+    previous = null
+    // Regular collections, each doing a bounded amount of cycle collection work.
+    for (i in 0 until 100_000) {
+        Node(null, null, i)
+    }
+    GC.collect()
+    weakRefs.forEach { assertNull(it.get()) }
+    // Cycle still referenced from the stack must survive.
+    assertEquals(alive, alive.next!!.next)
+    GC.pauseTargetMicros = 0
+    GC.threshold = oldThreshold
+    GC.collectCyclesThreshold = oldCollectCyclesThreshold
+    println("OK")
+}
+
+private fun createLoop(index: Int, other: Node?): Node {
+    val first = Node(null, other, index)
+    first.next = Node(first, null, index)
+    return first
+}
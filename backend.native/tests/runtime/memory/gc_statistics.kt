@@ -0,0 +1,41 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.gc_statistics
+
+import kotlin.test.*
+import kotlin.native.internal.GC
+
+class Holder(var value: Any?)
+
+@Test fun runTest() {
+    assertFalse(GC.statisticsEnabled)
+    assertEquals(0L, GC.statistics().allocatedContainers)
+
+    GC.statisticsEnabled = true
+    val holder = Holder(null)
+    repeat(1000) {
+        holder.value = IntArray(it)
+    }
+    GC.collect()
+    val statistics = GC.statistics()
+    assertTrue(statistics.allocatedContainers >= 1000)
+    assertTrue(statistics.allocatedBytes >= 1000L * 999 * 2)
+    assertEquals(statistics.allocatedContainers, statistics.allocationHistogram.sum())
+    assertTrue(statistics.addRefs + statistics.atomicAddRefs > 0)
+    if (Platform.memoryModel == MemoryModel.STRICT) {
+        assertTrue(statistics.collections > 0)
+        assertTrue(statistics.cycleCollections > 0)
+        assertTrue(statistics.maxPauseMicros <= statistics.totalPauseMicros)
+    }
+
+    assertFailsWith<IllegalArgumentException> {
+        GC.startStatisticsStream("/nonexistent/directory/gc.json")
+    }
+
+    GC.statisticsEnabled = false
+    assertEquals(0L, GC.statistics().allocatedContainers)
+    println("OK")
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.heap_snapshot
+
+import kotlin.test.*
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+import kotlinx.cinterop.*
+import platform.posix.*
+
+class Node(var next: Node?, val payload: IntArray)
+
+val global = Node(null, IntArray(10))
+
+fun temporaryPath(name: String): String {
+    val directory = getenv("TMPDIR")?.toKString() ?: getenv("TEMP")?.toKString() ?: "/tmp"
+    return "$directory/$name"
+}
+
+fun readFile(path: String): ByteArray {
+    val file = fopen(path, "rb") ?: error("Cannot open $path")
+    var result = ByteArray(0)
+    val buffer = ByteArray(4096)
+    try {
+        while (true) {
+            val read = buffer.usePinned { fread(it.addressOf(0), 1.convert(), buffer.size.convert(), file).toInt() }
+            if (read <= 0) break
+            result += buffer.copyOf(read)
+        }
+    } finally {
+        fclose(file)
+    }
+    return result
+}
+
+class Snapshot(val types: Map<Long, String>, val containerTypes: List<String>, val flags: List<Int>, val rootKinds: Set<Int>)
+
+// See the format description in Memory.cpp.
+fun parse(data: ByteArray): Snapshot {
+    var position = 0
+    fun byte() = data[position++].toInt() and 0xff
+    fun varint(): Long {
+        var result = 0L
+        var shift = 0
+        while (true) {
+            val value = byte()
+            result = result or ((value and 0x7f).toLong() shl shift)
+            if (value < 0x80) return result
+            shift += 7
+        }
+    }
+
+    assertEquals("KNHEAP01", data.copyOf(8).decodeToString())
+    position = 8
+    val types = mutableMapOf<Long, String>()
+    val containerTypes = mutableListOf<String>()
+    val flags = mutableListOf<Int>()
+    val rootKinds = mutableSetOf<Int>()
+    loop@ while (true) {
+        when (byte()) {
+            0 -> break@loop
+            1 -> {
+                val id = varint()
+                val length = varint().toInt()
+                types[id] = data.copyOfRange(position, position + length).decodeToString()
+                position += length
+            }
+            2 -> {
+                varint() // Id.
+                containerTypes += types.getValue(varint())
+                varint() // Shallow size.
+                varint() // Reference counter.
+                flags += byte()
+                repeat(varint().toInt()) { varint() }
+            }
+            3 -> {
+                rootKinds += byte()
+                varint()
+            }
+            else -> fail("Unknown record at $position")
+        }
+    }
+    assertEquals(data.size, position, "Nothing follows the end record")
+    return Snapshot(types, containerTypes, flags, rootKinds)
+}
+
+@Test fun runTest() {
+    val list = Node(Node(Node(null, IntArray(1)), IntArray(2)), IntArray(3))
+    // Frozen cycle ends up in the aggregating container.
+    val cycle = Node(null, IntArray(4))
+    cycle.next = Node(cycle, IntArray(5))
+    cycle.freeze()
+    val array = Array<Any?>(3) { null }
+    array[0] = list
+    array[1] = cycle
+    array[2] = global
+
+    val path = temporaryPath("heap_snapshot_main.bin")
+    GC.dumpHeap(path)
+    val snapshot = parse(readFile(path))
+    remove(path)
+    val nodeName = "runtime.memory.heap_snapshot.Node"
+    // Three nodes of the list, the global one, and the aggregated cycle.
+    assertTrue(snapshot.containerTypes.count { it == nodeName } >= 5)
+    assertTrue(snapshot.containerTypes.count { it == "kotlin.IntArray" } >= 4)
+    assertTrue(snapshot.flags.any { it and 4 != 0 }, "Cycle must be aggregated")
+    assertTrue(3 in snapshot.rootKinds, "Globals must be roots")
+
+    // Unfrozen globals of the main thread are not visited by workers.
+    val workerPath = temporaryPath("heap_snapshot_worker.bin")
+    val worker = Worker.start()
+    worker.execute(TransferMode.SAFE, { workerPath }) { GC.dumpHeap(it) }.result
+    worker.requestTermination().result
+    val workerSnapshot = parse(readFile(workerPath))
+    remove(workerPath)
+    assertEquals(0, workerSnapshot.containerTypes.count { it == nodeName })
+
+    assertFailsWith<IllegalArgumentException> {
+        GC.dumpHeap("/nonexistent/directory/heap_snapshot.bin")
+    }
+    println("OK")
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.heap_write_coalescing
+
+import kotlin.test.*
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+import kotlin.native.ref.*
+
+class Data(val value: Int)
+
+class Holder(var data: Data?)
+
+// Overwrites the slot many times, so that with the strict memory model only the first write updates
+// reference counters until the next flush.
+fun overwrite(holder: Holder, count: Int): List<WeakReference<Data>> {
+    val weaks = mutableListOf<WeakReference<Data>>()
+    for (index in 0 until count) {
+        val data = Data(index)
+        weaks.add(WeakReference(data))
+        holder.data = data
+    }
+    return weaks
+}
+
+// All the overwritten values are released, while the last one stays alive.
+fun checkOverwritten(holder: Holder, weaks: List<WeakReference<Data>>) {
+    GC.collect()
+    for (index in 0 until weaks.size - 1) {
+        assertNull(weaks[index].get(), "value $index must be released")
+    }
+    assertSame(holder.data, weaks.last().get())
+    assertEquals(weaks.size - 1, holder.data!!.value)
+}
+
+fun checkGc() {
+    val holder = Holder(null)
+    val weaks = overwrite(holder, 100)
+    checkOverwritten(holder, weaks)
+    // Once collected, the slot is accounted again and may be coalesced anew.
+    val moreWeaks = overwrite(holder, 100)
+    checkOverwritten(holder, moreWeaks)
+    holder.data = null
+    GC.collect()
+    assertNull(moreWeaks.last().get())
+}
+
+fun checkFreeze() {
+    val holder = Holder(null)
+    val weaks = overwrite(holder, 100)
+    // Freezing relies on exact reference counters, so it flushes the log.
+    holder.freeze()
+    assertTrue(holder.data!!.isFrozen)
+    checkOverwritten(holder, weaks)
+}
+
+fun makeHolder(): Holder {
+    val holder = Holder(Data(-1))
+    overwrite(holder, 100)
+    return holder
+}
+
+fun checkTransfer() {
+    val worker = Worker.start()
+    // Transfer checks that the holder is not referred from outside, which requires flushed counters.
+    val future = worker.execute(TransferMode.SAFE, { makeHolder() }) { holder ->
+        holder.data = Data(holder.data!!.value + 1)
+        holder
+    }
+    assertEquals(100, future.result.data!!.value)
+    worker.requestTermination().result
+}
+
+fun checkShared() {
+    val holder = Holder(null)
+    val weaks = overwrite(holder, 100)
+    // Sharing an object with reference slots flushes the log and stops coalescing.
+    val shared = MutableData()
+    shared.append(byteArrayOf(1, 2, 3))
+    val moreWeaks = overwrite(holder, 100)
+    checkOverwritten(holder, weaks + moreWeaks)
+    assertEquals(3, shared.size)
+}
+
+@Test fun runTest() {
+    checkGc()
+    checkFreeze()
+    checkTransfer()
+    // Must be the last one, as coalescing is never enabled again.
+    checkShared()
+    println("OK")
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.memory.nursery
+
+import kotlin.test.*
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+
+class Point(val x: Int, val y: Int)
+
+// Must match kMaxRetiredNurseryChunks in Memory.cpp.
+const val MAX_RETIRED_CHUNKS = 64
+
+// Number of points filling a nursery chunk, each takes 24 bytes with the container header.
+const val CHUNK_OBJECTS = 256 * 1024 / 24
+
+// Survivors are kept a few per chunk.
+const val STEP = CHUNK_OBJECTS / 3
+
+// Objects released by the collection release their children on the next one.
+fun collect() {
+    repeat(3) { GC.collect() }
+}
+
+fun churn(count: Int): Long {
+    var sum = 0L
+    for (index in 0 until count) {
+        val point = Point(index, -index)
+        sum += point.x + point.y
+    }
+    return sum
+}
+
+// Keeps every STEP-th of the allocated points alive.
+fun makeSurvivors(count: Int): List<Point> {
+    val result = ArrayList<Point>(count / STEP + 1)
+    for (index in 0 until count) {
+        val point = Point(index, index * 2)
+        if (index % STEP == 0) result.add(point)
+    }
+    return result
+}
+
+fun checkSurvivors(survivors: List<Point>) {
+    survivors.forEachIndexed { index, point ->
+        assertEquals(index * STEP, point.x)
+        assertEquals(index * STEP * 2, point.y)
+    }
+}
+
+// Statistics objects are not kept, so that they don't keep nursery chunks themselves.
+fun retiredChunks() = GC.statistics().retiredNurseryChunks
+
+fun nurseryContainers() = GC.statistics().nurseryContainers
+
+fun allocatedContainers() = GC.statistics().allocatedContainers
+
+fun fullChunks() = GC.statistics().let { it.nurseryResets + it.nurseryChunks }
+
+// Fills the current chunk with garbage, so that long living objects allocated before are not in it,
+// and returns the number of retired chunks at this point.
+fun baseline(): Long {
+    churn(CHUNK_OBJECTS * 2)
+    collect()
+    return retiredChunks()
+}
+
+fun checkShortLived() {
+    val containers = nurseryContainers()
+    val chunks = fullChunks()
+    assertEquals(0L, churn(CHUNK_OBJECTS * 20))
+    collect()
+    assertTrue(nurseryContainers() - containers >= CHUNK_OBJECTS * 20L)
+    // Full chunks are either reset, or retired and freed once their containers die.
+    assertTrue(fullChunks() > chunks)
+}
+
+fun checkRetired() {
+    val baseline = baseline()
+    var survivors: List<Point>? = makeSurvivors(CHUNK_OBJECTS * 10)
+    churn(CHUNK_OBJECTS * 2)
+    collect()
+    // Chunks are kept by survivors, which stay intact.
+    assertTrue(retiredChunks() > baseline)
+    checkSurvivors(survivors!!)
+    survivors = null
+    collect()
+    assertEquals(baseline, retiredChunks())
+}
+
+fun checkLimit() {
+    val baseline = baseline()
+    val containers = nurseryContainers()
+    val allocated = allocatedContainers()
+    // Survivors in each chunk, more chunks than the limit allows.
+    var survivors: List<Point>? = makeSurvivors(CHUNK_OBJECTS * (MAX_RETIRED_CHUNKS + 20))
+    assertTrue(retiredChunks() <= MAX_RETIRED_CHUNKS)
+    // Once the limit is reached, containers are placed in the heap.
+    assertTrue(nurseryContainers() - containers < allocatedContainers() - allocated)
+    checkSurvivors(survivors!!)
+    survivors = null
+    collect()
+    assertEquals(baseline, retiredChunks())
+    // Nursery is used again.
+    val containersAfter = nurseryContainers()
+    churn(100)
+    assertTrue(nurseryContainers() > containersAfter)
+}
+
+fun shareSurvivors(): AtomicReference<List<Point>?> {
+    val survivors = makeSurvivors(CHUNK_OBJECTS * 10)
+    churn(CHUNK_OBJECTS * 2)
+    return AtomicReference<List<Point>?>(survivors.freeze())
+}
+
+fun checkFrozen() {
+    val baseline = baseline()
+    val shared = shareSurvivors()
+    collect()
+    assertTrue(retiredChunks() > baseline)
+    val worker = Worker.start()
+    // The worker drops the last references, so chunks are freed on the other thread.
+    val future = worker.execute(TransferMode.SAFE, { shared }) {
+        val survivors = it.value!!
+        it.value = null
+        checkSurvivors(survivors)
+        survivors.size
+    }
+    assertEquals(CHUNK_OBJECTS * 10 / STEP + 1, future.result)
+    worker.execute(TransferMode.SAFE, {}) { collect() }.result
+    worker.requestTermination().result
+    collect()
+    assertEquals(baseline, retiredChunks())
+}
+
+@Test fun runTest() {
+    GC.statisticsEnabled = true
+    checkShortLived()
+    checkRetired()
+    checkLimit()
+    checkFrozen()
+    GC.statisticsEnabled = false
+    println("OK")
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.text.latin1
+
+import kotlin.test.*
+import kotlinx.cinterop.*
+
+// Literals are always UTF-16, strings built at runtime are Latin-1 when possible.
+fun build(vararg chars: Char) = StringBuilder().apply { chars.forEach { append(it) } }.toString()
+
+@Test fun runTest() {
+    val latin1 = build('H', 'e', 'l', 'l', 'o', ' ', 'ÿ', 'µ')
+    val utf16 = "Hello ÿµ"
+    assertEquals(utf16, latin1)
+    assertEquals(latin1, utf16)
+    assertEquals(utf16.hashCode(), latin1.hashCode())
+    assertEquals(0, latin1.compareTo(utf16))
+    assertTrue(latin1 < "Hello ÿĀ")
+    assertTrue("Hello ÿĀ" > latin1)
+    assertEquals(8, latin1.length)
+    assertEquals('ÿ', latin1[6])
+
+    assertEquals("Hello ŸΜ", latin1.toUpperCase())
+    assertEquals("hello ÿµ", latin1.toLowerCase())
+    assertEquals("HELLO", latin1.substring(0, 5).toUpperCase())
+    assertTrue(latin1.equals("HELLO ÿµ", ignoreCase = true))
+    assertEquals(0, latin1.compareTo("hello ÿµ", ignoreCase = true))
+    assertTrue(latin1.regionMatches(1, "xello", 1, 4))
+
+    assertEquals("Hello ÿµ!", latin1 + "!")
+    assertEquals("Привет, Hello ÿµ", "Привет, " + latin1)
+    assertEquals("Hellō ÿµ", latin1.replace('o', 'ō'))
+    assertEquals("HellO ÿµ", latin1.replace('o', 'O'))
+
+    assertEquals(6, latin1.indexOf('ÿ'))
+    assertEquals(-1, latin1.indexOf('Ā'))
+    assertEquals(3, latin1.lastIndexOf('l'))
+    assertEquals(6, latin1.indexOf("ÿµ"))
+    assertEquals(6, latin1.indexOf(build('ÿ')))
+    assertEquals(-1, latin1.indexOf("ÿĀ"))
+    assertEquals(8, "Привет, Hello".indexOf(build('H', 'e')))
+    assertEquals(2, latin1.lastIndexOf("ll"))
+
+    assertEquals(latin1, latin1.encodeToByteArray().decodeToString())
+    assertEquals(10, latin1.encodeToByteArray().size)
+    assertEquals(latin1, String(latin1.toCharArray()))
+    assertEquals(1.5, build('1', '.', '5').toDouble())
+
+    // Interop sees UTF-16 characters.
+    latin1.usingPinned {
+        val chars = it.addressOf(0).reinterpret<UShortVar>()
+        assertEquals('ÿ'.toShort().toUShort(), chars[6])
+        assertEquals('H'.toShort().toUShort(), chars[0])
+    }
+    println("OK")
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.text.string_concat
+
+import kotlin.native.concurrent.*
+import kotlin.test.*
+
+// Long concatenation results share a buffer, which the next concatenation appends to in place.
+fun checkAppends(parts: List<String>) {
+    var result = ""
+    val builder = StringBuilder()
+    for (part in parts) {
+        result += part
+        builder.append(part)
+        assertEquals(builder.length, result.length)
+    }
+    val expected = builder.toString()
+    assertEquals(expected, result)
+    assertEquals(expected.hashCode(), result.hashCode())
+    for (index in expected.indices step 7) {
+        assertEquals(expected[index], result[index])
+    }
+}
+
+@Test fun runTest() {
+    checkAppends(List(500) { "item $it, " })
+    checkAppends(List(500) { "элемент $it, " })
+    checkAppends(List(500) { if (it % 50 == 49) "ÿ😥" else "µ$it" })
+    checkAppends(List(100) { "x".repeat(it) })
+
+    // Appending to a result that is not the latest one must not change the others.
+    val base = "a".repeat(100)
+    val first = base + "first"
+    val second = base + "second"
+    val third = first + "ü"
+    val fourth = first + "Ж"
+    assertEquals("a".repeat(100) + "first", first)
+    assertEquals("a".repeat(100) + "second", second)
+    assertEquals("a".repeat(100) + "firstü", third)
+    assertEquals("a".repeat(100) + "firstЖ", fourth)
+    assertEquals(100, fourth.indexOf("first"))
+    assertEquals(105, fourth.lastIndexOf('Ж'))
+    assertEquals("firstЖ", fourth.substring(100))
+    assertEquals(third.toUpperCase(), "A".repeat(100) + "FIRSTÜ")
+    assertTrue(third.startsWith(base))
+    assertEquals(0, third.compareTo(base + "firstü"))
+
+    val frozen = (base + "frozen").freeze()
+    val worker = Worker.start()
+    val appended = worker.execute(TransferMode.SAFE, { frozen }) { it + " in worker" }.result
+    worker.requestTermination().result
+    assertEquals(base + "frozen in worker", appended)
+    assertEquals(base + "frozen", frozen)
+    assertEquals(base + "frozen here", frozen + " here")
+    println("OK")
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.text.string_hash
+
+import kotlin.native.concurrent.*
+import kotlin.test.*
+
+// Literals carry hashes precomputed by the compiler, other strings cache them on the first use.
+fun build(text: String) = StringBuilder().apply { text.forEach { append(it) } }.toString()
+
+fun checkHash(literal: String) {
+    val built = build(literal)
+    assertEquals(literal.hashCode(), built.hashCode())
+    assertEquals(built.hashCode(), built.hashCode())
+    assertEquals(literal.hashCode(), literal.hashCode())
+    assertEquals(literal.hashCode(), (literal + "").hashCode())
+}
+
+@Test fun runTest() {
+    checkHash("")
+    checkHash("a")
+    checkHash("Hello, world!")
+    checkHash("Hello ÿµ")
+    checkHash("Привет, мир!")
+    checkHash("😥")
+    checkHash("The quick brown fox jumps over the lazy dog, more than a few times.".repeat(5))
+
+    val frozen = build("Shared between workers").freeze()
+    val hash = frozen.hashCode()
+    val worker = Worker.start()
+    assertEquals(hash, worker.execute(TransferMode.SAFE, { frozen }) { it.hashCode() }.result)
+    worker.requestTermination().result
+    assertEquals(hash, frozen.hashCode())
+
+    val map = HashMap<String, Int>()
+    listOf("one", "two", "three", "четыре").forEachIndexed { index, key -> map[build(key)] = index }
+    assertEquals(0, map["one"])
+    assertEquals(3, map["четыре"])
+    println("OK")
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.text.string_kernels
+
+import kotlin.test.*
+
+// Literals are UTF-16, strings built at runtime are Latin-1 when possible.
+fun build(text: String) = StringBuilder().apply { text.forEach { append(it) } }.toString()
+
+// Strings are long enough to go through the vectorized paths.
+fun checkSearch(long: String, pair: String, triple: String) {
+    for (text in listOf(long, build(long))) {
+        for (needle in listOf(triple, build(triple))) {
+            assertEquals(80, text.indexOf(needle))
+            assertEquals(80, text.lastIndexOf(needle))
+            assertEquals(-1, text.indexOf(needle, 81))
+            assertEquals(-1, text.lastIndexOf(needle, 79))
+        }
+        assertEquals(0, text.indexOf(pair))
+        assertEquals(101, text.lastIndexOf(pair))
+        assertEquals(83, text.indexOf(pair, 81))
+        assertEquals(78, text.lastIndexOf(pair, 79))
+        assertEquals(82, text.indexOf(triple[2]))
+        assertEquals(82, text.lastIndexOf(triple[2]))
+        assertEquals(101, text.lastIndexOf(pair[0]))
+        assertEquals(-1, text.indexOf('Ā'))
+        assertEquals(-1, text.lastIndexOf('Ā'))
+    }
+}
+
+@Test fun runTest() {
+    // UTF-16 characters must not match at half of a character.
+    assertEquals(-1, "\u4100B".indexOf("\u4241"))
+
+    checkSearch("ab".repeat(40) + "abc" + "ab".repeat(10), "ab", "abc")
+    checkSearch("жы".repeat(40) + "жыц" + "жы".repeat(10), "жы", "жыц")
+    checkSearch("éa".repeat(40) + "éaÿ" + "éa".repeat(10), "éa", "éaÿ")
+
+    val ascii = "The quick brown fox jumps over the lazy dog. "
+    val upper = "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG. "
+    for (text in listOf(ascii, build(ascii))) {
+        assertEquals(upper, text.toUpperCase())
+        assertEquals(ascii.toLowerCase(), upper.toLowerCase())
+        assertTrue(text.equals(upper, ignoreCase = true))
+        assertTrue(build(upper).equals(text, ignoreCase = true))
+        assertEquals(0, text.compareTo(build(upper), ignoreCase = true))
+        assertFalse(text.equals(upper.replace('Z', 'Y'), ignoreCase = true))
+        assertTrue(text.compareTo(upper.replace('Z', 'Y'), ignoreCase = true) > 0)
+        assertTrue(text.regionMatches(4, upper, 4, 30, ignoreCase = true))
+        assertFalse(text.regionMatches(4, upper, 4, 30, ignoreCase = false))
+    }
+    assertEquals("ПРИВЕТ, WORLD! ".repeat(3) + "Ÿ", ("привет, world! ".repeat(3) + "ÿ").toUpperCase())
+    assertEquals("ÿ" + "hello, world! ".repeat(3), build("Ÿ" + "HELLO, WORLD! ".repeat(3)).toLowerCase())
+    assertTrue(("привет, world! ".repeat(3)).equals("ПРИВЕТ, WORLD! ".repeat(3), ignoreCase = true))
+
+    val prefix = "a".repeat(37)
+    assertTrue((prefix + "b") < (prefix + "c"))
+    assertTrue(build(prefix + "b") < (prefix + "c"))
+    assertTrue((prefix + "ж") > build(prefix + "ÿ"))
+    assertTrue((prefix + "ж") > (prefix + "ж").substring(0, 37))
+    assertEquals(0, build(prefix + "é").compareTo(prefix + "é"))
+    assertEquals(build(prefix + "é"), prefix + "é")
+    println("OK")
+}
@@ -464,6 +464,28 @@ fun testZeroTerminated8To16CustomBorders() {
     checkOutOfBoundsZeroTerminatedUtf8to16(IllegalArgumentException::class, "aaa0bbb0", byteArray, 3, -2)
 }
 
+// Long inputs go through the vectorized paths, so put non-ASCII characters at every position of a block.
+fun testLongStrings() {
+    val prefix = "0123456789abcdefghijklmnopqrstuvwxyz"
+    for (length in 0 .. prefix.length) {
+        val ascii = prefix.substring(0, length)
+        for (tail in listOf("", "\u00E9", "\u00FF-", "\u0416", "\u20AC", "\uD83D\uDE25", "\u00E9\u0416")) {
+            val string = ascii + tail + ascii
+            val bytes = string.encodeToByteArray(throwOnInvalidSequence = true)
+            assertEquals(string, bytes.decodeToString())
+            assertEquals(string, bytes.decodeToString(throwOnInvalidSequence = true))
+        }
+        // Lone surrogate after an ASCII run.
+        checkUtf16to8Throws(ascii + "\uD800" + ascii)
+        assertEquals(ascii + "\uFFFD" + ascii,
+                (ascii + "\uD800" + ascii).encodeToByteArray().decodeToString())
+        // Ill-formed UTF-8 after an ASCII run.
+        val array = (ascii.map { it.toInt() } + 0xC0.toByte().toInt() + ascii.map { it.toInt() }).toIntArray()
+        checkUtf8to16Replacing(ascii + "\uFFFD" + ascii, array)
+        checkUtf8to16Throws(ascii + "\uFFFD" + ascii, array)
+    }
+}
+
 // ------------------------------------ Run tests ------------------------------------
 @Test fun runTest() {
     test16to8()
@@ -472,5 +494,6 @@ fun testZeroTerminated8To16CustomBorders() {
     test8to16CustomBorders()
     testZeroTerminated8To16()
     testZeroTerminated8To16CustomBorders()
+    testLongStrings()
     testPrint()
 }
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.atomic_read_contention
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+
+class Config(val first: Int, val second: Int)
+
+@Test fun runTest() {
+    val shared = AtomicReference(Config(0, 0).freeze())
+    val done = AtomicInt(0)
+    val readers = Array(4) { Worker.start() }
+    val futures = readers.map {
+        it.execute(TransferMode.SAFE, { Pair(shared, done) }) { (reference, finished) ->
+            var reads = 0
+            while (finished.value == 0 || reads < 1000) {
+                // Repeated reads of the same value take the lock-free path, while updates replace it.
+                val config = reference.value
+                if (config.first != config.second) return@execute -1
+                reads++
+                // Values remembered by the reader are released by its GC, while their memory is reused by updates.
+                if (reads % 1000 == 0) GC.collect()
+            }
+            reads
+        }
+    }
+    for (index in 1..10_000) {
+        shared.value = Config(index, index).freeze()
+        if (index % 100 == 0) {
+            // Failed compareAndSet must leave the value intact.
+            assertFalse(shared.compareAndSet(Config(0, 0), Config(-1, -1).freeze()))
+            assertEquals(index, shared.value.first)
+        }
+    }
+    done.value = 1
+    futures.forEach {
+        assertTrue(it.result > 0)
+    }
+    readers.forEach {
+        it.requestTermination().result
+    }
+    println("OK")
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.freeze_parallel
+
+import kotlin.test.*
+import kotlin.native.concurrent.*
+import kotlin.native.ref.*
+
+class Node(val id: Int) {
+    var left: Node? = null
+    var right: Node? = null
+    var back: Node? = null
+}
+
+// Big enough to be frozen by several threads.
+const val SIZE = 100_000
+
+fun buildTree(cycleEvery: Int): Array<Node> {
+    val nodes = Array(SIZE) { Node(it) }
+    for (i in 1 until SIZE) {
+        val parent = nodes[(i - 1) / 2]
+        if (i % 2 == 1) parent.left = nodes[i] else parent.right = nodes[i]
+        if (cycleEvery > 0 && i % cycleEvery == 0) nodes[i].back = parent
+    }
+    return nodes
+}
+
+@Test fun acyclic() {
+    val nodes = buildTree(0)
+    nodes[0].freeze()
+    assertTrue(nodes.all { it.isFrozen })
+    println("OK")
+}
+
+@Test fun cyclic() {
+    val nodes = buildTree(17)
+    // Node with cycle through the whole path to the root.
+    nodes[SIZE - 1].back = nodes[0]
+    nodes[0].freeze()
+    assertTrue(nodes.all { it.isFrozen })
+    println("OK")
+}
+
+fun makeFrozenGarbage(): WeakReference<Node> {
+    val nodes = buildTree(5)
+    nodes[0].freeze()
+    return WeakReference(nodes[SIZE / 2])
+}
+
+@Test fun collected() {
+    val ref = makeFrozenGarbage()
+    kotlin.native.internal.GC.collect()
+    assertNull(ref.get())
+    println("OK")
+}
+
+@Test fun blocked() {
+    val nodes = buildTree(3)
+    nodes[SIZE - 1].ensureNeverFrozen()
+    assertFailsWith<FreezingException> {
+        nodes[0].freeze()
+    }
+    assertTrue(nodes.none { it.isFrozen })
+    println("OK")
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.future_selector
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+@Test fun runTest() {
+    val workers = Array(4) { Worker.start(errorReporting = false) }
+    val selector = FutureSelector.create<Int>()
+    var expected = 0
+    for (index in 0 until 1000) {
+        expected += index
+        selector.register(workers[index % workers.size].execute(TransferMode.SAFE, { index }) { it })
+    }
+    assertEquals(1000, selector.pending)
+    var sum = 0
+    var completed = 0
+    while (selector.pending > 0) {
+        for (future in selector.select()) {
+            assertEquals(FutureState.COMPUTED, future.state)
+            sum += future.result
+            completed++
+        }
+    }
+    assertEquals(1000, completed)
+    assertEquals(expected, sum)
+    assertTrue(selector.select(10).isEmpty())
+
+    // Failed futures are completed as well.
+    selector.register(workers[0].execute(TransferMode.SAFE, { 0 }) {
+        if (it == 0) throw Error("expected")
+        it
+    })
+    val failed = selector.select()
+    assertEquals(1, failed.size)
+    assertEquals(FutureState.THROWN, failed[0].state)
+    assertFailsWith<IllegalStateException> { failed[0].result }
+    selector.close()
+    assertFailsWith<IllegalStateException> { selector.select() }
+
+    // Callbacks are executed on the given worker.
+    val current = Worker.current
+    val counter = AtomicInt(0)
+    val futures = workers.map { worker -> worker.execute(TransferMode.SAFE, { 1 }) { it } }
+    for (future in futures) {
+        future.onComplete(current, { it: Future<Int> -> counter.addAndGet(it.result) }.freeze())
+    }
+    while (counter.value < futures.size) {
+        current.park(10_000, process = true)
+    }
+    assertEquals(futures.size, counter.value)
+
+    workers.forEach { it.requestTermination().result }
+    println("OK")
+}
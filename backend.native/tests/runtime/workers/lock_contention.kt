@@ -0,0 +1,35 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.lock_contention
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+// MutableData is guarded by the internal lock, which parks contending threads.
+@Test fun runTest() {
+    val data = MutableData()
+    val workers = Array(8) { Worker.start() }
+    val futures = workers.map {
+        it.execute(TransferMode.SAFE, { data }) { shared ->
+            val chunk = ByteArray(16) { 1 }
+            repeat(2_000) {
+                shared.append(chunk)
+            }
+        }
+    }
+    futures.forEach { it.result }
+    assertEquals(8 * 2_000 * 16, data.size)
+    var sum = 0
+    data.withBufferLocked { array, size ->
+        for (index in 0 until size) sum += array[index]
+    }
+    assertEquals(data.size, sum)
+    workers.forEach {
+        it.requestTermination().result
+    }
+    println("OK")
+}
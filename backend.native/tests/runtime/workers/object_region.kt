@@ -0,0 +1,73 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.object_region
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+class Node(val value: Int, var next: Node?)
+
+@ThreadLocal
+object Registry {
+    val nodes = ArrayList<Node>()
+}
+
+@Test fun runTest() {
+    val worker = Worker.start()
+    val list = DetachedObjectRegion {
+        var head: Node? = null
+        for (index in 0 until 1000) head = Node(index, head)
+        head!!
+    }
+    val sum = worker.execute(TransferMode.SAFE, { list }) {
+        it.consume { head ->
+            var result = 0
+            var node: Node? = head
+            while (node != null) {
+                result += node.value
+                node = node.next
+            }
+            result
+        }
+    }.result
+    assertEquals(999 * 1000 / 2, sum)
+    assertFailsWith<IllegalStateException> { list.consume { it.value } }
+
+    val strings = DetachedObjectRegion(TransferMode.UNSAFE) { Array(100) { "item$it" } }
+    val length = worker.execute(TransferMode.SAFE, { strings }) {
+        it.consume { array -> array.joinToString(",").length }
+    }.result
+    assertEquals((0 until 100).joinToString(",") { "item$it" }.length, length)
+
+    // Region may refer to frozen objects, but not to the local ones.
+    val frozen = Node(-1, null).freeze()
+    assertEquals(-1, DetachedObjectRegion { Node(0, frozen) }.consume { it.next!!.value })
+    val local = Node(-1, null)
+    assertFailsWith<IllegalStateException> { DetachedObjectRegion { Node(0, local) } }
+
+    // Region objects cannot escape the region.
+    assertFailsWith<IllegalStateException> { DetachedObjectRegion { Node(0, null) }.consume { it } }
+    assertFailsWith<IllegalStateException> { DetachedObjectRegion { Node(1, null) }.consume { listOf(it) } }
+    val kept = ArrayList<Node>()
+    assertFailsWith<IllegalStateException> { DetachedObjectRegion { Node(2, null) }.consume { kept.add(it) } }
+    assertFailsWith<IllegalStateException> { DetachedObjectRegion { Node(3, null).also { kept.add(it) } } }
+    // Regions referred from outside are not released.
+    assertEquals(listOf(2, 3), kept.map { it.value })
+
+    // Singletons initialized by the producer are placed in the heap.
+    assertEquals(0, DetachedObjectRegion { Node(Registry.nodes.size, null) }.consume { it.value })
+    Registry.nodes.add(Node(4, null))
+    assertEquals(4, Registry.nodes.single().value)
+
+    // Exceptions from the region are replaced, others are passed as is.
+    assertFailsWith<IllegalStateException> { DetachedObjectRegion<Node> { throw IllegalArgumentException() } }
+    val error = IllegalArgumentException()
+    assertFailsWith<IllegalArgumentException> { DetachedObjectRegion<Node> { throw error } }
+
+    worker.requestTermination().result
+    println("OK")
+}
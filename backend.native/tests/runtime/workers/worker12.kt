@@ -0,0 +1,44 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker12
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+import kotlin.native.internal.GC
+
+class Data(var next: Data?, val value: Int)
+
+fun makeGarbage(count: Int) {
+    repeat(count) {
+        val data = Data(null, it)
+        data.next = data
+    }
+}
+
+@Test fun runTest() {
+    val shared = Data(null, 0)
+    // Transfers must stay correct with big backlog of pending releases.
+    GC.suspend()
+    try {
+        withWorker {
+            repeat(100) { i ->
+                makeGarbage(1000)
+                val future = execute(TransferMode.SAFE, { Data(Data(null, i), i) }) { input ->
+                    input.value + input.next!!.value
+                }
+                assertEquals(2 * i, future.result)
+            }
+            assertFailsWith<IllegalStateException> {
+                execute(TransferMode.SAFE, { Data(shared, 1) }) { input -> input.value }
+            }
+        }
+    } finally {
+        GC.resume()
+    }
+    assertEquals(0, shared.value)
+    println("OK")
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_batch
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+data class Box(var value: Int)
+
+@Test fun runTest() {
+    val worker = Worker.start()
+    val futures = worker.executeBatch(TransferMode.SAFE, 1000, { Box(it) }, { box: Box -> box.value * 2 }.freeze())
+    assertEquals(1000, futures.size)
+    var sum = 0
+    futures.forEach { sum += it.result }
+    assertEquals(999 * 1000, sum)
+    assertFailsWith<IndexOutOfBoundsException> { futures[1000] }
+
+    // Arguments may share objects, as all the jobs run on the same worker.
+    var box: Box? = Box(0)
+    val shared = worker.executeBatch(TransferMode.SAFE, 2, { index ->
+        val argument = box!!
+        if (index == 1) box = null
+        argument
+    }, { argument: Box -> ++argument.value }.freeze())
+    assertEquals(listOf(1, 2), shared.toList().map { it.result })
+
+    // Jobs are executed in order, and also with the regular ones.
+    val order = worker.executeBatch(TransferMode.SAFE, 3, { it }, { index: Int -> index }.freeze())
+    val last = worker.execute(TransferMode.SAFE, { 3 }) { it }
+    assertEquals(listOf(0, 1, 2), order.toList().map { it.result })
+    assertEquals(3, last.result)
+
+    val local = Box(0)
+    assertFailsWith<IllegalStateException> {
+        worker.executeBatch(TransferMode.SAFE, 2, { local }, { box: Box -> box.value }.freeze())
+    }
+    assertFailsWith<IllegalStateException> {
+        worker.executeBatch(TransferMode.SAFE, 1, { Box(0) }, { box: Box -> box.value + local.value })
+    }
+    assertFailsWith<IllegalArgumentException> {
+        worker.executeBatch(TransferMode.SAFE, 0, { Box(0) }, { box: Box -> box.value }.freeze())
+    }
+
+    worker.requestTermination().result
+    println("OK")
+}
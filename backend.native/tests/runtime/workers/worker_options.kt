@@ -0,0 +1,49 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_options
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+fun deepRecursion(depth: Int): Int = if (depth == 0) 0 else deepRecursion(depth - 1) + 1
+
+@Test fun runTest() {
+    val topology = Worker.cpuTopology()
+    assertTrue(topology.cpus.isNotEmpty())
+    assertTrue(topology.nodes.isNotEmpty())
+    topology.nodes.forEach { node ->
+        node.forEach { assertTrue(it in topology.cpus) }
+    }
+
+    // Worker per core.
+    val workers = topology.cpus.map {
+        Worker.start(options = WorkerOptions(cpus = intArrayOf(it), priority = 10))
+    }
+    val futures = workers.mapIndexed { index, worker ->
+        worker.execute(TransferMode.SAFE, { index }) { it * 2 }
+    }
+    futures.forEachIndexed { index, future -> assertEquals(index * 2, future.result) }
+    workers.forEach { it.requestTermination().result }
+
+    val worker = Worker.start(name = "big stack", options = WorkerOptions(numaNode = 0, stackSize = 64L * 1024 * 1024))
+    assertEquals(100_000, worker.execute(TransferMode.SAFE, { 100_000 }) { deepRecursion(it) }.result)
+    worker.requestTermination().result
+
+    assertFailsWith<IllegalArgumentException> {
+        Worker.start(options = WorkerOptions(cpus = intArrayOf(-1)))
+    }
+    assertFailsWith<IllegalArgumentException> {
+        Worker.start(options = WorkerOptions(numaNode = topology.nodes.size))
+    }
+    assertFailsWith<IllegalArgumentException> {
+        Worker.start(options = WorkerOptions(priority = 20))
+    }
+    assertFailsWith<IllegalArgumentException> {
+        Worker.start(options = WorkerOptions(stackSize = -1))
+    }
+    println("OK")
+}
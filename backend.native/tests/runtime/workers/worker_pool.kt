@@ -0,0 +1,58 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_pool
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+data class Input(val value: Int)
+
+fun fib(n: Int): Int = if (n < 2) n else fib(n - 1) + fib(n - 2)
+
+@Test fun runTest() {
+    val pool = WorkerPool.start(4)
+    assertEquals(4, pool.size)
+
+    val futures = pool.executeBatch(TransferMode.SAFE, 100, { Input(it) }) { input -> input.value * 2 }
+    assertEquals(100, futures.size)
+    futures.forEachIndexed { index, future -> assertEquals(index * 2, future.result) }
+
+    assertEquals(42, pool.execute(TransferMode.SAFE, { Input(21) }) { input -> input.value * 2 }.result)
+
+    // Uneven jobs are balanced by stealing.
+    val values = pool.parallelMap(0 until 25) { fib(it) }
+    assertEquals((0 until 25).map { fib(it) }, values)
+
+    val counter = AtomicInt(0)
+    pool.parallelFor(0 until 10000, grainSize = 100, body = { index: Int -> counter.addAndGet(index) }.freeze())
+    assertEquals(10000 * 9999 / 2, counter.value)
+
+    // Jobs could wait for nested jobs without blocking the pool.
+    val nested = pool.executeBatch(TransferMode.SAFE, 16, { Pair(pool, it) }) { (innerPool, index) ->
+        innerPool.parallelMap(0 until 100) { it * 2 }.sum() + index
+    }
+    nested.forEachIndexed { index, future -> assertEquals(9900 + index, future.result) }
+
+    // Futures of the pool could be waited for as any other futures.
+    val pending = pool.executeBatch(TransferMode.SAFE, 10, { Input(it) }) { input -> input.value }.toSet()
+    val ready = mutableSetOf<Future<Int>>()
+    while (ready.size < pending.size) {
+        ready += waitForMultipleFutures(pending - ready, 10000)
+    }
+    assertEquals(45, ready.sumBy { it.result })
+
+    assertFailsWith<IllegalStateException> {
+        val local = mutableListOf<Int>()
+        pool.parallelFor(0 until 10) { local.add(it) }
+    }
+
+    pool.requestTermination()
+    assertFailsWith<IllegalStateException> {
+        pool.execute(TransferMode.SAFE, { Input(1) }) { input -> input.value }
+    }
+    println("OK")
+}
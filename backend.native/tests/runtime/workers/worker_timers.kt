@@ -0,0 +1,47 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package runtime.workers.worker_timers
+
+import kotlin.test.*
+
+import kotlin.native.concurrent.*
+
+@Test fun runTest() {
+    val current = Worker.current
+    var executed = 0
+    val jobs = (0 until 1000).map { index -> current.executeAfterCancellable(1000L + index * 10) { executed += index } }
+    var expected = 0
+    jobs.forEachIndexed { index, job ->
+        if (index % 2 == 0) {
+            assertTrue(job.cancel())
+            assertFalse(job.cancel())
+        } else {
+            expected += index
+        }
+    }
+    // Far timers could be cancelled as well.
+    assertTrue(current.executeAfterCancellable(3600L * 1000 * 1000) { executed = -1 }.cancel())
+    // Jobs without delay are not cancellable.
+    assertFalse(current.executeAfterCancellable(0) { executed += 0 }.cancel())
+
+    while (executed < expected) {
+        current.park(100_000, process = true)
+    }
+    assertEquals(expected, executed)
+    assertFalse(jobs.last().cancel())
+
+    // Jobs could be cancelled from other workers.
+    val worker = Worker.start()
+    val counter = AtomicInt(0)
+    val delayed = worker.executeAfterCancellable(10L * 1000 * 1000, { counter.increment() }.freeze())
+    val canceller = Worker.start()
+    assertTrue(canceller.execute(TransferMode.SAFE, { delayed }) { it.cancel() }.result)
+    canceller.requestTermination().result
+    worker.executeAfter(1000, { counter.increment() }.freeze())
+    worker.requestTermination().result
+    assertEquals(1, counter.value)
+    println("OK")
+}
@@ -16,6 +16,12 @@
 
 package org.jetbrains.ring
 
+import java.util.concurrent.Callable
+import java.util.concurrent.Executors
+import java.util.concurrent.Future
+import java.util.concurrent.ScheduledThreadPoolExecutor
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicReference
 import java.util.concurrent.atomic.AtomicReferenceFieldUpdater
 import java.util.concurrent.locks.ReentrantLock
 
@@ -98,4 +104,58 @@ public actual class AtomicRef<T> internal constructor(value: T) {
     }
 }
 
-public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(initial)
\ No newline at end of file
+public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(initial)
+
+public actual fun <T> freezeGraph(value: T): T = value
+
+public actual fun submitJobs(producers: Int, jobsPerProducer: Int): Long {
+    val consumer = Executors.newSingleThreadExecutor()
+    val producerPool = Executors.newFixedThreadPool(producers)
+    val submitted = (0 until producers).map {
+        producerPool.submit<Long> {
+            val futures = Array<Future<Int>>(jobsPerProducer) { index -> consumer.submit<Int> { index + 1 } }
+            var sum = 0L
+            futures.forEach { sum += it.get() }
+            sum
+        }
+    }
+    val result = submitted.fold(0L) { sum, future -> sum + future.get() }
+    producerPool.shutdown()
+    consumer.shutdown()
+    return result
+}
+
+public actual fun submitJobsBatch(count: Int): Long {
+    val consumer = Executors.newSingleThreadExecutor()
+    val futures = consumer.invokeAll((0 until count).map { index -> Callable<Int> { index + 1 } })
+    var sum = 0L
+    futures.forEach { sum += it.get() }
+    consumer.shutdown()
+    return sum
+}
+
+public actual fun scheduleAndCancelTimers(count: Int): Int {
+    val executor = ScheduledThreadPoolExecutor(1)
+    executor.removeOnCancelPolicy = true
+    val jobs = Array(count) { executor.schedule({}, 1_000_000L + it, TimeUnit.MICROSECONDS) }
+    val result = jobs.count { it.cancel(false) }
+    executor.shutdown()
+    return result
+}
+
+private class SharedConfig(val value: Int)
+
+public actual fun readSharedReferences(readers: Int, references: Int, readsPerReader: Int): Long {
+    val shared = Array(references) { AtomicReference(SharedConfig(it + 1)) }
+    val readerPool = Executors.newFixedThreadPool(readers)
+    val submitted = (0 until readers).map {
+        readerPool.submit<Long> {
+            var sum = 0L
+            repeat(readsPerReader) { sum += shared[it % shared.size].get().value }
+            sum
+        }
+    }
+    val result = submitted.fold(0L) { sum, future -> sum + future.get() }
+    readerPool.shutdown()
+    return result
+}
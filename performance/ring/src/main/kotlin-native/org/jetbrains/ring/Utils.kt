@@ -16,9 +16,12 @@
 
 package org.jetbrains.ring
 
+import kotlin.native.concurrent.AtomicReference
 import kotlin.native.concurrent.FreezableAtomicReference as KAtomicRef
 import kotlin.native.concurrent.isFrozen
 import kotlin.native.concurrent.freeze
+import kotlin.native.concurrent.TransferMode
+import kotlin.native.concurrent.Worker
 
 public actual class AtomicRef<T> constructor(@PublishedApi internal val a: KAtomicRef<T>) {
     public actual inline var value: T
@@ -50,4 +53,55 @@ public actual class AtomicRef<T> constructor(@PublishedApi internal val a: KAtom
     override fun toString(): String = value.toString()
 }
 
-public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(KAtomicRef(initial))
\ No newline at end of file
+public actual fun <T> atomic(initial: T): AtomicRef<T> = AtomicRef<T>(KAtomicRef(initial))
+
+public actual fun <T> freezeGraph(value: T): T = value.freeze()
+
+public actual fun submitJobs(producers: Int, jobsPerProducer: Int): Long {
+    val consumer = Worker.start()
+    val producerWorkers = Array(producers) { Worker.start() }
+    val submitted = producerWorkers.map { producer ->
+        producer.execute(TransferMode.SAFE, { Pair(consumer, jobsPerProducer) }) { (target, count) ->
+            val futures = Array(count) { index -> target.execute(TransferMode.SAFE, { index }) { it + 1 } }
+            var sum = 0L
+            futures.forEach { sum += it.result }
+            sum
+        }
+    }
+    val result = submitted.fold(0L) { sum, future -> sum + future.result }
+    producerWorkers.forEach { it.requestTermination().result }
+    consumer.requestTermination().result
+    return result
+}
+
+public actual fun submitJobsBatch(count: Int): Long {
+    val consumer = Worker.start()
+    val futures = consumer.executeBatch(TransferMode.SAFE, count, { it }, { index: Int -> index + 1 }.freeze())
+    var sum = 0L
+    futures.forEach { sum += it.result }
+    consumer.requestTermination().result
+    return sum
+}
+
+public actual fun scheduleAndCancelTimers(count: Int): Int {
+    val worker = Worker.current
+    val jobs = Array(count) { worker.executeAfterCancellable(1_000_000L + it) {} }
+    return jobs.count { it.cancel() }
+}
+
+private class SharedConfig(val value: Int)
+
+public actual fun readSharedReferences(readers: Int, references: Int, readsPerReader: Int): Long {
+    val shared = Array(references) { AtomicReference(SharedConfig(it + 1).freeze()) }.freeze()
+    val readerWorkers = Array(readers) { Worker.start() }
+    val submitted = readerWorkers.map { reader ->
+        reader.execute(TransferMode.SAFE, { Pair(shared, readsPerReader) }) { (refs, count) ->
+            var sum = 0L
+            repeat(count) { sum += refs[it % refs.size].value.value }
+            sum
+        }
+    }
+    val result = submitted.fold(0L) { sum, future -> sum + future.result }
+    readerWorkers.forEach { it.requestTermination().result }
+    return result
+}
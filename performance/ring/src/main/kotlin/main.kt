@@ -179,6 +179,8 @@ class RingLauncher : Launcher() {
                     "String.stringConcatNullable" to BenchmarkEntryWithInit.create(::StringBenchmark, { stringConcatNullable() }),
                     "String.stringBuilderConcat" to BenchmarkEntryWithInit.create(::StringBenchmark, { stringBuilderConcat() }),
                     "String.stringBuilderConcatNullable" to BenchmarkEntryWithInit.create(::StringBenchmark, { stringBuilderConcatNullable() }),
+                    "String.stringHashAndEquals" to BenchmarkEntryWithInit.create(::StringBenchmark, { stringHashAndEquals() }),
+                    "String.stringUtf8RoundTrip" to BenchmarkEntryWithInit.create(::StringBenchmark, { stringUtf8RoundTrip() }),
                     "String.summarizeSplittedCsv" to BenchmarkEntryWithInit.create(::StringBenchmark, { summarizeSplittedCsv() }),
                     "Switch.testSparseIntSwitch" to BenchmarkEntryWithInit.create(::SwitchBenchmark, { testSparseIntSwitch() }),
                     "Switch.testDenseIntSwitch" to BenchmarkEntryWithInit.create(::SwitchBenchmark, { testDenseIntSwitch() }),
@@ -207,7 +209,25 @@ class RingLauncher : Launcher() {
                     "Casts.classCast" to BenchmarkEntryWithInit.create(::CastsBenchmark, { classCast() }),
                     "Casts.interfaceCast" to BenchmarkEntryWithInit.create(::CastsBenchmark, { interfaceCast() }),
                     "LocalObjects.localArray" to BenchmarkEntryWithInit.create(::LocalObjectsBenchmark, { localArray() }),
-                    "LinkedListWithAtomicsBenchmark" to BenchmarkEntryWithInit.create(::LinkedListWithAtomicsBenchmark, { ensureNext() })
+                    "LinkedListWithAtomicsBenchmark" to BenchmarkEntryWithInit.create(::LinkedListWithAtomicsBenchmark, { ensureNext() }),
+                    "Freeze.freezeTree100K" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeTree100K() }),
+                    "Freeze.freezeTree1M" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeTree1M() }),
+                    "Freeze.freezeTree10M" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeTree10M() }),
+                    "Freeze.freezeCyclicTree100K" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeCyclicTree100K() }),
+                    "Freeze.freezeCyclicTree1M" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeCyclicTree1M() }),
+                    "Freeze.freezeCyclicTree10M" to BenchmarkEntryWithInit.create(::FreezeBenchmark, { freezeCyclicTree10M() }),
+                    "Worker.submitJobs1Producer" to BenchmarkEntryWithInit.create(::WorkerBenchmark, { submitJobs1Producer() }),
+                    "Worker.submitJobs4Producers" to BenchmarkEntryWithInit.create(::WorkerBenchmark, { submitJobs4Producers() }),
+                    "Worker.submitJobs16Producers" to BenchmarkEntryWithInit.create(::WorkerBenchmark, { submitJobs16Producers() }),
+                    "Worker.submitJobs32Producers" to BenchmarkEntryWithInit.create(::WorkerBenchmark, { submitJobs32Producers() }),
+                    "Worker.submitJobsBatch100K" to BenchmarkEntryWithInit.create(::WorkerBenchmark, { submitJobsBatch100K() }),
+                    "Worker.scheduleAndCancel1MTimers" to BenchmarkEntryWithInit.create(::WorkerBenchmark, { scheduleAndCancel1MTimers() }),
+                    "AtomicReference.readShared1Reader" to BenchmarkEntryWithInit.create(::AtomicReferenceBenchmark, { readShared1Reader() }),
+                    "AtomicReference.readShared4Readers" to BenchmarkEntryWithInit.create(::AtomicReferenceBenchmark, { readShared4Readers() }),
+                    "AtomicReference.readShared8Readers" to BenchmarkEntryWithInit.create(::AtomicReferenceBenchmark, { readShared8Readers() }),
+                    "AtomicReference.readShared16Readers" to BenchmarkEntryWithInit.create(::AtomicReferenceBenchmark, { readShared16Readers() }),
+                    "AtomicReference.readShared4References1Reader" to BenchmarkEntryWithInit.create(::AtomicReferenceBenchmark, { readShared4References1Reader() }),
+                    "AtomicReference.readShared4References16Readers" to BenchmarkEntryWithInit.create(::AtomicReferenceBenchmark, { readShared4References16Readers() })
             )
     )
 }
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.ring
+
+/**
+ * Several readers concurrently read the same rarely changing shared reference, like a configuration
+ * object read on every request. Every reader performs the same number of reads, so with reads
+ * not contending on each other time stays the same as the number of readers grows. Readers alternating
+ * between several references check that the reads stay lock-free when the value read changes.
+ */
+open class AtomicReferenceBenchmark {
+    //Benchmark
+    fun readShared1Reader(): Long = readSharedReferences(1, 1, 1_000_000)
+
+    //Benchmark
+    fun readShared4Readers(): Long = readSharedReferences(4, 1, 1_000_000)
+
+    //Benchmark
+    fun readShared8Readers(): Long = readSharedReferences(8, 1, 1_000_000)
+
+    //Benchmark
+    fun readShared16Readers(): Long = readSharedReferences(16, 1, 1_000_000)
+
+    //Benchmark
+    fun readShared4References1Reader(): Long = readSharedReferences(1, 4, 1_000_000)
+
+    //Benchmark
+    fun readShared4References16Readers(): Long = readSharedReferences(16, 4, 1_000_000)
+}
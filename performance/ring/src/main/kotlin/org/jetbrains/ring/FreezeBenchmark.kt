@@ -0,0 +1,51 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.ring
+
+class FreezeNode(val id: Int) {
+    var left: FreezeNode? = null
+    var right: FreezeNode? = null
+    var back: FreezeNode? = null
+}
+
+/**
+ * Freezes binary trees of different sizes. With `cycleEvery` > 0 every such node refers back to
+ * its parent, producing many small strongly connected components.
+ */
+open class FreezeBenchmark {
+    private fun buildTree(size: Int, cycleEvery: Int): FreezeNode {
+        val nodes = Array(size) { FreezeNode(it) }
+        for (i in 1 until size) {
+            val parent = nodes[(i - 1) / 2]
+            if (i % 2 == 1) parent.left = nodes[i] else parent.right = nodes[i]
+            if (cycleEvery > 0 && i % cycleEvery == 0) nodes[i].back = parent
+        }
+        return nodes[0]
+    }
+
+    private fun freezeTree(size: Int, cycleEvery: Int): Int {
+        val root = buildTree(size, cycleEvery)
+        return freezeGraph(root).id
+    }
+
+    //Benchmark
+    fun freezeTree100K(): Int = freezeTree(100_000, 0)
+
+    //Benchmark
+    fun freezeTree1M(): Int = freezeTree(1_000_000, 0)
+
+    //Benchmark
+    fun freezeTree10M(): Int = freezeTree(10_000_000, 0)
+
+    //Benchmark
+    fun freezeCyclicTree100K(): Int = freezeTree(100_000, 64)
+
+    //Benchmark
+    fun freezeCyclicTree1M(): Int = freezeTree(1_000_000, 64)
+
+    //Benchmark
+    fun freezeCyclicTree10M(): Int = freezeTree(10_000_000, 64)
+}
@@ -66,6 +66,22 @@ open class StringBenchmark {
         return string.toString()
     }
     
+    //Benchmark
+    open fun stringHashAndEquals(): Int {
+        val set = HashSet<String>(data.size)
+        for (it in data) set.add(it)
+        var found = 0
+        for (it in data) if (set.contains(it)) found++
+        return found
+    }
+
+    //Benchmark
+    open fun stringUtf8RoundTrip(): Int {
+        var length = 0
+        for (it in data) length += it.encodeToByteArray().decodeToString().length
+        return length
+    }
+
     //Benchmark
     open fun summarizeSplittedCsv(): Double {
         val fields = csv.split(",")
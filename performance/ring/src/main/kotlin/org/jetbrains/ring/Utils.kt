@@ -41,3 +41,32 @@ expect class AtomicRef<T> {
 }
 
 public expect fun <T> atomic(initial: T): AtomicRef<T>
+
+/**
+ * Makes [value] and everything reachable from it immutable, where supported.
+ */
+public expect fun <T> freezeGraph(value: T): T
+
+/**
+ * Starts [producers] concurrent producers, each submitting [jobsPerProducer] jobs to a single consumer
+ * and waiting for all of their results. Returns the sum of results.
+ */
+public expect fun submitJobs(producers: Int, jobsPerProducer: Int): Long
+
+/**
+ * Submits [count] jobs to a single consumer at once and waits for all of their results.
+ * Returns the sum of results.
+ */
+public expect fun submitJobsBatch(count: Int): Long
+
+/**
+ * Schedules [count] delayed no-op jobs on the current thread and cancels all of them.
+ * Returns the number of cancelled jobs.
+ */
+public expect fun scheduleAndCancelTimers(count: Int): Int
+
+/**
+ * Starts [readers] concurrent readers, each reading [references] shared atomic references to immutable objects
+ * in turn, [readsPerReader] reads in total. Returns the sum of the values read.
+ */
+public expect fun readSharedReferences(readers: Int, references: Int, readsPerReader: Int): Long
@@ -0,0 +1,31 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package org.jetbrains.ring
+
+/**
+ * Many producers submit small jobs to the same consumer at once, so this mostly measures
+ * contention on the job queue and on futures bookkeeping, or its cost for jobs submitted at once. Timer benchmarks schedule delayed jobs
+ * and cancel them before they expire, as typical for timeouts.
+ */
+open class WorkerBenchmark {
+    //Benchmark
+    fun submitJobs1Producer(): Long = submitJobs(1, 100_000)
+
+    //Benchmark
+    fun submitJobs4Producers(): Long = submitJobs(4, 25_000)
+
+    //Benchmark
+    fun submitJobs16Producers(): Long = submitJobs(16, 6_250)
+
+    //Benchmark
+    fun submitJobs32Producers(): Long = submitJobs(32, 3_125)
+
+    //Benchmark
+    fun submitJobsBatch100K(): Long = submitJobsBatch(100_000)
+
+    //Benchmark
+    fun scheduleAndCancel1MTimers(): Int = scheduleAndCancelTimers(1_000_000)
+}
@@ -20,6 +20,7 @@
 #include "KAssert.h"
 #include "Exceptions.h"
 #include "Memory.h"
+#include "KString.h"
 #include "Natives.h"
 #include "Types.h"
 
@@ -667,7 +668,7 @@ KNativePtr Kotlin_Arrays_getCharArrayAddressOfElement (KRef thiz, KInt index) {
 }
 
 KNativePtr Kotlin_Arrays_getStringAddressOfElement (KRef thiz, KInt index) {
-  return Kotlin_Arrays_getCharArrayAddressOfElement(thiz, index);
+  return const_cast<KChar*>(StringUtf16Chars(thiz->array())) + index;
 }
 
 KNativePtr Kotlin_Arrays_getShortArrayAddressOfElement(KRef thiz, KInt index) {
@@ -18,6 +18,7 @@
 #include "Common.h"
 #include "Exceptions.h"
 #include "Memory.h"
+#include "Parking.h"
 #include "Types.h"
 
 namespace {
@@ -68,6 +69,9 @@ inline AtomicReferenceLayout* asAtomicReference(KRef thiz) {
     return reinterpret_cast<AtomicReferenceLayout*>(thiz);
 }
 
+// Attempts to take contended kotlin.native.concurrent.Lock before parking.
+constexpr KInt kLockSpinAttempts = 8;
+
 }  // namespace
 
 extern "C" {
@@ -191,8 +195,10 @@ OBJ_GETTER(Kotlin_AtomicReference_compareAndSwap, KRef thiz, KRef expectedValue,
 
 KBoolean Kotlin_AtomicReference_compareAndSet(KRef thiz, KRef expectedValue, KRef newValue) {
     Kotlin_AtomicReference_checkIfFrozen(newValue);
-    // See Kotlin_AtomicReference_get() for explanations, why locking is needed.
     AtomicReferenceLayout* ref = asAtomicReference(thiz);
+    // Failed comparison does not touch reference counts, so no lock is needed to report it.
+    if (atomicGet(&ref->value_) != expectedValue) return false;
+    // See Kotlin_AtomicReference_get() for explanations, why locking is needed.
     ObjHolder holder;
     auto old = SwapHeapRefLocked(&ref->value_, expectedValue, newValue,
         &ref->lock_, &ref->cookie_, holder.slot());
@@ -209,9 +215,29 @@ OBJ_GETTER(Kotlin_AtomicReference_get, KRef thiz) {
     // Here we must take a lock to prevent race when value, while taken here, is CASed and immediately
     // destroyed by an another thread. AtomicReference no longer holds such an object, so if we got
     // rescheduled unluckily, between the moment value is read from the field and RC is incremented,
-    // object may go away.
+    // object may go away. Repeated reads of the same value on the same thread do not take the lock,
+    // see ReadHeapRefLocked().
     AtomicReferenceLayout* ref = asAtomicReference(thiz);
     RETURN_RESULT_OF(ReadHeapRefLocked, &ref->value_, &ref->lock_, &ref->cookie_);
 }
 
+void Kotlin_Lock_waitWhileLocked(KRef locker, KRef waiters, KInt lockData, KInt attempt) {
+    if (attempt < kLockSpinAttempts) {
+        // Exponential backoff, lock is usually released soon.
+        for (int i = 0; i < (1 << attempt); i++) SpinPause();
+        return;
+    }
+    volatile KInt* waitersCount = getValueLocation<KInt>(waiters);
+    // Unlocking thread checks waiters after releasing the lock, so it either sees us here,
+    // or the lock is already released and we do not park.
+    atomicAdd(waitersCount, 1);
+    ParkWait(getValueLocation<KInt>(locker), lockData);
+    atomicAdd(waitersCount, -1);
+}
+
+void Kotlin_Lock_wakeWaiter(KRef locker, KRef waiters) {
+    if (atomicGet(getValueLocation<KInt>(waiters)) != 0)
+        ParkWake(getValueLocation<KInt>(locker), false);
+}
+
 }  // extern "C"
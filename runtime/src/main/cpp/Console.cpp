@@ -21,8 +21,6 @@
 #include "Types.h"
 #include "Exceptions.h"
 
-#include "utf8.h"
-
 extern "C" {
 
 // io/Console.kt
@@ -31,11 +29,9 @@ void Kotlin_io_Console_print(KString message) {
     ThrowClassCastException(message->obj(), theStringTypeInfo);
   }
   // TODO: system stdout must be aware about UTF-8.
-  const KChar* utf16 = CharArrayAddressOfElementAt(message, 0);
   KStdString utf8;
-  utf8.reserve(message->count_);
-  // Replace incorrect sequences with a default codepoint (see utf8::with_replacement::default_replacement)
-  utf8::with_replacement::utf16to8(utf16, utf16 + message->count_, back_inserter(utf8));
+  // Replace incorrect sequences with a default codepoint.
+  StringToUtf8(message, &utf8);
   konan::consoleWriteUtf8(utf8.c_str(), utf8.size());
 }
 
@@ -28,6 +28,7 @@
 
 #if WITH_WORKERS
 #include <pthread.h>
+#include <sched.h>
 #include "PthreadUtils.h"
 #endif
 
@@ -49,7 +50,7 @@
  * such as `AtomicReference` and `FreezableAtomicReference` instances (further known as the atomic rootset).
  * We perform such analysis by iterating over the transitive closure of the atomic rootset, and computing
  * aggregated inner reference counter for rootset elements over this transitive closure.
- * Collector runs in its own thread and is started by an explicit request or after certain time interval since last
+ * Collector runs in its own threads and is started by an explicit request or after certain time interval since last
  * collection passes, thus its operation does not affect UI responsiveness in most cases.
  * Atomic rootset is built by maintaining the set of all atomic and freezable atomic references objects.
  * Elements whose transitive closure inner reference count matches the actual reference count are ones
@@ -62,8 +63,17 @@
  *   - if it is being decreased and object become garbage, it will be collected next time
  * If transitive closure of the atomic rootset mutates, it could only happen via changing the atomics references,
  * as all elements of this closure are frozen.
- * To handle such mutations we keep collector flag, which is cleared before analysis and set on every
- * atomic reference value update. If flag's value changes - collector restarts its analysis.
+ *
+ * The atomic rootset is split into partitions by the address of the atomic's value field, and each partition
+ * is analyzed separately, by one of the threads from the collector pool. Analysis starting from the subset of roots
+ * is still precise: inner reference counts are only computed over the closure of the subset, so references from
+ * outside of it are seen as external ones, and garbage cycle is always entirely inside of the closure of any of its
+ * atomics. Analysis only releases atomics of its own partition, cycles spanning several partitions are broken by
+ * analysis of any of them.
+ * Every partition has mutation epoch, which is bumped on every update of its atomics' values. Analysis remembers
+ * epochs of all partitions whose atomics it has reached so far, and restarts only if one of them changes, so
+ * mutations in unrelated parts of the heap do not affect it. Analysis also registers as a visitor of such
+ * partitions, so that atomic reference is not destroyed while being walked.
  * There are not so much of complications in this algorithm due to the delayed reference counting as if there's a
  * stack reference to the shared object - it's reflected in the reference counter (see rememberNewContainer()).
  * We release objects found by the collector on a rendezvouz callback, but not on the main thread,
@@ -71,6 +81,14 @@
  */
 namespace {
 
+// Number of the atomic rootset partitions, must be a power of two.
+constexpr int kPartitionCount = 16;
+// Default and maximal size of the collector thread pool.
+constexpr int kDefaultCollectorThreads = 4;
+constexpr int kMaxCollectorThreads = 16;
+// After that many restarts analysis of partition backs off for a while, to avoid GC thrashing.
+constexpr int kRestartsBeforeBackoff = 10;
+
 class Locker {
   pthread_mutex_t* lock_;
 
@@ -106,55 +124,118 @@ inline bool isAtomicReference(ObjHeader* obj) {
   return (obj->type_info()->flags_ & TF_LEAK_DETECTOR_CANDIDATE) != 0;
 }
 
+inline ObjHeader** valueLocation(ObjHeader* atomic) {
+  // Both atomic reference classes keep the value in their only reference field.
+  const TypeInfo* typeInfo = atomic->type_info();
+  RuntimeAssert(typeInfo->objOffsetsCount_ == 1, "Atomic reference must have single reference field");
+  return reinterpret_cast<ObjHeader**>(reinterpret_cast<uintptr_t>(atomic) + typeInfo->objOffsets_[0]);
+}
+
+// Partition is chosen by the value location, as this is all what is known on the atomic update.
+inline int partitionOf(ObjHeader** location) {
+  auto address = reinterpret_cast<uintptr_t>(location);
+  return static_cast<int>((address >> 4) ^ (address >> 10) ^ (address >> 16)) & (kPartitionCount - 1);
+}
+
 #define CHECK_CALL(call, message) RuntimeCheck((call) == 0, message)
 
+struct Partition {
+  // Guards rootset and toRelease.
+  pthread_mutex_t lock;
+  // Bumped on every update of the atomic references of this partition.
+  int32_t epoch;
+  // Number of analyses which may currently walk the atomics of this partition.
+  int32_t visitors;
+  int32_t pendingRelease;
+  KStdUnorderedSet<ObjHeader*> rootset;
+  KStdUnorderedSet<ObjHeader*> toRelease;
+};
+
+// Scratch state of the collector thread, reused between analyses.
+struct Analysis {
+  KStdDeque<ObjHeader*> toVisit;
+  KStdUnorderedSet<ObjHeader*> visited;
+  KStdUnorderedMap<ObjHeader*, int> sideRefCounts;
+  KStdVector<ObjHeader*> roots;
+  // Partitions reached during the current pass, with their epochs observed at that moment.
+  KStdVector<int> touched;
+  bool isTouched[kPartitionCount];
+  int32_t epochs[kPartitionCount];
+  int32_t mutationEpoch;
+
+  Analysis() {
+    for (int index = 0; index < kPartitionCount; index++) isTouched[index] = false;
+  }
+};
+
 class CyclicCollector {
+  // Guards thread pool, collection rounds and workers bookkeeping.
   pthread_mutex_t lock_;
   pthread_mutex_t timestampLock_;
+  pthread_mutex_t resizeLock_;
   pthread_cond_t cond_;
-  pthread_t gcThread_;
+  // Held for reading by analysis passes, and for writing by the local GC to wait for them.
+  pthread_rwlock_t heapLock_;
+  KStdVector<pthread_t> threads_;
+  Partition partitions_[kPartitionCount];
 
   int currentAliveWorkers_;
+  // Threads are started on the first atomic root, as there is nothing to collect before.
+  int32_t threadsStarted_;
   int gcRunning_;
-  int mutatedAtomics_;
-  int pendingRelease_;
-  bool shallRunCollector_;
-  bool terminateCollector_;
+  int nextPartition_;
+  int finishedPartitions_;
+  // Sum of all partition epochs, allows to skip checking individual partitions in most cases.
+  int32_t mutationEpoch_;
+  int32_t localGCWaiting_;
+  bool terminateThreads_;
   int32_t currentTick_;
   int32_t lastTick_;
   int64_t lastTimestampUs_;
   void* mainWorker_;
-  KStdUnorderedSet<ObjHeader*> rootset_;
-  KStdUnorderedSet<ObjHeader*> toRelease_;
 
  public:
   CyclicCollector() {
     CHECK_CALL(pthread_mutex_init(&lock_, nullptr), "Cannot init collector mutex")
     CHECK_CALL(pthread_mutex_init(&timestampLock_, nullptr), "Cannot init collector timestamp mutex")
+    CHECK_CALL(pthread_mutex_init(&resizeLock_, nullptr), "Cannot init collector resize mutex")
     CHECK_CALL(pthread_cond_init(&cond_, nullptr), "Cannot init collector condition")
-    CHECK_CALL(pthread_create(&gcThread_, nullptr, gcWorkerRoutine, this), "Cannot start collector thread")
+    CHECK_CALL(pthread_rwlock_init(&heapLock_, nullptr), "Cannot init collector heap lock")
+    for (int index = 0; index < kPartitionCount; index++) {
+      CHECK_CALL(pthread_mutex_init(&partitions_[index].lock, nullptr), "Cannot init partition mutex")
+    }
   }
 
   void clear() {
-    Locker lock(&lock_);
-    rootset_.clear();
-    toRelease_.clear();
+    for (int index = 0; index < kPartitionCount; index++) {
+      Locker lock(&partitions_[index].lock);
+      partitions_[index].rootset.clear();
+      partitions_[index].toRelease.clear();
+    }
   }
 
   void terminate(bool enabled) {
     {
       Locker locker(&lock_);
-      terminateCollector_ = true;
-      if (enabled) shallRunCollector_ = true;
-      CHECK_CALL(pthread_cond_signal(&cond_), "Cannot signal collector")
+      if (enabled && !gcRunning_) startRoundUnlocked();
+      // Let the current round complete, so that garbage found by it is released below.
+      while (gcRunning_)
+        CHECK_CALL(pthread_cond_wait(&cond_, &lock_), "Cannot wait collector condition")
+    }
+    {
+      Locker resize(&resizeLock_);
+      stopThreads();
     }
-    // TODO: improve waiting for collector termination.
-    while (atomicGet(&terminateCollector_)) {}
     releasePendingUnlocked(nullptr);
   }
 
   ~CyclicCollector() {
+    for (int index = 0; index < kPartitionCount; index++) {
+      pthread_mutex_destroy(&partitions_[index].lock);
+    }
+    pthread_rwlock_destroy(&heapLock_);
     pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&resizeLock_);
     pthread_mutex_destroy(&lock_);
     pthread_mutex_destroy(&timestampLock_);
   }
@@ -165,197 +246,323 @@ class CyclicCollector {
     return nullptr;
   }
 
+  void startThreadsUnlocked(int count) {
+    for (int index = 0; index < count; index++) {
+      pthread_t thread;
+      CHECK_CALL(pthread_create(&thread, nullptr, gcWorkerRoutine, this), "Cannot start collector thread")
+      threads_.push_back(thread);
+    }
+    atomicSet(&threadsStarted_, 1);
+  }
+
+  static int defaultThreads() {
+    int count = konan::availableProcessors() / 2;
+    return count < 1 ? 1 : (count < kDefaultCollectorThreads ? count : kDefaultCollectorThreads);
+  }
+
+  void startDefaultThreads() {
+    Locker resize(&resizeLock_);
+    Locker locker(&lock_);
+    if (threadsStarted_) return;
+    startThreadsUnlocked(defaultThreads());
+  }
+
+  // Threads only exit between partitions, so interrupted round is continued by the threads started later.
+  void stopThreads() {
+    KStdVector<pthread_t> threads;
+    {
+      Locker locker(&lock_);
+      terminateThreads_ = true;
+      CHECK_CALL(pthread_cond_broadcast(&cond_), "Cannot signal collector")
+      threads.swap(threads_);
+    }
+    for (auto thread: threads) {
+      CHECK_CALL(pthread_join(thread, nullptr), "Cannot join collector thread")
+    }
+    Locker locker(&lock_);
+    terminateThreads_ = false;
+  }
+
+  int threads() {
+    Locker locker(&lock_);
+    return threadsStarted_ ? threads_.size() : defaultThreads();
+  }
+
+  void setThreads(int count) {
+    if (count < 1) count = 1;
+    if (count > kMaxCollectorThreads) count = kMaxCollectorThreads;
+    Locker resize(&resizeLock_);
+    stopThreads();
+    Locker locker(&lock_);
+    startThreadsUnlocked(count);
+  }
+
+  void startRoundUnlocked() {
+    // No atomic roots yet, and no threads to run the round.
+    if (!threadsStarted_) return;
+    COLLECTOR_LOG("start cycle GC\n");
+    nextPartition_ = 0;
+    finishedPartitions_ = 0;
+    atomicSet(&gcRunning_, 1);
+    CHECK_CALL(pthread_cond_broadcast(&cond_), "Cannot signal collector")
+  }
+
   void gcProcessor() {
-     {
-       Locker locker(&lock_);
-       KStdDeque<ObjHeader*> toVisit;
-       KStdUnorderedSet<ObjHeader*> visited;
-       KStdUnorderedMap<ObjHeader*, int> sideRefCounts;
-       int restartCount = 0;
-       while (!terminateCollector_) {
-         CHECK_CALL(pthread_cond_wait(&cond_, &lock_), "Cannot wait collector condition")
-         if (!shallRunCollector_) continue;
-         atomicSet(&gcRunning_, 1);
-         restartCount = 0;
-        restart:
-         COLLECTOR_LOG("start cycle GC\n");
-         if (restartCount > 10 && !terminateCollector_) {
-           COLLECTOR_LOG("wait for some time to avoid GC thrashing\n");
-           uint64_t nsDelta = 1000LL * 1000LL * (restartCount - 10);
-           WaitOnCondVar(&cond_, &lock_, nsDelta);
-         }
-         atomicSet(&mutatedAtomics_, 0);
-         visited.clear();
-         toVisit.clear();
-         sideRefCounts.clear();
-         for (auto* root: rootset_) {
-           // We only care about frozen values here, as only they could become part of shared cycles.
-           if (!root->container()->frozen()) continue;
-           COLLECTOR_LOG("process root %p\n", root);
-           toVisit.push_back(root);
-           sideRefCounts[root] = 0;
-         }
-         while (toVisit.size() > 0)  {
-           if (atomicGet(&mutatedAtomics_) != 0) {
-             COLLECTOR_LOG("restarted during rootset visit\n")
-             restartCount++;
-             goto restart;
-           }
-           auto* obj = toVisit.front();
-           toVisit.pop_front();
-           COLLECTOR_LOG("visit %s%p\n", isAtomicReference(obj) ? "atomic " : "", obj);
-           auto* objContainer = obj->container();
-           if (objContainer == nullptr) continue;  // Permanent object.
-           RuntimeCheck(objContainer->shareable(), "Must be shareable");
-           if (visited.count(obj) == 0) {
-             visited.insert(obj);
-             traverseObjectFields(obj, [&toVisit, obj, &sideRefCounts](ObjHeader** location) {
-                ObjHeader* ref = *location;
-                if (ref != nullptr) {
-                  COLLECTOR_LOG("object field %p in %p\n", ref, obj)
-                  int increment;
-                  // We shall not account for edges inside the same frozen container, unless it originates
-                  // from an atomic reference.
-                  if (isAtomicReference(obj) || (obj->container() != ref->container())) {
-                    COLLECTOR_LOG("counting %p -> %p\n", obj, ref)
-                    increment = 1;
-                  } else {
-                    COLLECTOR_LOG("not counting %p -> %p\n", obj, ref)
-                    increment = 0;
-                  }
-                  sideRefCounts[ref] += increment;
-                  toVisit.push_back(ref);
-                }
-             });
-           }
-         }
-         // Now find all elements with external references, and mark objects reachable from them as non suitable
-         // for collection by setting their side reference count to -1.
-         toVisit.clear();
-         for (auto it: sideRefCounts) {
-           auto* obj = it.first;
-           auto* objContainer = obj->container();
-           if (objContainer == nullptr) continue;  // Permanent object.
-           int refCount;
-           // If object is in aggregated container - sum up RC for all elements.
-           if (objContainer->objectCount() != 1) {
-             RuntimeAssert(objContainer->frozen(), "Must be frozen aggregate");
-             ContainerHeader** subContainer = reinterpret_cast<ContainerHeader**>(objContainer + 1);
-             refCount = 0;
-             for (int i = 0; i < objContainer->objectCount(); ++i) {
-                 auto* componentObj = reinterpret_cast<ObjHeader*>((*subContainer) + 1);
-                 refCount += sideRefCounts[componentObj];
-                 subContainer++;
-               }
-           } else {
-             refCount = it.second;
-           }
-           RuntimeAssert(refCount <= objContainer->refCount(), "Must properly count inner refs");
-           if (refCount != objContainer->refCount()) {
-             COLLECTOR_LOG("for %p mismatched RC: %d vs %d, adding as possible root\n", obj, refCount, objContainer->refCount())
-             toVisit.push_back(it.first);
-           }
-         }
-         visited.clear();
-         while (toVisit.size() > 0)  {
-           auto* obj = toVisit.front();
-           toVisit.pop_front();
-           auto* objContainer = obj->container();
-           if (objContainer == nullptr) continue;  // Permanent object.
-           RuntimeCheck(objContainer->shareable(), "Must be shareable");
-           sideRefCounts[obj] = -1;
-           visited.insert(obj);
-           if (atomicGet(&mutatedAtomics_) != 0) {
-             COLLECTOR_LOG("restarted during reachable visit\n")
-             restartCount++;
-             goto restart;
-           }
-           traverseObjectFields(obj, [&toVisit, &visited](ObjHeader** location) {
-              ObjHeader* ref = *location;
-              if (ref != nullptr && (visited.count(ref) == 0)) {
-                toVisit.push_back(ref);
-              }
-           });
-         }
-         // Now release all atomic roots with matching reference counters, as only their destruction is controlled.
-         for (auto it: sideRefCounts) {
-           auto* obj = it.first;
-           // Only do that for atomic rootset elements. For them we also do not have sum up references from
-           // other elements of an aggregate, as atomic references are always in single object containers.
-           if (!isAtomicReference(obj)) {
-             continue;
-           }
-           if (atomicGet(&mutatedAtomics_) != 0) {
-             COLLECTOR_LOG("restarted during matching check\n")
-             restartCount++;
-             goto restart;
-           }
-           auto* objContainer = obj->container();
-           if (!objContainer->frozen()) continue;
-           RuntimeAssert(objContainer->objectCount() == 1, "Must be single object");
-           COLLECTOR_LOG("for %p inner %d actual %d\n", obj, it.second, objContainer->refCount());
-           // All references are inner. We compare the number of counted
-           // inner references with the number of non-stack references and per-thread ownership value
-           // (see rememberNewContainer()).
-           if (it.second == objContainer->refCount()) {
-             COLLECTOR_LOG("adding %p to release candidates\n", it.first);
-             toRelease_.insert(it.first);
+    Analysis analysis;
+    pthread_mutex_lock(&lock_);
+    while (true) {
+      while (!terminateThreads_ && !(gcRunning_ && nextPartition_ < kPartitionCount))
+        CHECK_CALL(pthread_cond_wait(&cond_, &lock_), "Cannot wait collector condition")
+      if (terminateThreads_) break;
+      int index = nextPartition_++;
+      pthread_mutex_unlock(&lock_);
+      analyzePartition(index, analysis);
+      pthread_mutex_lock(&lock_);
+      if (++finishedPartitions_ == kPartitionCount) {
+        COLLECTOR_LOG("end cycle GC\n");
+        atomicSet(&gcRunning_, 0);
+        CHECK_CALL(pthread_cond_broadcast(&cond_), "Cannot signal collector")
+      }
+    }
+    pthread_mutex_unlock(&lock_);
+  }
+
+  void analyzePartition(int index, Analysis& analysis) {
+    int restartCount = 0;
+    while (true) {
+      if (restartCount > kRestartsBeforeBackoff) {
+        COLLECTOR_LOG("wait for some time to avoid GC thrashing\n");
+        Locker locker(&lock_);
+        if (!terminateThreads_)
+          WaitOnCondVar(&cond_, &lock_, 1000LL * 1000LL * (restartCount - kRestartsBeforeBackoff));
+      }
+      // Let the local GC waiting for analysis to go first.
+      while (atomicGet(&localGCWaiting_) != 0) sched_yield();
+      CHECK_CALL(pthread_rwlock_rdlock(&heapLock_), "Cannot lock collector heap lock")
+      analysis.mutationEpoch = atomicGet(&mutationEpoch_);
+      bool completed = analyzePass(index, analysis);
+      for (auto touchedIndex: analysis.touched) {
+        atomicAdd(&partitions_[touchedIndex].visitors, -1);
+        analysis.isTouched[touchedIndex] = false;
+      }
+      analysis.touched.clear();
+      CHECK_CALL(pthread_rwlock_unlock(&heapLock_), "Cannot unlock collector heap lock")
+      if (completed) return;
+      restartCount++;
+    }
+  }
+
+  // Must be called before reading the values of the atomics in partition [index].
+  void touch(int index, Analysis& analysis) {
+    if (analysis.isTouched[index]) return;
+    atomicAdd(&partitions_[index].visitors, 1);
+    analysis.epochs[index] = atomicGet(&partitions_[index].epoch);
+    analysis.isTouched[index] = true;
+    analysis.touched.push_back(index);
+  }
+
+  bool mutated(Analysis& analysis) {
+    if (atomicGet(&localGCWaiting_) != 0) return true;
+    int32_t mutationEpoch = atomicGet(&mutationEpoch_);
+    if (mutationEpoch == analysis.mutationEpoch) return false;
+    for (auto index: analysis.touched) {
+      if (atomicGet(&partitions_[index].epoch) != analysis.epochs[index]) return true;
+    }
+    analysis.mutationEpoch = mutationEpoch;
+    return false;
+  }
+
+  bool analyzePass(int index, Analysis& analysis) {
+    Partition& partition = partitions_[index];
+    auto& toVisit = analysis.toVisit;
+    auto& visited = analysis.visited;
+    auto& sideRefCounts = analysis.sideRefCounts;
+    auto& roots = analysis.roots;
+    toVisit.clear();
+    visited.clear();
+    sideRefCounts.clear();
+    roots.clear();
+    // Registering as a visitor before taking the snapshot of the roots guarantees they are alive during the pass.
+    touch(index, analysis);
+    {
+      Locker locker(&partition.lock);
+      for (auto* root: partition.rootset) {
+        // We only care about frozen values here, as only they could become part of shared cycles.
+        if (root->container()->frozen()) roots.push_back(root);
+      }
+    }
+    if (roots.size() == 0) return true;
+    COLLECTOR_LOG("process partition %d with %d roots\n", index, roots.size());
+    for (auto* root: roots) {
+      toVisit.push_back(root);
+      sideRefCounts[root] = 0;
+    }
+    while (toVisit.size() > 0)  {
+      if (mutated(analysis)) {
+        COLLECTOR_LOG("restarted during rootset visit\n")
+        return false;
+      }
+      auto* obj = toVisit.front();
+      toVisit.pop_front();
+      COLLECTOR_LOG("visit %s%p\n", isAtomicReference(obj) ? "atomic " : "", obj);
+      auto* objContainer = obj->container();
+      if (objContainer == nullptr) continue;  // Permanent object.
+      RuntimeCheck(objContainer->shareable(), "Must be shareable");
+      if (visited.count(obj) == 0) {
+        visited.insert(obj);
+        if (isAtomicReference(obj)) {
+          touch(partitionOf(valueLocation(obj)), analysis);
+        }
+        traverseObjectFields(obj, [&toVisit, obj, &sideRefCounts](ObjHeader** location) {
+           ObjHeader* ref = *location;
+           if (ref != nullptr) {
+             COLLECTOR_LOG("object field %p in %p\n", ref, obj)
+             int increment;
+             // We shall not account for edges inside the same frozen container, unless it originates
+             // from an atomic reference.
+             if (isAtomicReference(obj) || (obj->container() != ref->container())) {
+               COLLECTOR_LOG("counting %p -> %p\n", obj, ref)
+               increment = 1;
+             } else {
+               COLLECTOR_LOG("not counting %p -> %p\n", obj, ref)
+               increment = 0;
+             }
+             sideRefCounts[ref] += increment;
+             toVisit.push_back(ref);
            }
+        });
+      }
+    }
+    // Now find all elements with external references, and mark objects reachable from them as non suitable
+    // for collection by setting their side reference count to -1.
+    toVisit.clear();
+    for (auto it: sideRefCounts) {
+      auto* obj = it.first;
+      auto* objContainer = obj->container();
+      if (objContainer == nullptr) continue;  // Permanent object.
+      int refCount;
+      // If object is in aggregated container - sum up RC for all elements.
+      if (objContainer->objectCount() != 1) {
+        RuntimeAssert(objContainer->frozen(), "Must be frozen aggregate");
+        ContainerHeader** subContainer = reinterpret_cast<ContainerHeader**>(objContainer + 1);
+        refCount = 0;
+        for (int i = 0; i < objContainer->objectCount(); ++i) {
+          auto* componentObj = reinterpret_cast<ObjHeader*>((*subContainer) + 1);
+          // Do not insert while iterating over the map.
+          auto component = sideRefCounts.find(componentObj);
+          if (component != sideRefCounts.end()) refCount += component->second;
+          subContainer++;
+        }
+      } else {
+        refCount = it.second;
+      }
+      RuntimeAssert(refCount <= objContainer->refCount(), "Must properly count inner refs");
+      if (refCount != objContainer->refCount()) {
+        COLLECTOR_LOG("for %p mismatched RC: %d vs %d, adding as possible root\n", obj, refCount, objContainer->refCount())
+        toVisit.push_back(it.first);
+      }
+    }
+    visited.clear();
+    while (toVisit.size() > 0)  {
+      auto* obj = toVisit.front();
+      toVisit.pop_front();
+      auto* objContainer = obj->container();
+      if (objContainer == nullptr) continue;  // Permanent object.
+      RuntimeCheck(objContainer->shareable(), "Must be shareable");
+      sideRefCounts[obj] = -1;
+      visited.insert(obj);
+      if (mutated(analysis)) {
+        COLLECTOR_LOG("restarted during reachable visit\n")
+        return false;
+      }
+      traverseObjectFields(obj, [&toVisit, &visited](ObjHeader** location) {
+         ObjHeader* ref = *location;
+         if (ref != nullptr && (visited.count(ref) == 0)) {
+           toVisit.push_back(ref);
          }
-         if (toRelease_.size() > 0)
-           atomicSet(&pendingRelease_, 1);
-         atomicSet(&gcRunning_, 0);
-         shallRunCollector_ = false;
-         COLLECTOR_LOG("end cycle GC\n");
-       }
-     }
-     atomicSet(&terminateCollector_, false);
+      });
+    }
+    // Now release atomic roots of this partition with matching reference counters, as only their destruction
+    // is controlled. Atomics of other partitions reached from here are left to their own analysis.
+    roots.clear();
+    for (auto it: sideRefCounts) {
+      auto* obj = it.first;
+      // Only do that for atomic rootset elements. For them we also do not have sum up references from
+      // other elements of an aggregate, as atomic references are always in single object containers.
+      if (!isAtomicReference(obj) || partitionOf(valueLocation(obj)) != index) {
+        continue;
+      }
+      if (mutated(analysis)) {
+        COLLECTOR_LOG("restarted during matching check\n")
+        return false;
+      }
+      auto* objContainer = obj->container();
+      if (!objContainer->frozen()) continue;
+      RuntimeAssert(objContainer->objectCount() == 1, "Must be single object");
+      COLLECTOR_LOG("for %p inner %d actual %d\n", obj, it.second, objContainer->refCount());
+      // All references are inner. We compare the number of counted
+      // inner references with the number of non-stack references and per-thread ownership value
+      // (see rememberNewContainer()).
+      if (it.second == objContainer->refCount()) {
+        COLLECTOR_LOG("adding %p to release candidates\n", it.first);
+        roots.push_back(obj);
+      }
+    }
+    if (roots.size() > 0) {
+      Locker locker(&partition.lock);
+      for (auto* obj: roots) {
+        if (partition.rootset.count(obj) != 0) partition.toRelease.insert(obj);
+      }
+      if (partition.toRelease.size() > 0)
+        atomicSet(&partition.pendingRelease, 1);
+    }
+    return true;
   }
 
   void addWorker(void* worker) {
-    suggestLockRelease();
     Locker lock(&lock_);
     currentAliveWorkers_++;
     if (mainWorker_ == nullptr) mainWorker_ = worker;
   }
 
   void removeWorker(void* worker, bool enabled) {
-    suggestLockRelease();
     Locker lock(&lock_);
     // When exiting the worker - we shall collect the cyclic garbage here.
-    if (enabled) {
-      shallRunCollector_ = true;
-      CHECK_CALL(pthread_cond_signal(&cond_), "Cannot signal collector")
-    }
+    if (enabled && !gcRunning_) startRoundUnlocked();
     currentAliveWorkers_--;
   }
 
   void addRoot(ObjHeader* obj) {
     COLLECTOR_LOG("add root %p\n", obj);
-    // TODO: we can only add root when collector is not processing, which looks like a limitation,
-    //  instead we can add elements to the side buffer or have a separate lock for that.
-    suggestLockRelease();
-    Locker lock(&lock_);
-    rootset_.insert(obj);
+    if (atomicGet(&threadsStarted_) == 0) startDefaultThreads();
+    Partition& partition = partitions_[partitionOf(valueLocation(obj))];
+    Locker lock(&partition.lock);
+    partition.rootset.insert(obj);
   }
 
   void removeRoot(ObjHeader* obj) {
     COLLECTOR_LOG("remove root %p\n", obj);
-    // Note that we can only remove root when the collector is not processing.
-    suggestLockRelease();
-    Locker lock(&lock_);
-    toRelease_.erase(obj);
-    rootset_.erase(obj);
+    int index = partitionOf(valueLocation(obj));
+    Partition& partition = partitions_[index];
+    {
+      Locker lock(&partition.lock);
+      partition.toRelease.erase(obj);
+      partition.rootset.erase(obj);
+    }
+    // Make analyses walking this partition restart, and wait until they stop using the object.
+    bumpEpoch(index);
+    while (atomicGet(&partition.visitors) != 0) sched_yield();
   }
 
-  void mutateRoot(ObjHeader* newValue) {
-    // TODO: consider optimization, when clearing value (setting to null) in atomic reference shall not lead
-    //   to invalidation of the collector analysis state.
-    atomicSet(&mutatedAtomics_, 1);
+  void bumpEpoch(int index) {
+    atomicAdd(&partitions_[index].epoch, 1);
+    atomicAdd(&mutationEpoch_, 1);
   }
 
-  void suggestLockRelease() {
-    atomicSet(&mutatedAtomics_, 1);
+  void mutateRoot(ObjHeader** location, ObjHeader* newValue) {
+    // TODO: consider optimization, when clearing value (setting to null) in atomic reference shall not lead
+    //   to invalidation of the collector analysis state.
+    bumpEpoch(partitionOf(location));
   }
 
   bool checkIfShallCollect() {
@@ -381,18 +588,19 @@ class CyclicCollector {
   void releasePendingUnlocked(void* worker) {
     // We are not doing that on the UI thread, as taking lock is slow, unless
     // it happens on deinit of the collector or if there are no other workers.
-    if ((atomicGet(&pendingRelease_) != 0) && ((worker != mainWorker_) || (currentAliveWorkers_ == 1))) {
-      KStdVector<ObjHeader*> heapRefsToRelease;
-
+    if ((worker == mainWorker_) && (currentAliveWorkers_ != 1)) return;
+    KStdVector<ObjHeader*> heapRefsToRelease;
+    for (int index = 0; index < kPartitionCount; index++) {
+      Partition& partition = partitions_[index];
+      if (atomicGet(&partition.pendingRelease) == 0) continue;
       {
-        suggestLockRelease();
-        Locker locker(&lock_);
-        COLLECTOR_LOG("clearing %d release candidates on %p\n", toRelease_.size(), worker);
-        for (auto* it: toRelease_) {
+        Locker locker(&partition.lock);
+        COLLECTOR_LOG("clearing %d release candidates on %p\n", partition.toRelease.size(), worker);
+        for (auto* it: partition.toRelease) {
           COLLECTOR_LOG("clear references in %p\n", it)
           traverseObjectFields(it, [&heapRefsToRelease](ObjHeader** location) {
-            // Avoid using ZeroHeapRef here: it can provoke garbageCollect() which would then stuck on taking [lock_]
-            // (which is already taken above).
+            // Avoid using ZeroHeapRef here: it can provoke garbageCollect() which would then stuck on taking
+            // partition lock (which is already taken above).
             auto* value = *location;
             if (reinterpret_cast<uintptr_t>(value) > 1) {
               *location = nullptr;
@@ -400,38 +608,39 @@ class CyclicCollector {
             }
           });
         }
-        toRelease_.clear();
-        atomicSet(&pendingRelease_, 0);
+        partition.toRelease.clear();
+        atomicSet(&partition.pendingRelease, 0);
       }
+      // Values of the atomics are changed, so analysis walking them must restart.
+      bumpEpoch(index);
+    }
 
-      for (auto* it: heapRefsToRelease) {
-        ReleaseHeapRef(it);
-      }
+    for (auto* it: heapRefsToRelease) {
+      ReleaseHeapRef(it);
     }
   }
 
   void collectorCallaback(void* worker) {
-    if (atomicGet(&gcRunning_) != 0) return;
     releasePendingUnlocked(worker);
+    if (atomicGet(&gcRunning_) != 0) return;
     if (checkIfShallCollect()) {
-      Locker locker(&lock_);
-      shallRunCollector_ = true;
-      CHECK_CALL(pthread_cond_signal(&cond_), "Cannot signal collector")
+      scheduleGarbageCollect();
     }
   }
 
   void scheduleGarbageCollect() {
     if (atomicGet(&gcRunning_) != 0) return;
     Locker lock(&lock_);
-    shallRunCollector_ = true;
-    CHECK_CALL(pthread_cond_signal(&cond_), "Cannot signal collector")
+    if (!gcRunning_) startRoundUnlocked();
   }
 
   void localGC() {
-    // We just need to take GC lock here, to avoid release of object we walk on.
-    // TODO: consider optimization without taking the lock and just notifying collector via an atomic.
-    suggestLockRelease();
-    Locker locker(&lock_);
+    // Wait for the analysis passes currently running, to avoid release of objects they walk on.
+    // Running passes notice the waiting GC and restart after it.
+    atomicAdd(&localGCWaiting_, 1);
+    CHECK_CALL(pthread_rwlock_wrlock(&heapLock_), "Cannot lock collector heap lock")
+    atomicAdd(&localGCWaiting_, -1);
+    CHECK_CALL(pthread_rwlock_unlock(&heapLock_), "Cannot unlock collector heap lock")
   }
 
 };
@@ -511,11 +720,11 @@ void cyclicRemoveAtomicRoot(ObjHeader* obj) {
 #endif  // WITH_WORKERS
 }
 
-void cyclicMutateAtomicRoot(ObjHeader* newValue) {
+void cyclicMutateAtomicRoot(ObjHeader** location, ObjHeader* newValue) {
 #if WITH_WORKERS
   auto* local = cyclicCollector;
   if (local)
-    local->mutateRoot(newValue);
+    local->mutateRoot(location, newValue);
 #endif  // WITH_WORKERS
 }
 
@@ -526,3 +735,20 @@ void cyclicLocalGC() {
     local->localGC();
 #endif  // WITH_WORKERS
 }
+
+int cyclicThreads() {
+#if WITH_WORKERS
+  auto* local = cyclicCollector;
+  if (local)
+    return local->threads();
+#endif  // WITH_WORKERS
+  return 0;
+}
+
+void cyclicSetThreads(int count) {
+#if WITH_WORKERS
+  auto* local = cyclicCollector;
+  if (local)
+    local->setThreads(count);
+#endif  // WITH_WORKERS
+}
@@ -9,9 +9,13 @@ void cyclicAddWorker(void* worker);
 void cyclicRemoveWorker(void* worker, bool enabled);
 void cyclicAddAtomicRoot(ObjHeader* obj);
 void cyclicRemoveAtomicRoot(ObjHeader* obj);
-void cyclicMutateAtomicRoot(ObjHeader* newValue);
+// Shall be called after [location] of an atomic reference is updated to [newValue].
+void cyclicMutateAtomicRoot(ObjHeader** location, ObjHeader* newValue);
 void cyclicCollectorCallback(void* worker);
 void cyclicLocalGC();
 void cyclicScheduleGarbageCollect();
+// Number of the collector threads, zero if there are no collector threads.
+int cyclicThreads();
+void cyclicSetThreads(int count);
 
 #endif  // RUNTIME_CYCLIC_COLLECTOR_H
\ No newline at end of file
@@ -22,46 +22,112 @@
 #include "Natives.h"
 #include "KString.h"
 #include "Porting.h"
+#include "TextKernels.h"
+#include "Transcoding.h"
 #include "Types.h"
 
 #include "utf8.h"
 
 namespace {
 
-typedef std::back_insert_iterator<KStdString> KStdStringInserter;
-typedef KChar* utf8to16(const char*, const char*, KChar*);
-typedef KStdStringInserter utf16to8(const KChar*,const KChar*, KStdStringInserter);
+// Longer strings would clash with the flags in count_, see KString.h.
+void checkStringLength(uint32_t length) {
+  if (length >= kStringBufferFlag) ThrowOutOfMemoryError();
+}
 
-KStdStringInserter utf16toUtf8OrThrow(const KChar* start, const KChar* end, KStdStringInserter result) {
-  TRY_CATCH(result = utf8::utf16to8(start, end, result),
-            result = utf8::unchecked::utf16to8(start, end, result),
-            ThrowCharacterCodingException());
-  return result;
+OBJ_GETTER(allocUtf16String, uint32_t length) {
+  checkStringLength(length);
+  RETURN_RESULT_OF(AllocArrayInstance, theStringTypeInfo, length);
 }
 
+typedef KChar* utf8to16(const char*, const char*, KChar*);
+
 template<utf8to16 conversion>
 OBJ_GETTER(utf8ToUtf16Impl, const char* rawString, const char* end, uint32_t charCount) {
   if (rawString == nullptr) RETURN_OBJ(nullptr);
-  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, charCount, OBJ_RESULT)->array();
+  ArrayHeader* result = allocUtf16String(charCount, OBJ_RESULT)->array();
   KChar* rawResult = CharArrayAddressOfElementAt(result, 0);
   auto convertResult = conversion(rawString, end, rawResult);
   RETURN_OBJ(result->obj());
 }
 
-template<utf16to8 conversion>
-OBJ_GETTER(unsafeUtf16ToUtf8Impl, KString thiz, KInt start, KInt size) {
+// Latin-1 string keeps two characters in each element of the string array, see KString.h.
+OBJ_GETTER(allocLatin1String, uint32_t length) {
+  if (length == 0) {
+    RETURN_RESULT_OF0(TheEmptyString);
+  }
+  checkStringLength(length);
+  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, Latin1StringElements(length), OBJ_RESULT)->array();
+  result->count_ = length | kStringLatin1Flag;
+  RETURN_OBJ(result->obj());
+}
+
+bool fitsLatin1(const KChar* chars, uint32_t length) {
+  return Utf16FitsLatin1(chars, chars + length);
+}
+
+// Creates Latin-1 string if all the characters allow, and UTF-16 string otherwise.
+OBJ_GETTER(createStringFromUtf16, const KChar* chars, uint32_t length) {
+  if (fitsLatin1(chars, length)) {
+    ArrayHeader* result = allocLatin1String(length, OBJ_RESULT)->array();
+    NarrowUtf16ToLatin1(chars, chars + length, Latin1StringAddressOfElementAt(result, 0));
+    RETURN_OBJ(result->obj());
+  }
+  ArrayHeader* result = allocUtf16String(length, OBJ_RESULT)->array();
+  memcpy(CharArrayAddressOfElementAt(result, 0), chars, length * sizeof(KChar));
+  RETURN_OBJ(result->obj());
+}
+
+// UTF-8 length of the string characters, wellFormed is set to false if there are lone surrogates.
+uint32_t stringUtf8Length(KString string, KInt start, KInt size, bool* wellFormed) {
+  if (IsLatin1String(string)) {
+    const uint8_t* latin1 = Latin1StringAddressOfElementAt(string, start);
+    *wellFormed = true;
+    return Latin1Utf8Length(latin1, latin1 + size);
+  }
+  const KChar* utf16 = Utf16StringAddressOfElementAt(string, start);
+  return Utf16Utf8Length(utf16, utf16 + size, wellFormed);
+}
+
+// Lone surrogates are replaced by U+FFFD.
+uint8_t* stringToUtf8(KString string, KInt start, KInt size, uint8_t* result) {
+  if (IsLatin1String(string)) {
+    const uint8_t* latin1 = Latin1StringAddressOfElementAt(string, start);
+    return EncodeLatin1ToUtf8(latin1, latin1 + size, result);
+  }
+  const KChar* utf16 = Utf16StringAddressOfElementAt(string, start);
+  return EncodeUtf16ToUtf8(utf16, utf16 + size, result);
+}
+
+OBJ_GETTER(unsafeStringToUtf8Impl, KString thiz, KInt start, KInt size, bool throwOnInvalid) {
   RuntimeAssert(thiz->type_info() == theStringTypeInfo, "Must use String");
-  const KChar* utf16 = CharArrayAddressOfElementAt(thiz, start);
-  KStdString utf8;
-  utf8.reserve(size);
-  conversion(utf16, utf16 + size, back_inserter(utf8));
-  ArrayHeader* result = AllocArrayInstance(theByteArrayTypeInfo, utf8.size(), OBJ_RESULT)->array();
-  ::memcpy(ByteArrayAddressOfElementAt(result, 0), utf8.c_str(), utf8.size());
+  bool wellFormed;
+  uint32_t length = stringUtf8Length(thiz, start, size, &wellFormed);
+  if (throwOnInvalid && !wellFormed) ThrowCharacterCodingException();
+  ArrayHeader* result = AllocArrayInstance(theByteArrayTypeInfo, length, OBJ_RESULT)->array();
+  stringToUtf8(thiz, start, size, reinterpret_cast<uint8_t*>(ByteArrayAddressOfElementAt(result, 0)));
+  RETURN_OBJ(result->obj());
+}
+
+// Well-formed UTF-8 is decoded in place, the rest is left to the slow path.
+OBJ_GETTER(decodeUtf8, const uint8_t* start, const uint8_t* end, const Utf8Scan& scan) {
+  if (scan.latin1) {
+    ArrayHeader* result = allocLatin1String(scan.utf16Length, OBJ_RESULT)->array();
+    DecodeUtf8ToLatin1(start, end, Latin1StringAddressOfElementAt(result, 0));
+    RETURN_OBJ(result->obj());
+  }
+  ArrayHeader* result = allocUtf16String(scan.utf16Length, OBJ_RESULT)->array();
+  DecodeUtf8ToUtf16(start, end, CharArrayAddressOfElementAt(result, 0));
   RETURN_OBJ(result->obj());
 }
 
 OBJ_GETTER(utf8ToUtf16OrThrow, const char* rawString, size_t rawStringLength) {
   const char* end = rawString + rawStringLength;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(rawString);
+  Utf8Scan scan = ScanUtf8(bytes, bytes + rawStringLength);
+  if (scan.wellFormed) {
+    RETURN_RESULT_OF(decodeUtf8, bytes, bytes + rawStringLength, scan);
+  }
   uint32_t charCount;
   TRY_CATCH(charCount = utf8::utf16_length(rawString, end),
             charCount = utf8::unchecked::utf16_length(rawString, end),
@@ -70,7 +136,13 @@ OBJ_GETTER(utf8ToUtf16OrThrow, const char* rawString, size_t rawStringLength) {
 }
 
 OBJ_GETTER(utf8ToUtf16, const char* rawString, size_t rawStringLength) {
+  if (rawString == nullptr) RETURN_OBJ(nullptr);
   const char* end = rawString + rawStringLength;
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(rawString);
+  Utf8Scan scan = ScanUtf8(bytes, bytes + rawStringLength);
+  if (scan.wellFormed) {
+    RETURN_RESULT_OF(decodeUtf8, bytes, bytes + rawStringLength, scan);
+  }
   uint32_t charCount = utf8::with_replacement::utf16_length(rawString, end);
   RETURN_RESULT_OF(utf8ToUtf16Impl<utf8::with_replacement::utf8to16>, rawString, end, charCount);
 }
@@ -700,6 +772,284 @@ int iswlower_Konan(KChar ch) {
 
 } // namespace
 
+namespace {
+
+// Operations on strings of either representation are templates over the type of characters,
+// uint8_t for Latin-1 and KChar for UTF-16.
+
+// Calls block with characters of the string starting at index.
+template <typename F>
+auto withChars(KString string, KInt index, F block) -> decltype(block(Utf16StringAddressOfElementAt(string, index))) {
+  if (IsLatin1String(string)) return block(Latin1StringAddressOfElementAt(string, index));
+  return block(Utf16StringAddressOfElementAt(string, index));
+}
+
+template <typename From, typename To>
+void copyChars(const From* from, To* to, uint32_t count) {
+  for (uint32_t index = 0; index < count; index++) {
+    to[index] = static_cast<To>(from[index]);
+  }
+}
+
+template <typename T>
+void copyChars(const T* from, T* to, uint32_t count) {
+  memcpy(to, from, count * sizeof(T));
+}
+
+template <typename T>
+void copyStringChars(KString from, KInt start, uint32_t count, T* to) {
+  withChars(from, start, [=](auto* chars) { copyChars(chars, to, count); });
+}
+
+template <typename T1, typename T2>
+bool equalChars(const T1* first, const T2* second, uint32_t count) {
+  return MismatchChars(first, second, count) == count;
+}
+
+template <typename T>
+bool equalChars(const T* first, const T* second, uint32_t count) {
+  return memcmp(first, second, count * sizeof(T)) == 0;
+}
+
+// Difference of the first characters having different lower case, or 0. Runs of characters
+// equal up to the case of ASCII letters are skipped at once.
+template <typename T1, typename T2>
+int compareCharsIgnoreCase(const T1* first, const T2* second, uint32_t count) {
+  uint32_t index = MismatchCharsIgnoreAsciiCase(first, second, count);
+  while (index < count) {
+    int diff = towlower_Konan(first[index]) - towlower_Konan(second[index]);
+    if (diff != 0) return diff;
+    index++;
+    index += MismatchCharsIgnoreAsciiCase(first + index, second + index, count - index);
+  }
+  return 0;
+}
+
+template <typename T1, typename T2>
+bool equalCharsIgnoreCase(const T1* first, const T2* second, uint32_t count) {
+  return compareCharsIgnoreCase(first, second, count) == 0;
+}
+
+// Difference of the first mismatching characters, or 0.
+template <typename T1, typename T2>
+int compareChars(const T1* first, const T2* second, uint32_t count) {
+  uint32_t index = MismatchChars(first, second, count);
+  if (index == count) return 0;
+  return static_cast<int>(first[index]) - static_cast<int>(second[index]);
+}
+
+int compareChars(const uint8_t* first, const uint8_t* second, uint32_t count) {
+  return memcmp(first, second, count);
+}
+
+// Strings of different representations are matched at the occurrences of the first character.
+template <typename T1, typename T2>
+KInt indexOfChars(const T1* chars, KInt count, const T2* other, KInt otherCount) {
+  const T1* last = chars + count - otherCount;
+  for (const T1* current = chars; (current = FindChar(current, last + 1, other[0])) != nullptr; current++) {
+    if (equalChars(current + 1, other + 1, otherCount - 1)) return current - chars;
+  }
+  return -1;
+}
+
+template <typename T>
+KInt indexOfChars(const T* chars, KInt count, const T* other, KInt otherCount) {
+  const T* result = FindChars(chars, chars + count, other, otherCount);
+  return result == nullptr ? -1 : result - chars;
+}
+
+// Last occurrence starting not after the given index.
+template <typename T1, typename T2>
+KInt lastIndexOfChars(const T1* chars, KInt start, const T2* other, KInt otherCount) {
+  const T1* end = chars + start + 1;
+  for (const T1* current; (current = FindLastChar(chars, end, other[0])) != nullptr; end = current) {
+    if (equalChars(current + 1, other + 1, otherCount - 1)) return current - chars;
+  }
+  return -1;
+}
+
+template <typename From, typename To>
+void replaceChars(const From* from, To* to, uint32_t count, KChar oldChar, KChar newChar, bool ignoreCase) {
+  if (ignoreCase) {
+    KChar oldCharLower = towlower_Konan(oldChar);
+    for (uint32_t index = 0; index < count; ++index) {
+      KChar thizChar = from[index];
+      to[index] = towlower_Konan(thizChar) == oldCharLower ? newChar : thizChar;
+    }
+  } else {
+    for (uint32_t index = 0; index < count; ++index) {
+      KChar thizChar = from[index];
+      to[index] = thizChar == oldChar ? newChar : thizChar;
+    }
+  }
+}
+
+bool canBeLatin1(KString string) {
+  return IsLatin1String(string) || fitsLatin1(Utf16StringAddressOfElementAt(string, 0), StringLength(string));
+}
+
+template <typename T>
+T* stringBufferChars(StringBuffer* buffer, uint32_t index) {
+  return reinterpret_cast<T*>(buffer + 1) + index;
+}
+
+template <typename T>
+void copyToStringBuffer(KString thiz, KString other, StringBuffer* buffer, uint32_t index) {
+  if (thiz != nullptr) copyStringChars(thiz, 0, StringLength(thiz), stringBufferChars<T>(buffer, 0));
+  copyStringChars(other, 0, StringLength(other), stringBufferChars<T>(buffer, index));
+}
+
+StringBuffer* allocStringBuffer(uint32_t capacity, bool latin1) {
+  size_t size = sizeof(StringBuffer) + capacity * (latin1 ? sizeof(uint8_t) : sizeof(KChar));
+  StringBuffer* buffer = reinterpret_cast<StringBuffer*>(konanAllocMemory(size));
+  if (buffer == nullptr) ThrowOutOfMemoryError();
+  AddExternalAllocation(static_cast<container_size_t>(size));
+  buffer->capacity_ = capacity;
+  return buffer;
+}
+
+// Appends other to the buffer of thiz, unless some other string was appended already, or there is no space.
+StringBuffer* appendInPlace(KString thiz, KString other) {
+  if (!IsBufferString(thiz)) return nullptr;
+  StringBuffer* buffer = StringBufferOf(thiz);
+  uint32_t thizLength = StringLength(thiz);
+  uint32_t length = thizLength + StringLength(other);
+  bool latin1 = IsLatin1String(thiz);
+  if (length > buffer->capacity_ || (latin1 && !canBeLatin1(other))) return nullptr;
+  // Characters before thizLength never change, so the strings sharing the buffer may be read concurrently.
+  if (!compareAndSet(&buffer->length_, thizLength, length)) return nullptr;
+  if (latin1) {
+    copyToStringBuffer<uint8_t>(nullptr, other, buffer, thizLength);
+  } else {
+    copyToStringBuffer<KChar>(nullptr, other, buffer, thizLength);
+  }
+  return buffer;
+}
+
+OBJ_GETTER(concatInBuffer, KString thiz, KString other) {
+  uint32_t thizLength = StringLength(thiz);
+  uint32_t length = thizLength + StringLength(other);
+  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, kBufferStringElements, OBJ_RESULT)->array();
+  StringBuffer* buffer = appendInPlace(thiz, other);
+  bool latin1;
+  if (buffer != nullptr) {
+    latin1 = IsLatin1String(thiz);
+  } else {
+    latin1 = canBeLatin1(thiz) && canBeLatin1(other);
+    // Most results are never appended to, so only the results of appending to a buffer string get spare
+    // capacity. Doubling the capacity makes repeated appends linear in the total length.
+    uint32_t capacity = length;
+    if (IsBufferString(thiz)) capacity = length < kStringBufferFlag / 2 ? length * 2 : kStringBufferFlag - 1;
+    buffer = allocStringBuffer(capacity, latin1);
+    buffer->length_ = length;
+    if (latin1) {
+      copyToStringBuffer<uint8_t>(thiz, other, buffer, thizLength);
+    } else {
+      copyToStringBuffer<KChar>(thiz, other, buffer, thizLength);
+    }
+  }
+  atomicAdd(&buffer->refCount_, 1);
+  *AddressOfElementAt<StringBuffer*>(result, 0) = buffer;
+  result->count_ = length | kStringBufferFlag | (latin1 ? kStringLatin1Flag : 0);
+  RETURN_OBJ(result->obj());
+}
+
+// ASCII letters are converted in bulk, the rest of characters one by one.
+template <KChar (*convert)(KChar)>
+OBJ_GETTER(convertCase, KString thiz, bool toUpper) {
+  uint32_t count = StringLength(thiz);
+  if (IsLatin1String(thiz)) {
+    const uint8_t* thizRaw = Latin1StringAddressOfElementAt(thiz, 0);
+    ArrayHeader* result = allocLatin1String(count, OBJ_RESULT)->array();
+    uint8_t* resultRaw = Latin1StringAddressOfElementAt(result, 0);
+    uint32_t index = ConvertAsciiCase(thizRaw, resultRaw, count, toUpper);
+    while (index < count) {
+      KChar converted = convert(thizRaw[index]);
+      // For example, upper case of U+00FF is U+0178.
+      if (converted > 0xff) break;
+      resultRaw[index++] = converted;
+      index += ConvertAsciiCase(thizRaw + index, resultRaw + index, count - index, toUpper);
+    }
+    if (index == count) RETURN_OBJ(result->obj());
+    // Rare case, so the whole string is converted again.
+  }
+  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, count, OBJ_RESULT)->array();
+  KChar* resultRaw = CharArrayAddressOfElementAt(result, 0);
+  if (IsLatin1String(thiz)) {
+    const uint8_t* thizRaw = Latin1StringAddressOfElementAt(thiz, 0);
+    for (uint32_t index = 0; index < count; ++index) {
+      resultRaw[index] = convert(thizRaw[index]);
+    }
+  } else {
+    const KChar* thizRaw = Utf16StringAddressOfElementAt(thiz, 0);
+    uint32_t index = ConvertAsciiCase(thizRaw, resultRaw, count, toUpper);
+    while (index < count) {
+      resultRaw[index] = convert(thizRaw[index]);
+      index++;
+      index += ConvertAsciiCase(thizRaw + index, resultRaw + index, count - index, toUpper);
+    }
+  }
+  RETURN_OBJ(result->obj());
+}
+
+// Same text has the same hash in both representations, so UTF-16 is hashed as Latin-1 when it fits.
+// Must match stringHashCode() in the compiler, which precomputes hashes of string literals.
+KInt computeHashCode(KString thiz) {
+  uint32_t length = StringLength(thiz);
+  if (IsLatin1String(thiz)) {
+    return CityHash64(Latin1StringAddressOfElementAt(thiz, 0), length);
+  }
+  const KChar* utf16 = Utf16StringAddressOfElementAt(thiz, 0);
+  if (!fitsLatin1(utf16, length)) {
+    return CityHash64(utf16, length * sizeof(KChar));
+  }
+  constexpr uint32_t kStackBufferSize = 256;
+  uint8_t stackBuffer[kStackBufferSize];
+  uint8_t* latin1 = length <= kStackBufferSize ? stackBuffer : konanAllocArray<uint8_t>(length);
+  NarrowUtf16ToLatin1(utf16, utf16 + length, latin1);
+  KInt result = CityHash64(latin1, length);
+  if (latin1 != stackBuffer) konanFreeMemory(latin1);
+  return result;
+}
+
+} // namespace
+
+const KChar* StringUtf16Chars(KString string) {
+  if (!IsLatin1String(string)) return Utf16StringAddressOfElementAt(string, 0);
+  MetaObjHeader* meta = const_cast<ObjHeader*>(string->obj())->meta_object();
+  KChar* utf16 = __atomic_load_n(&meta->String.utf16_, __ATOMIC_ACQUIRE);
+  if (utf16 != nullptr) return utf16;
+  uint32_t length = StringLength(string);
+  utf16 = konanAllocArray<KChar>(length);
+  const uint8_t* latin1 = Latin1StringAddressOfElementAt(string, 0);
+  InflateLatin1ToUtf16(latin1, latin1 + length, utf16);
+#if KONAN_NO_THREADS
+  meta->String.utf16_ = utf16;
+#else
+  KChar* old = __sync_val_compare_and_swap(&meta->String.utf16_, nullptr, utf16);
+  if (old != nullptr) {
+    // Someone inflated the string since the check.
+    konanFreeMemory(utf16);
+    utf16 = old;
+  }
+#endif
+  return utf16;
+}
+
+void ReleaseStringBuffer(KString string) {
+  StringBuffer* buffer = StringBufferOf(string);
+  if (atomicAdd(&buffer->refCount_, -1) == 0) konanFreeMemory(buffer);
+}
+
+bool StringToUtf8(KString string, KStdString* result) {
+  KInt length = StringLength(string);
+  bool wellFormed;
+  size_t offset = result->size();
+  result->resize(offset + stringUtf8Length(string, 0, length, &wellFormed));
+  stringToUtf8(string, 0, length, reinterpret_cast<uint8_t*>(&(*result)[offset]));
+  return wellFormed;
+}
+
 extern "C" {
 
 OBJ_GETTER(CreateStringFromCString, const char* cstring) {
@@ -713,12 +1063,11 @@ OBJ_GETTER(CreateStringFromUtf8, const char* utf8, uint32_t lengthBytes) {
 char* CreateCStringFromString(KConstRef kref) {
   if (kref == nullptr) return nullptr;
   KString kstring = kref->array();
-  const KChar* utf16 = CharArrayAddressOfElementAt(kstring, 0);
-  KStdString utf8;
-  utf8.reserve(kstring->count_);
-  utf8::unchecked::utf16to8(utf16, utf16 + kstring->count_, back_inserter(utf8));
-  char* result = reinterpret_cast<char*>(konan::calloc(1, utf8.size() + 1));
-  ::memcpy(result, utf8.c_str(), utf8.size());
+  KInt length = StringLength(kstring);
+  bool wellFormed;
+  uint32_t utf8Length = stringUtf8Length(kstring, 0, length, &wellFormed);
+  char* result = reinterpret_cast<char*>(konan::calloc(1, utf8Length + 1));
+  stringToUtf8(kstring, 0, length, reinterpret_cast<uint8_t*>(result));
   return result;
 }
 
@@ -728,22 +1077,18 @@ void DisposeCString(char* cstring) {
 
 // String.kt
 OBJ_GETTER(Kotlin_String_replace, KString thiz, KChar oldChar, KChar newChar, KBoolean ignoreCase) {
-  auto count = thiz->count_;
+  uint32_t count = StringLength(thiz);
+  if (IsLatin1String(thiz) && newChar <= 0xff) {
+    ArrayHeader* result = allocLatin1String(count, OBJ_RESULT)->array();
+    replaceChars(Latin1StringAddressOfElementAt(thiz, 0), Latin1StringAddressOfElementAt(result, 0), count,
+                 oldChar, newChar, ignoreCase);
+    RETURN_OBJ(result->obj());
+  }
   ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, count, OBJ_RESULT)->array();
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, 0);
   KChar* resultRaw = CharArrayAddressOfElementAt(result, 0);
-  if (ignoreCase) {
-    KChar oldCharLower = towlower_Konan(oldChar);
-    for (KInt index = 0; index < count; ++index) {
-      KChar thizChar = *thizRaw++;
-      *resultRaw++ = towlower_Konan(thizChar) == oldCharLower ? newChar : thizChar;
-    }
-  } else {
-    for (KInt index = 0; index < count; ++index) {
-      KChar thizChar = *thizRaw++;
-      *resultRaw++ = thizChar == oldChar ? newChar : thizChar;
-    }
-  }
+  withChars(thiz, 0, [=](auto* thizRaw) {
+    replaceChars(thizRaw, resultRaw, count, oldChar, newChar, ignoreCase);
+  });
   RETURN_OBJ(result->obj());
 }
 
@@ -752,42 +1097,32 @@ OBJ_GETTER(Kotlin_String_plusImpl, KString thiz, KString other) {
   RuntimeAssert(other != nullptr, "other cannot be null");
   RuntimeAssert(thiz->type_info() == theStringTypeInfo, "Must be a string");
   RuntimeAssert(other->type_info() == theStringTypeInfo, "Must be a string");
-  KInt result_length = thiz->count_ + other->count_;
-  if (result_length < thiz->count_ || result_length < other->count_) {
-    ThrowArrayIndexOutOfBoundsException();
+  uint32_t thizLength = StringLength(thiz);
+  uint32_t otherLength = StringLength(other);
+  uint32_t result_length = thizLength + otherLength;
+  checkStringLength(result_length);
+  if (result_length >= kStringBufferThreshold) {
+    RETURN_RESULT_OF(concatInBuffer, thiz, other);
+  }
+  // Literals are UTF-16, so check if UTF-16 operands could be Latin-1 as well.
+  if (canBeLatin1(thiz) && canBeLatin1(other)) {
+    ArrayHeader* result = allocLatin1String(result_length, OBJ_RESULT)->array();
+    copyStringChars(thiz, 0, thizLength, Latin1StringAddressOfElementAt(result, 0));
+    copyStringChars(other, 0, otherLength, Latin1StringAddressOfElementAt(result, thizLength));
+    RETURN_OBJ(result->obj());
   }
-  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, result_length, OBJ_RESULT)->array();
-  memcpy(
-      CharArrayAddressOfElementAt(result, 0),
-      CharArrayAddressOfElementAt(thiz, 0),
-      thiz->count_ * sizeof(KChar));
-  memcpy(
-      CharArrayAddressOfElementAt(result, thiz->count_),
-      CharArrayAddressOfElementAt(other, 0),
-      other->count_ * sizeof(KChar));
+  ArrayHeader* result = allocUtf16String(result_length, OBJ_RESULT)->array();
+  copyStringChars(thiz, 0, thizLength, CharArrayAddressOfElementAt(result, 0));
+  copyStringChars(other, 0, otherLength, CharArrayAddressOfElementAt(result, thizLength));
   RETURN_OBJ(result->obj());
 }
 
 OBJ_GETTER(Kotlin_String_toUpperCase, KString thiz) {
-  auto count = thiz->count_;
-  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, count, OBJ_RESULT)->array();
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, 0);
-  KChar* resultRaw = CharArrayAddressOfElementAt(result, 0);
-  for (KInt index = 0; index < count; ++index) {
-    *resultRaw++ = towupper_Konan(*thizRaw++);
-  }
-  RETURN_OBJ(result->obj());
+  RETURN_RESULT_OF(convertCase<towupper_Konan>, thiz, true);
 }
 
 OBJ_GETTER(Kotlin_String_toLowerCase, KString thiz) {
-  auto count = thiz->count_;
-  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, count, OBJ_RESULT)->array();
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, 0);
-  KChar* resultRaw = CharArrayAddressOfElementAt(result, 0);
-  for (KInt index = 0; index < count; ++index) {
-    *resultRaw++ = towlower_Konan(*thizRaw++);
-  }
-  RETURN_OBJ(result->obj());
+  RETURN_RESULT_OF(convertCase<towlower_Konan>, thiz, false);
 }
 
 OBJ_GETTER(Kotlin_String_unsafeStringFromCharArray, KConstRef thiz, KInt start, KInt size) {
@@ -798,23 +1133,17 @@ OBJ_GETTER(Kotlin_String_unsafeStringFromCharArray, KConstRef thiz, KInt start,
     RETURN_RESULT_OF0(TheEmptyString);
   }
 
-  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, size, OBJ_RESULT)->array();
-  memcpy(CharArrayAddressOfElementAt(result, 0),
-         CharArrayAddressOfElementAt(array, start),
-         size * sizeof(KChar));
-  RETURN_OBJ(result->obj());
+  RETURN_RESULT_OF(createStringFromUtf16, CharArrayAddressOfElementAt(array, start), size);
 }
 
 OBJ_GETTER(Kotlin_String_toCharArray, KString string, KInt start, KInt size) {
   ArrayHeader* result = AllocArrayInstance(theCharArrayTypeInfo, size, OBJ_RESULT)->array();
-  memcpy(CharArrayAddressOfElementAt(result, 0),
-         CharArrayAddressOfElementAt(string, start),
-         size * sizeof(KChar));
+  copyStringChars(string, start, size, CharArrayAddressOfElementAt(result, 0));
   RETURN_OBJ(result->obj());
 }
 
 OBJ_GETTER(Kotlin_String_subSequence, KString thiz, KInt startIndex, KInt endIndex) {
-  if (startIndex < 0 || endIndex > thiz->count_ || startIndex > endIndex) {
+  if (startIndex < 0 || static_cast<uint32_t>(endIndex) > StringLength(thiz) || startIndex > endIndex) {
     // TODO: is it correct exception?
     ThrowArrayIndexOutOfBoundsException();
   }
@@ -822,20 +1151,23 @@ OBJ_GETTER(Kotlin_String_subSequence, KString thiz, KInt startIndex, KInt endInd
     RETURN_RESULT_OF0(TheEmptyString);
   }
   KInt length = endIndex - startIndex;
-  ArrayHeader* result = AllocArrayInstance(theStringTypeInfo, length, OBJ_RESULT)->array();
-  memcpy(CharArrayAddressOfElementAt(result, 0),
-         CharArrayAddressOfElementAt(thiz, startIndex),
-         length * sizeof(KChar));
-  RETURN_OBJ(result->obj());
+  if (IsLatin1String(thiz)) {
+    ArrayHeader* result = allocLatin1String(length, OBJ_RESULT)->array();
+    memcpy(Latin1StringAddressOfElementAt(result, 0), Latin1StringAddressOfElementAt(thiz, startIndex), length);
+    RETURN_OBJ(result->obj());
+  }
+  RETURN_RESULT_OF(createStringFromUtf16, Utf16StringAddressOfElementAt(thiz, startIndex), length);
 }
 
 KInt Kotlin_String_compareTo(KString thiz, KString other) {
-  int result = memcmp(
-    CharArrayAddressOfElementAt(thiz, 0),
-    CharArrayAddressOfElementAt(other, 0),
-    (thiz->count_ < other->count_ ? thiz->count_ : other->count_) * sizeof(KChar));
+  uint32_t thizLength = StringLength(thiz);
+  uint32_t otherLength = StringLength(other);
+  uint32_t count = thizLength < otherLength ? thizLength : otherLength;
+  int result = withChars(thiz, 0, [=](auto* thizRaw) {
+    return withChars(other, 0, [=](auto* otherRaw) { return compareChars(thizRaw, otherRaw, count); });
+  });
   if (result != 0) return result;
-  int diff = thiz->count_ - other->count_;
+  int diff = thizLength - otherLength;
   if (diff == 0) return 0;
   return diff < 0 ? -1 : 1;
 }
@@ -846,17 +1178,17 @@ KInt Kotlin_String_compareToIgnoreCase(KString thiz, KConstRef other) {
   // Important, due to literal internalization.
   KString otherString = other->array();
   if (thiz == otherString) return 0;
-  auto count = thiz->count_ < otherString->count_ ? thiz->count_ : otherString->count_;
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, 0);
-  const KChar* otherRaw = CharArrayAddressOfElementAt(otherString, 0);
-  for (KInt index = 0; index < count; ++index) {
-    int diff = towlower_Konan(*thizRaw++) - towlower_Konan(*otherRaw++);
-    if (diff != 0)
-      return diff < 0 ? -1 : 1;
-  }
-  if (otherString->count_ == thiz->count_)
+  uint32_t thizLength = StringLength(thiz);
+  uint32_t otherLength = StringLength(otherString);
+  uint32_t count = thizLength < otherLength ? thizLength : otherLength;
+  int diff = withChars(thiz, 0, [=](auto* thizRaw) {
+    return withChars(otherString, 0, [=](auto* otherRaw) { return compareCharsIgnoreCase(thizRaw, otherRaw, count); });
+  });
+  if (diff != 0)
+    return diff < 0 ? -1 : 1;
+  if (otherLength == thizLength)
     return 0;
-  else if (otherString->count_ > thiz->count_)
+  else if (otherLength > thizLength)
     return -1;
   else
     return 1;
@@ -864,14 +1196,14 @@ KInt Kotlin_String_compareToIgnoreCase(KString thiz, KConstRef other) {
 
 
 KChar Kotlin_String_get(KString thiz, KInt index) {
-  if (static_cast<uint32_t>(index) >= thiz->count_) {
+  if (static_cast<uint32_t>(index) >= StringLength(thiz)) {
     ThrowArrayIndexOutOfBoundsException();
   }
-  return *CharArrayAddressOfElementAt(thiz, index);
+  return StringCharAt(thiz, index);
 }
 
 KInt Kotlin_String_getStringLength(KString thiz) {
-  return thiz->count_;
+  return StringLength(thiz);
 }
 
 const char* unsafeByteArrayAsCString(KConstRef thiz, KInt start, KInt size) {
@@ -897,20 +1229,18 @@ OBJ_GETTER(Kotlin_ByteArray_unsafeStringFromUtf8, KConstRef thiz, KInt start, KI
 }
 
 OBJ_GETTER(Kotlin_String_unsafeStringToUtf8, KString thiz, KInt start, KInt size) {
-  RETURN_RESULT_OF(unsafeUtf16ToUtf8Impl<utf8::with_replacement::utf16to8>, thiz, start, size);
+  RETURN_RESULT_OF(unsafeStringToUtf8Impl, thiz, start, size, false);
 }
 
 OBJ_GETTER(Kotlin_String_unsafeStringToUtf8OrThrow, KString thiz, KInt start, KInt size) {
-  RETURN_RESULT_OF(unsafeUtf16ToUtf8Impl<utf16toUtf8OrThrow>, thiz, start, size);
+  RETURN_RESULT_OF(unsafeStringToUtf8Impl, thiz, start, size, true);
 }
 
 KInt Kotlin_StringBuilder_insertString(KRef builder, KInt distIndex, KString fromString, KInt sourceIndex, KInt count) {
   auto toArray = builder->array();
-  RuntimeAssert(sourceIndex >= 0 && sourceIndex + count <= fromString->count_, "must be true");
+  RuntimeAssert(sourceIndex >= 0 && sourceIndex + count <= StringLength(fromString), "must be true");
   RuntimeAssert(distIndex >= 0 && distIndex + count <= toArray->count_, "must be true");
-  memcpy(CharArrayAddressOfElementAt(toArray, distIndex),
-         CharArrayAddressOfElementAt(fromString, sourceIndex),
-         count * sizeof(KChar));
+  copyStringChars(fromString, sourceIndex, count, CharArrayAddressOfElementAt(toArray, distIndex));
   return count;
 }
 
@@ -935,10 +1265,11 @@ KBoolean Kotlin_String_equals(KString thiz, KConstRef other) {
   // Important, due to literal internalization.
   KString otherString = other->array();
   if (thiz == otherString) return true;
-  return thiz->count_ == otherString->count_ &&
-      memcmp(CharArrayAddressOfElementAt(thiz, 0),
-             CharArrayAddressOfElementAt(otherString, 0),
-             thiz->count_ * sizeof(KChar)) == 0;
+  uint32_t length = StringLength(thiz);
+  if (length != StringLength(otherString)) return false;
+  return withChars(thiz, 0, [=](auto* thizRaw) {
+    return withChars(otherString, 0, [=](auto* otherRaw) { return equalChars(thizRaw, otherRaw, length); });
+  });
 }
 
 KBoolean Kotlin_String_equalsIgnoreCase(KString thiz, KConstRef other) {
@@ -947,36 +1278,28 @@ KBoolean Kotlin_String_equalsIgnoreCase(KString thiz, KConstRef other) {
   // Important, due to literal internalization.
   KString otherString = other->array();
   if (thiz == otherString) return true;
-  if (thiz->count_ != otherString->count_) return false;
-  auto count = thiz->count_;
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, 0);
-  const KChar* otherRaw = CharArrayAddressOfElementAt(otherString, 0);
-  for (KInt index = 0; index < count; ++index) {
-    if (towlower_Konan(*thizRaw++) != towlower_Konan(*otherRaw++)) return false;
-  }
-  return true;
+  uint32_t length = StringLength(thiz);
+  if (length != StringLength(otherString)) return false;
+  return withChars(thiz, 0, [=](auto* thizRaw) {
+    return withChars(otherString, 0, [=](auto* otherRaw) {
+      return equalCharsIgnoreCase(thizRaw, otherRaw, length);
+    });
+  });
 }
 
 KBoolean Kotlin_String_regionMatches(KString thiz, KInt thizOffset,
                                      KString other, KInt otherOffset,
                                      KInt length, KBoolean ignoreCase) {
   if (length < 0 ||
-      thizOffset < 0 || length > static_cast<KInt>(thiz->count_) - thizOffset ||
-      otherOffset < 0 || length > static_cast<KInt>(other->count_) - otherOffset) {
+      thizOffset < 0 || length > static_cast<KInt>(StringLength(thiz)) - thizOffset ||
+      otherOffset < 0 || length > static_cast<KInt>(StringLength(other)) - otherOffset) {
     return false;
   }
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, thizOffset);
-  const KChar* otherRaw = CharArrayAddressOfElementAt(other, otherOffset);
-  if (ignoreCase) {
-    for (KInt index = 0; index < length; ++index) {
-      if (towlower_Konan(*thizRaw++) != towlower_Konan(*otherRaw++)) return false;
-    }
-  } else {
-    for (KInt index = 0; index < length; ++index) {
-      if (*thizRaw++ != *otherRaw++) return false;
-    }
-  }
-  return true;
+  return withChars(thiz, thizOffset, [=](auto* thizRaw) {
+    return withChars(other, otherOffset, [=](auto* otherRaw) {
+      return ignoreCase ? equalCharsIgnoreCase(thizRaw, otherRaw, length) : equalChars(thizRaw, otherRaw, length);
+    });
+  });
 }
 
 KBoolean Kotlin_Char_isDefined(KChar ch) {
@@ -1072,64 +1395,58 @@ KInt Kotlin_String_indexOfChar(KString thiz, KChar ch, KInt fromIndex) {
   if (fromIndex < 0) {
     fromIndex = 0;
   }
-  if (fromIndex > thiz->count_) {
+  KInt count = StringLength(thiz);
+  if (fromIndex > count) {
     return -1;
   }
-  KInt count = thiz->count_;
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, fromIndex);
-  while (fromIndex < count) {
-    if (*thizRaw++ == ch) return fromIndex;
-    fromIndex++;
-  }
-  return -1;
+  return withChars(thiz, 0, [=](auto* thizRaw) -> KInt {
+    auto* result = FindChar(thizRaw + fromIndex, thizRaw + count, ch);
+    return result == nullptr ? -1 : result - thizRaw;
+  });
 }
 
 KInt Kotlin_String_lastIndexOfChar(KString thiz, KChar ch, KInt fromIndex) {
-  if (fromIndex < 0 || thiz->count_ == 0) {
+  KInt count = StringLength(thiz);
+  if (fromIndex < 0 || count == 0) {
     return -1;
   }
-  if (fromIndex >= thiz->count_) {
-    fromIndex = thiz->count_ - 1;
+  if (fromIndex >= count) {
+    fromIndex = count - 1;
   }
-  KInt count = thiz->count_;
   KInt index = fromIndex;
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, index);
-  while (index >= 0) {
-    if (*thizRaw-- == ch) return index;
-    index--;
-  }
-  return -1;
+  return withChars(thiz, 0, [=](auto* thizRaw) -> KInt {
+    auto* result = FindLastChar(thizRaw, thizRaw + index + 1, ch);
+    return result == nullptr ? -1 : result - thizRaw;
+  });
 }
 
-// TODO: or code up Knuth-Moris-Pratt.
 KInt Kotlin_String_indexOfString(KString thiz, KString other, KInt fromIndex) {
+  KInt count = StringLength(thiz);
+  KInt otherCount = StringLength(other);
   if (fromIndex < 0) {
     fromIndex = 0;
   }
-  if (fromIndex >= thiz->count_) {
-    return (other->count_ == 0) ? thiz->count_ : -1;
+  if (fromIndex >= count) {
+    return (otherCount == 0) ? count : -1;
   }
-  if (other->count_ > static_cast<KInt>(thiz->count_) - fromIndex) {
+  if (otherCount > count - fromIndex) {
     return -1;
   }
   // An empty string can be always found.
-  if (other->count_ == 0) {
+  if (otherCount == 0) {
     return fromIndex;
   }
-  KInt count = thiz->count_;
-  const KChar* thizRaw = CharArrayAddressOfElementAt(thiz, fromIndex);
-  const KChar* otherRaw = CharArrayAddressOfElementAt(other, 0);
-  void* result = konan::memmem(thizRaw, (thiz->count_ - fromIndex) * sizeof(KChar),
-                               otherRaw, other->count_ * sizeof(KChar));
-  if (result == nullptr) return -1;
-
-  return (reinterpret_cast<intptr_t>(result) - reinterpret_cast<intptr_t>(
-      CharArrayAddressOfElementAt(thiz, 0))) / sizeof(KChar);
+  KInt result = withChars(thiz, fromIndex, [=](auto* thizRaw) {
+    return withChars(other, 0, [=](auto* otherRaw) {
+      return indexOfChars(thizRaw, count - fromIndex, otherRaw, otherCount);
+    });
+  });
+  return result == -1 ? -1 : result + fromIndex;
 }
 
 KInt Kotlin_String_lastIndexOfString(KString thiz, KString other, KInt fromIndex) {
-  KInt count = thiz->count_;
-  KInt otherCount = other->count_;
+  KInt count = StringLength(thiz);
+  KInt otherCount = StringLength(other);
 
   if (fromIndex < 0 || otherCount > count) {
     return -1;
@@ -1141,39 +1458,37 @@ KInt Kotlin_String_lastIndexOfString(KString thiz, KString other, KInt fromIndex
   KInt start = fromIndex;
   if (fromIndex > count - otherCount)
     start = count - otherCount;
-  KChar firstChar = *CharArrayAddressOfElementAt(other, 0);
-  while (true) {
-    KInt candidate = Kotlin_String_lastIndexOfChar(thiz, firstChar, start);
-    if (candidate == -1) return -1;
-    KInt offsetThiz = candidate;
-    KInt offsetOther = 0;
-    while (++offsetOther < otherCount &&
-           *CharArrayAddressOfElementAt(thiz, ++offsetThiz) ==
-           *CharArrayAddressOfElementAt(other, offsetOther)) {}
-    if (offsetOther == otherCount) {
-      return candidate;
-    }
-    start = candidate - 1;
-  }
+  return withChars(thiz, 0, [=](auto* thizRaw) {
+    return withChars(other, 0, [=](auto* otherRaw) { return lastIndexOfChars(thizRaw, start, otherRaw, otherCount); });
+  });
 }
 
 KInt Kotlin_String_hashCode(KString thiz) {
-  // TODO: consider caching strings hashes.
   // TODO: maybe use some simpler hashing algorithm?
   // Note that we don't use Java's string hash.
-  return CityHash64(
-    CharArrayAddressOfElementAt(thiz, 0), thiz->count_ * sizeof(KChar));
+#if KONAN_STRING_HASH_CACHE
+  KInt result = __atomic_load_n(&thiz->hashCode_, __ATOMIC_RELAXED);
+  if (result != 0) return result;
+  result = computeHashCode(thiz);
+  // Permanent strings are read-only, the compiler precomputes their hashes.
+  if (!thiz->obj()->permanent()) {
+    // Racing threads store the same value.
+    __atomic_store_n(&const_cast<ArrayHeader*>(thiz)->hashCode_, result, __ATOMIC_RELAXED);
+  }
+  return result;
+#else
+  return computeHashCode(thiz);
+#endif
 }
 
 const KChar* Kotlin_String_utf16pointer(KString message) {
   RuntimeAssert(message->type_info() == theStringTypeInfo, "Must use a string");
-  const KChar* utf16 = CharArrayAddressOfElementAt(message, 0);
-  return utf16;
+  return StringUtf16Chars(message);
 }
 
 KInt Kotlin_String_utf16length(KString message) {
   RuntimeAssert(message->type_info() == theStringTypeInfo, "Must use a string");
-  return message->count_ * sizeof(KChar);
+  return StringLength(message) * sizeof(KChar);
 }
 
 
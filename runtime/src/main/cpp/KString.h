@@ -19,6 +19,7 @@
 
 #include "Common.h"
 #include "Memory.h"
+#include "Natives.h"
 #include "Types.h"
 #include "TypeInfo.h"
 
@@ -35,6 +36,88 @@ void DisposeCString(char* cstring);
 }
 #endif
 
+// Strings are stored either as UTF-16, or, if all the characters are below U+0100, as Latin-1 with a byte
+// per character. Latin-1 string has this bit set in count_, and is allocated as UTF-16 string of half the
+// length, so that object size computation stays correct. Both representations may hold the same text,
+// for example, literals emitted by the compiler are always UTF-16.
+constexpr uint32_t kStringLatin1Flag = 0x80000000U;
+
+// Results of concatenation of at least kStringBufferThreshold characters keep them in StringBuffer, and
+// the string itself only holds a pointer to it. Buffer is shared with the strings appended to the result later.
+// It has the exact size for the first result, and spare capacity once something is appended to a buffer string,
+// so that repeated concatenation takes linear time, see concatInBuffer. Buffer memory counts towards GC thresholds.
+// Such string has this bit set in count_, along with the Latin-1 one if the buffer is Latin-1.
+constexpr uint32_t kStringBufferFlag = 0x40000000U;
+constexpr uint32_t kStringBufferThreshold = 64;
+
+struct StringBuffer {
+  // Number of strings referring to the buffer.
+  int32_t refCount_;
+  // Number of characters in use, only the string of this length can append to the buffer in place.
+  uint32_t length_;
+  uint32_t capacity_;
+  // Characters follow.
+};
+
+// Number of UTF-16 string array elements holding the pointer to StringBuffer.
+constexpr uint32_t kBufferStringElements = sizeof(StringBuffer*) / sizeof(KChar);
+
+inline bool IsLatin1String(KString string) {
+  return (string->count_ & kStringLatin1Flag) != 0;
+}
+
+inline bool IsBufferString(KString string) {
+  return (string->count_ & kStringBufferFlag) != 0;
+}
+
+inline uint32_t StringLength(KString string) {
+  return string->count_ & ~(kStringLatin1Flag | kStringBufferFlag);
+}
+
+inline StringBuffer* StringBufferOf(KString string) {
+  return *AddressOfElementAt<StringBuffer*>(string, 0);
+}
+
+inline const void* StringBufferChars(const StringBuffer* buffer) {
+  return buffer + 1;
+}
+
+// Number of UTF-16 string array elements holding Latin-1 string of the given length.
+inline uint32_t Latin1StringElements(uint32_t length) {
+  return (length + 1) / 2;
+}
+
+// Characters of strings must be accessed with these, as they may be in StringBuffer.
+inline const uint8_t* Latin1StringAddressOfElementAt(KString string, KInt index) {
+  if (IsBufferString(string)) return static_cast<const uint8_t*>(StringBufferChars(StringBufferOf(string))) + index;
+  return AddressOfElementAt<uint8_t>(string, index);
+}
+
+inline uint8_t* Latin1StringAddressOfElementAt(ArrayHeader* string, KInt index) {
+  return const_cast<uint8_t*>(Latin1StringAddressOfElementAt(static_cast<KString>(string), index));
+}
+
+inline const KChar* Utf16StringAddressOfElementAt(KString string, KInt index) {
+  if (IsBufferString(string)) return static_cast<const KChar*>(StringBufferChars(StringBufferOf(string))) + index;
+  return CharArrayAddressOfElementAt(string, index);
+}
+
+inline KChar StringCharAt(KString string, KInt index) {
+  return IsLatin1String(string) ?
+      *Latin1StringAddressOfElementAt(string, index) : *Utf16StringAddressOfElementAt(string, index);
+}
+
+// UTF-16 characters of the string. Latin-1 string is inflated on the first request, and the copy
+// is kept as long as the string is alive, so this is meant for the interop only.
+const KChar* StringUtf16Chars(KString string);
+
+// Appends UTF-8 encoding of the string with lone surrogates replaced by U+FFFD, returns false if
+// there were such.
+bool StringToUtf8(KString string, KStdString* result);
+
+// Called when the string is deallocated.
+void ReleaseStringBuffer(KString string);
+
 template <typename T>
 int binarySearchRange(const T* array, int arrayLength, T needle) {
   int bottom = 0;
@@ -20,7 +20,19 @@
 #include <cstddef> // for offsetof
 
 // Allow concurrent global cycle collector.
-#define USE_CYCLIC_GC 0
+#define USE_CYCLIC_GC 1
+// Allow trial deletion of local cycle candidates on a background thread.
+#ifndef KONAN_NO_THREADS
+#define USE_CONCURRENT_CYCLE_GC 1
+#else
+#define USE_CONCURRENT_CYCLE_GC 0
+#endif
+// Split traversal of big object graphs being frozen between several threads.
+#ifndef KONAN_NO_THREADS
+#define USE_PARALLEL_FREEZE 1
+#else
+#define USE_PARALLEL_FREEZE 0
+#endif
 
 #include "Alloc.h"
 #include "KAssert.h"
@@ -33,6 +45,7 @@
 #include "Memory.h"
 #include "MemoryPrivate.hpp"
 #include "Natives.h"
+#include "Parking.h"
 #include "Porting.h"
 #include "Runtime.h"
 #include "WorkerBoundReference.h"
@@ -47,11 +60,17 @@
 #define TRACE_GC 0
 // Collect memory manager events statistics.
 #define COLLECT_STATISTIC 0
-// Define to 1 to print detailed time statistics for GC events.
-#define PROFILE_GC 0
+// Coalesce reference counter updates of repeatedly written heap slots until the next GC,
+// see logHeapWrite(). Only makes sense with the strict memory model GC.
+#define COALESCE_HEAP_WRITES USE_GC
 
-#if COLLECT_STATISTIC
 #include <algorithm>
+
+#if USE_CONCURRENT_CYCLE_GC || USE_PARALLEL_FREEZE
+#include <pthread.h>
+#include <unistd.h>
+
+#define CHECK_CALL(call, message) RuntimeCheck((call) == 0, message)
 #endif
 
 namespace {
@@ -101,9 +120,53 @@ constexpr size_t kMaxGcAllocThreshold = 8 * 1024 * 1024;
 constexpr double kGcCollectCyclesLoadRatio = 0.3;
 // Minimum time of cycles collection to change thresholds.
 constexpr size_t kGcCollectCyclesMinimumDuration = 200;
+// How many recent GC pauses are kept for the pause statistics.
+constexpr int kGcPauseHistorySize = 1024;
+// After that many concurrent cycle collections cancelled in a row, GC waits for the collector to finish.
+constexpr int kMaxCancelledConcurrentCycleCollections = 4;
+// Size of the nursery chunk.
+constexpr size_t kNurseryChunkSize = 256 * 1024;
+// Containers bigger than that are never placed in the nursery.
+constexpr size_t kNurseryMaxContainerSize = 256;
+// At most that many retired nursery chunks could be kept alive by their surviving containers.
+constexpr int kMaxRetiredNurseryChunks = 64;
+// Containers bigger than that are never kept for reuse.
+constexpr size_t kMaxRecycledContainerSize = 2048;
+// Number of size classes of containers kept for reuse.
+constexpr size_t kRecycledSizeClasses = kMaxRecycledContainerSize / 8 + 1;
+// How much memory in released containers is kept for reuse by default.
+constexpr size_t kRecycledContainersSizeLimit = 1024 * 1024;
+// Number of entries in the heap write log, must be power of two.
+constexpr size_t kHeapWriteLogSize = 256;
+// Number of entries in the cache of values remembered by atomic reads, must be power of two.
+constexpr size_t kRememberedValuesSize = 64;
+// With the pause target set, GC threshold is never decreased below that value.
+constexpr size_t kMinPauseTargetThreshold = 256;
+// Initial number of cycle candidates processed by a single cycle collection slice.
+constexpr size_t kCycleSliceRoots = 1024;
+// Never exceed this value when increasing number of candidates per cycle collection slice.
+constexpr size_t kMaxCycleSliceRoots = 1024 * 1024;
 
 #endif  // USE_GC
 
+#if USE_PARALLEL_FREEZE
+// Graphs of less containers than that are frozen by the calling thread alone.
+constexpr size_t kParallelFreezeThreshold = 16 * 1024;
+// Maximal number of threads freezing a single graph.
+constexpr int kMaxParallelFreezeWorkers = 8;
+// Low bits of container's freezing slot keep index of the worker owning the container.
+constexpr int kParallelFreezeWorkerBits = 3;
+// Reference counter of the container being frozen keeps its slot, so number of slots is limited.
+constexpr size_t kMaxParallelFreezeWorkerContainers = 1 << (30 - kParallelFreezeWorkerBits);
+// Number of containers handed to an idle freezing thread at once.
+constexpr size_t kParallelFreezeChunkSize = 256;
+
+static_assert(kMaxParallelFreezeWorkers <= (1 << kParallelFreezeWorkerBits), "Worker index must fit into slot");
+#endif  // USE_PARALLEL_FREEZE
+
+// Minimal size of the object region chunk, bigger objects get chunks of their own.
+constexpr container_size_t kObjectRegionChunkSize = 64 * 1024;
+
 typedef KStdUnorderedSet<ContainerHeader*> ContainerHeaderSet;
 typedef KStdVector<ContainerHeader*> ContainerHeaderList;
 typedef KStdDeque<ContainerHeader*> ContainerHeaderDeque;
@@ -124,12 +187,43 @@ FrameOverlay exportFrameOverlay;
 // Current number of allocated containers.
 volatile int allocCount = 0;
 volatile int aliveMemoryStatesCount = 0;
+#if USE_GC
+// Number of retired nursery chunks with containers still alive.
+volatile int retiredNurseryChunksCount = 0;
+#endif  // USE_GC
 
 KBoolean g_hasCyclicCollector = true;
 
+// Number of object regions guarded by all threads, heap writes are only inspected if there are some.
+volatile int guardedObjectRegionsCount = 0;
+
+struct ObjectRegion;
+#if USE_CONCURRENT_CYCLE_GC
+class ConcurrentCycleCollector;
+#endif  // USE_CONCURRENT_CYCLE_GC
+#if USE_GC
+struct NurseryChunk;
+class ContainerPositionIndex;
+#endif  // USE_GC
+
+#if COALESCE_HEAP_WRITES
+// Set once an object with reference slots is shared, then heap writes are no longer coalesced.
+volatile int hasSharedReferenceSlots = 0;
+
+struct HeapWriteLogEntry {
+  // Written heap slot, or nullptr if entry is unused.
+  ObjHeader** location;
+  // Value of the slot reference counters are accounted for.
+  const ObjHeader* accounted;
+};
+#endif  // COALESCE_HEAP_WRITES
+
 // TODO: can we pass this variable as an explicit argument?
 THREAD_LOCAL_VARIABLE MemoryState* memoryState = nullptr;
 THREAD_LOCAL_VARIABLE FrameOverlay* currentFrame = nullptr;
+struct GcTelemetry;
+// Telemetry of the current thread, if enabled.
+THREAD_LOCAL_VARIABLE GcTelemetry* gcTelemetry = nullptr;
 
 #if COLLECT_STATISTIC
 class MemoryStatistic {
@@ -156,6 +250,8 @@ public:
   uint64_t atomicReleaseRefs;
   // Number of potential cycle candidates.
   uint64_t releaseCyclicRefs;
+  // Number of heap updates not touching reference counters due to coalescing.
+  uint64_t coalescedUpdates;
 
   // Map of array index to human readable name.
   static constexpr const char* indexToName[] = {
@@ -191,6 +287,10 @@ public:
     updateCounters[toIndex(objOld, stack)][toIndex(objNew, stack)]++;
   }
 
+  void incCoalescedUpdate() {
+    coalescedUpdates++;
+  }
+
   void incAlloc(size_t size, const ContainerHeader* header) {
     containerAllocs[0]++;
     ++(*allocationHistogram)[size];
@@ -299,6 +399,8 @@ public:
                          addRefs, atomicAddRefs, percents(atomicAddRefs, allAddRefs),
                          releaseRefs, atomicReleaseRefs, percents(atomicReleaseRefs, allReleases),
                          releaseCyclicRefs, percents(releaseCyclicRefs, allReleases));
+    konan::consolePrintf("Coalesced heap updates: %lld (%.2lf%% of heap)\n",
+                         coalescedUpdates, percents(coalescedUpdates, heapUpdateRefs));
   }
 };
 
@@ -306,6 +408,114 @@ constexpr const char* MemoryStatistic::indexToName[];
 
 #endif  // COLLECT_STATISTIC
 
+// Indices of GC phases, which durations are measured by the telemetry.
+enum GcPhase {
+  kGcPhaseProcessDecrements,
+  kGcPhaseDecrementStack,
+  kGcPhaseFinalizerQueue,
+  kGcPhaseCollectCycles,
+  kGcPhaseCount
+};
+
+// Bucket i counts allocations of up to (16 << i) bytes, the last one counts all the bigger ones.
+constexpr int kGcAllocationHistogramSize = 13;
+
+// Indices of values in the statistics snapshot, keep in sync with GCStatistics.kt.
+enum GcStatisticIndex {
+  kGcStatCollections,
+  kGcStatCycleCollections,
+  kGcStatTotalPauseTime,
+  kGcStatMaxPauseTime,
+  kGcStatPhaseTime,
+  kGcStatThresholdAdjustments = kGcStatPhaseTime + kGcPhaseCount,
+  kGcStatCyclesThresholdAdjustments,
+  kGcStatAllocatedContainers,
+  kGcStatAllocatedBytes,
+  kGcStatFreedContainers,
+  kGcStatAddRefs,
+  kGcStatAtomicAddRefs,
+  kGcStatReleaseRefs,
+  kGcStatAtomicReleaseRefs,
+  kGcStatNurseryContainers,
+  kGcStatNurseryChunks,
+  kGcStatNurseryResets,
+  // Not owned by the thread, taken from retiredNurseryChunksCount when copied.
+  kGcStatRetiredNurseryChunks,
+  kGcStatAllocationHistogram,
+  kGcStatCount = kGcStatAllocationHistogram + kGcAllocationHistogramSize
+};
+
+/**
+ * Memory manager telemetry, which unlike MemoryStatistic is always compiled in and enabled at runtime,
+ * see GC.statisticsEnabled. Counters are owned by the thread, so no synchronization is needed, and
+ * when telemetry is disabled, each event costs a check of the thread-local pointer.
+ */
+struct GcTelemetry {
+  uint64_t values[kGcStatCount];
+  // Durations of phases of the last GC, in microseconds.
+  uint64_t lastPhaseTime[kGcPhaseCount];
+  // File where statistics of each GC are written as JSON lines, or -1.
+  int32_t stream = -1;
+
+  void onAlloc(size_t size) {
+    values[kGcStatAllocatedContainers]++;
+    values[kGcStatAllocatedBytes] += size;
+    int bucket = 0;
+    while (bucket < kGcAllocationHistogramSize - 1 && size > (16u << bucket)) bucket++;
+    values[kGcStatAllocationHistogram + bucket]++;
+  }
+
+  void onFree() {
+    values[kGcStatFreedContainers]++;
+  }
+
+  void onAddRef(bool atomic) {
+    values[atomic ? kGcStatAtomicAddRefs : kGcStatAddRefs]++;
+  }
+
+  void onReleaseRef(bool atomic) {
+    values[atomic ? kGcStatAtomicReleaseRefs : kGcStatReleaseRefs]++;
+  }
+
+  void onPhase(GcPhase phase, uint64_t duration) {
+    values[kGcStatPhaseTime + phase] += duration;
+    lastPhaseTime[phase] += duration;
+  }
+
+  void onGcStart() {
+    memset(lastPhaseTime, 0, sizeof(lastPhaseTime));
+  }
+
+  void onGcEnd(bool force, uint64_t pause, size_t toFree, size_t toRelease, size_t threshold,
+               uint64_t cyclesThreshold) {
+    values[kGcStatCollections]++;
+    values[kGcStatTotalPauseTime] += pause;
+    if (pause > values[kGcStatMaxPauseTime]) values[kGcStatMaxPauseTime] = pause;
+    if (stream < 0) return;
+    char buffer[512];
+    int length = konan::snprintf(buffer, sizeof(buffer),
+        "{\"gc\":%llu,\"forced\":%s,\"pauseUs\":%llu,\"processDecrementsUs\":%llu,\"decrementStackUs\":%llu,"
+        "\"finalizerQueueUs\":%llu,\"collectCyclesUs\":%llu,\"toFree\":%llu,\"toRelease\":%llu,"
+        "\"threshold\":%llu,\"cyclesThreshold\":%llu,\"allocatedBytes\":%llu}\n",
+        static_cast<unsigned long long>(values[kGcStatCollections]), force ? "true" : "false",
+        static_cast<unsigned long long>(pause),
+        static_cast<unsigned long long>(lastPhaseTime[kGcPhaseProcessDecrements]),
+        static_cast<unsigned long long>(lastPhaseTime[kGcPhaseDecrementStack]),
+        static_cast<unsigned long long>(lastPhaseTime[kGcPhaseFinalizerQueue]),
+        static_cast<unsigned long long>(lastPhaseTime[kGcPhaseCollectCycles]),
+        static_cast<unsigned long long>(toFree), static_cast<unsigned long long>(toRelease),
+        static_cast<unsigned long long>(threshold), static_cast<unsigned long long>(cyclesThreshold),
+        static_cast<unsigned long long>(values[kGcStatAllocatedBytes]));
+    if (length <= 0 || static_cast<size_t>(length) >= sizeof(buffer)) return;
+    if (!konan::fileWrite(stream, buffer, length)) {
+      konan::consoleErrorf("Cannot write GC statistics, the stream is stopped\n");
+      konan::fileClose(stream);
+      stream = -1;
+    }
+  }
+};
+
+
 inline bool isPermanentOrFrozen(ContainerHeader* container) {
     return container == nullptr || container->frozen();
 }
@@ -428,6 +638,11 @@ struct MemoryState {
   KRef* tlsMapLastStart;
   void* tlsMapLastKey;
 
+  // Region where new objects are placed instead of the heap, if any.
+  ObjectRegion* allocationRegion;
+  // Innermost region whose references from outside are counted, if any.
+  ObjectRegion* guardedRegion;
+
 #if USE_GC
   // Finalizer queue - linked list of containers scheduled for finalization.
   ContainerHeader* finalizerQueue;
@@ -449,10 +664,19 @@ struct MemoryState {
   size_t gcThreshold;
   // How many candidate elements in toFree shall trigger cycle collection.
   uint64_t gcCollectCyclesThreshold;
+  // Desired maximal GC pause in microseconds, or 0 if pauses are not bounded.
+  uint64_t gcPauseTarget;
+  // How many cycle candidates are processed by a single slice of incremental cycle collection.
+  size_t cycleSliceRoots;
+  // If incremental cycle collection has started and toFree is not drained yet.
+  bool cycleCollectionInProgress;
   // If collection is in progress.
   bool gcInProgress;
   // Objects to be released.
   ContainerHeaderList* toRelease;
+  // Positions of containers in toFree and toRelease, used by transfers of object graphs.
+  ContainerPositionIndex* toFreeIndex;
+  ContainerPositionIndex* toReleaseIndex;
 
   ForeignRefManager* foreignRefManager;
 
@@ -463,6 +687,43 @@ struct MemoryState {
 
   uint64_t allocSinceLastGc;
   uint64_t allocSinceLastGcThreshold;
+
+  // Chunk where small containers are currently placed.
+  NurseryChunk* nursery;
+
+  // Released containers kept for reuse, linked lists by size class.
+  ContainerHeader* recycledContainers[kRecycledSizeClasses];
+  // Total size of containers kept for reuse.
+  size_t recycledContainersSize;
+  // Maximal total size of containers kept for reuse.
+  size_t recycledContainersSizeLimit;
+
+#if COALESCE_HEAP_WRITES
+  // Heap slots written since the last GC, direct-mapped by the slot address.
+  HeapWriteLogEntry heapWriteLog[kHeapWriteLogSize];
+  // Number of used heap write log entries.
+  int heapWriteLogCount;
+#endif  // COALESCE_HEAP_WRITES
+
+  // Values read from shared locations and remembered by this thread since its last GC, direct-mapped
+  // by the value address. See readHeapRefLocked().
+  ObjHeader* rememberedValues[kRememberedValuesSize];
+  // GC epoque of the remembered values, entries are stale if it doesn't match gcEpoque.
+  uint32_t rememberedValuesEpoque;
+
+  // Ring buffer with durations of the recent GC pauses, in microseconds.
+  uint32_t gcPauses[kGcPauseHistorySize];
+  // Total number of recorded GC pauses.
+  uint64_t gcPauseCount;
+
+#if USE_CONCURRENT_CYCLE_GC
+  // Background collector for the cycle candidates, if concurrent cycle collection is enabled.
+  ConcurrentCycleCollector* concurrentCycleCollector;
+  // Candidate garbage cycles found by the background collector, awaiting validation by the current GC.
+  KStdVector<ContainerHeaderList>* pendingCycles;
+  // How many background collections were cancelled in a row.
+  int cancelledConcurrentCycleCollections;
+#endif  // USE_CONCURRENT_CYCLE_GC
 #endif // USE_GC
 
   // A stack of initializing singletons.
@@ -481,6 +742,8 @@ struct MemoryState {
       state->statistic.incAddRef(obj, atomic, stack);
   #define UPDATE_RELEASEREF_STAT(state, obj, atomic, cyclic, stack) \
         state->statistic.incReleaseRef(obj, atomic, cyclic, stack);
+  #define UPDATE_COALESCED_STAT(state) \
+        state->statistic.incCoalescedUpdate();
   #define INIT_STAT(state) \
     state->statistic.init();
   #define DEINIT_STAT(state) \
@@ -495,6 +758,7 @@ struct MemoryState {
   #define UPDATE_REF_STAT(state, oldRef, newRef, slot, stack)
   #define UPDATE_ADDREF_STAT(state, obj, atomic, stack)
   #define UPDATE_RELEASEREF_STAT(state, obj, atomic, cyclic, stack)
+  #define UPDATE_COALESCED_STAT(state)
   #define INIT_STAT(state)
   #define DEINIT_STAT(state)
   #define PRINT_STAT(state)
@@ -533,11 +797,13 @@ namespace {
 // Called on container allocation.
 #define CONTAINER_ALLOC_EVENT(state, size, container) \
   CONTAINER_ALLOC_STAT(state, size, container) \
-  CONTAINER_ALLOC_TRACE(state, size, container)
+  CONTAINER_ALLOC_TRACE(state, size, container) \
+  if (gcTelemetry != nullptr) gcTelemetry->onAlloc(size);
 // Called on container destroy (memory is released to allocator).
 #define CONTAINER_DESTROY_EVENT(state, container) \
   CONTAINER_DESTROY_STAT(state, container) \
-  CONTAINER_DESTROY_TRACE(state, container)
+  CONTAINER_DESTROY_TRACE(state, container) \
+  if (gcTelemetry != nullptr) gcTelemetry->onFree();
 // Object was just allocated.
 #define OBJECT_ALLOC_EVENT(state, size, object) \
   OBJECT_ALLOC_STAT(state, size, object) \
@@ -556,6 +822,7 @@ namespace {
 
 // Forward declarations.
 void freeContainer(ContainerHeader* header) NO_INLINE;
+void setGCStatistics(KBoolean value);
 #if USE_GC
 void garbageCollect(MemoryState* state, bool force) NO_INLINE;
 void cyclicGarbageCollect() NO_INLINE;
@@ -625,6 +892,8 @@ class ArenaContainer;
 struct ContainerChunk {
   ContainerChunk* next;
   ArenaContainer* arena;
+  // End of the chunk memory.
+  uint8_t* end;
   // Then we have ContainerHeader here.
   ContainerHeader* asHeader() {
     return reinterpret_cast<ContainerHeader*>(this + 1);
@@ -633,7 +902,8 @@ struct ContainerChunk {
 
 class ArenaContainer {
  public:
-  void Init();
+  // Chunks after the first one are at least minChunkSize bytes, or just fit the object if it is zero.
+  void Init(container_size_t minChunkSize = 0);
   void Deinit();
 
   // Place individual object in this container.
@@ -646,6 +916,17 @@ class ArenaContainer {
 
   ObjHeader** getSlot();
 
+  // Checks if container is a chunk of this arena.
+  bool Owns(const ContainerHeader* header) const {
+    return header != nullptr && header->stack() && (reinterpret_cast<const ContainerChunk*>(header) - 1)->arena == this;
+  }
+
+  // Checks that objects in this arena only refer to each other, and to permanent or shareable objects.
+  bool IsSelfContained() const;
+
+  // Chunks are listed from the newest one.
+  ContainerChunk* currentChunk() const { return currentChunk_; }
+
  private:
   void* place(container_size_t size);
 
@@ -662,6 +943,55 @@ class ArenaContainer {
   uint8_t* end_;
   ArrayHeader* slots_;
   uint32_t slotsCount_;
+  container_size_t minChunkSize_;
+};
+
+// Arena whose objects are handed over between workers as a whole, see DetachedObjectRegion.
+struct ObjectRegion {
+  ArenaContainer arena;
+  // Slot in the arena keeping the root of the sealed region.
+  ObjHeader** root;
+  // References to region objects from heap slots outside of the region and from stable pointers, counted
+  // while the region is guarded, see trackRegionRef(). Region cannot be released while there are some.
+  int32_t outsideRefs;
+  // Regions of the thread to restore when this one is left.
+  ObjectRegion* previousAllocationRegion;
+  ObjectRegion* previousGuardedRegion;
+  // Ends of the arena chunks by their starts, and the newest chunk indexed so far, see contains().
+  KStdOrderedMap<uintptr_t, uintptr_t> chunks;
+  ContainerChunk* indexedChunk;
+
+  // Checks if address belongs to the region memory.
+  bool contains(const void* address);
+};
+
+// Region where new objects of the current thread shall be placed, if any.
+inline ObjectRegion* allocationRegion(MemoryState* state) {
+  return state != nullptr ? state->allocationRegion : nullptr;
+}
+
+void trackRegionRefSlowPath(ObjHeader** location, const ObjHeader* old, const ObjHeader* object) NO_INLINE;
+
+// Called on every update of heap slot or stable pointer, location is nullptr for the latter.
+inline void trackRegionRef(ObjHeader** location, const ObjHeader* old, const ObjHeader* object) {
+  if (atomicGet(&guardedObjectRegionsCount) != 0)
+    trackRegionRefSlowPath(location, old, object);
+}
+
+// Singletons are referred by globals, so they are never placed into the object region being filled.
+class ObjectRegionSuspender {
+ public:
+  explicit ObjectRegionSuspender(MemoryState* state) : state_(state), region_(allocationRegion(state)) {
+    if (region_ != nullptr) state_->allocationRegion = nullptr;
+  }
+
+  ~ObjectRegionSuspender() {
+    if (region_ != nullptr) state_->allocationRegion = region_;
+  }
+
+ private:
+  MemoryState* state_;
+  ObjectRegion* region_;
 };
 
 constexpr int kFrameOverlaySlots = sizeof(FrameOverlay) / sizeof(ObjHeader**);
@@ -691,6 +1021,57 @@ inline ContainerHeader* clearRemoved(ContainerHeader* container) {
     reinterpret_cast<uintptr_t>(container) & ~static_cast<uintptr_t>(1));
 }
 
+#if USE_GC
+/**
+ * Positions of containers in a list only growing between collections, such as toFree or toRelease.
+ * Index is built lazily, so that only transfers of object graphs to other workers pay for it,
+ * and is reset by GC, reorganizing the lists.
+ */
+class ContainerPositionIndex {
+ public:
+  void reset() {
+    if (previous_.empty()) return;
+    latest_.clear();
+    previous_.clear();
+  }
+
+  // Indexes entries appended to the list since the last call.
+  void update(const ContainerHeaderList& list) {
+    RuntimeAssert(previous_.size() <= list.size(), "List must not shrink until reset");
+    for (size_t position = previous_.size(); position < list.size(); position++) {
+      auto* container = list[position];
+      if (isMarkedAsRemoved(container)) {
+        previous_.push_back(kNoPosition);
+        continue;
+      }
+      auto it = latest_.emplace(container, kNoPosition).first;
+      previous_.push_back(it->second);
+      it->second = position;
+    }
+  }
+
+  // Calls process() for each position of the container in the indexed list.
+  template <typename func>
+  void forEach(const ContainerHeaderList& list, ContainerHeader* container, func process) {
+    auto it = latest_.find(container);
+    if (it == latest_.end()) return;
+    for (size_t position = it->second; position != kNoPosition; position = previous_[position]) {
+      // Entry could have been marked as removed since.
+      if (list[position] == container)
+        process(position);
+    }
+  }
+
+ private:
+  static constexpr size_t kNoPosition = static_cast<size_t>(-1);
+
+  // Last position of each container in the list.
+  KStdUnorderedMap<ContainerHeader*, size_t> latest_;
+  // For each position, previous position of the same container in the list.
+  KStdVector<size_t> previous_;
+};
+#endif  // USE_GC
+
 inline container_size_t alignUp(container_size_t size, int alignment) {
   return (size + alignment - 1) & ~(alignment - 1);
 }
@@ -708,7 +1089,12 @@ inline uint32_t arrayObjectSize(const TypeInfo* typeInfo, uint32_t count) {
 }
 
 inline uint32_t arrayObjectSize(const ArrayHeader* obj) {
-  return arrayObjectSize(obj->type_info(), obj->count_);
+  const TypeInfo* typeInfo = obj->type_info();
+  if (typeInfo == theStringTypeInfo) {
+    if (IsBufferString(obj)) return arrayObjectSize(typeInfo, kBufferStringElements);
+    if (IsLatin1String(obj)) return arrayObjectSize(typeInfo, Latin1StringElements(StringLength(obj)));
+  }
+  return arrayObjectSize(typeInfo, obj->count_);
 }
 
 // TODO: shall we do padding for alignment?
@@ -776,11 +1162,11 @@ inline bool isRefCounted(KConstRef object) {
 }
 
 inline void lock(KInt* spinlock) {
-  while (compareAndSwap(spinlock, 0, 1) != 0) {}
+  ParkingLock(spinlock);
 }
 
 inline void unlock(KInt* spinlock) {
-  RuntimeCheck(compareAndSwap(spinlock, 1, 0) == 1, "Must succeed");
+  ParkingUnlock(spinlock);
 }
 
 inline bool canFreeze(ContainerHeader* container) {
@@ -792,6 +1178,11 @@ inline bool canFreeze(ContainerHeader* container) {
     return container != nullptr && !container->frozen();
 }
 
+// Arena objects, such as ones in object regions, are released with the arena, so cannot be frozen.
+inline bool blocksFreezing(ObjHeader* obj) {
+  return (obj->has_meta_object() && ((obj->meta_object()->flags_ & MF_NEVER_FROZEN) != 0)) || isArena(obj->container());
+}
+
 inline bool isFreezableAtomic(ObjHeader* obj) {
   return obj->type_info() == theFreezableAtomicReferenceTypeInfo;
 }
@@ -802,29 +1193,164 @@ inline bool isFreezableAtomic(ContainerHeader* container) {
   return isFreezableAtomic(obj);
 }
 
-ContainerHeader* allocContainer(MemoryState* state, size_t size) {
- ContainerHeader* result = nullptr;
 #if USE_GC
-  // We recycle elements of finalizer queue for new allocations, to avoid trashing memory manager.
-  ContainerHeader* container = state != nullptr ? state->finalizerQueue : nullptr;
-  ContainerHeader* previous = nullptr;
-  while (container != nullptr) {
-    // TODO: shall it be == instead?
-    if (container->hasContainerSize() &&
-        container->containerSize() >= size && container->containerSize() <= size + 16) {
-      MEMORY_LOG("recycle %p for request %d\n", container, size)
-      result = container;
-      if (previous == nullptr)
-        state->finalizerQueue = container->nextLink();
-      else
-        previous->setNextLink(container->nextLink());
-      state->finalizerQueueSize--;
-      memset(container, 0, size);
-      break;
+/**
+ * Nursery is a chunk of memory where the memory state places small single-object containers
+ * by bumping a pointer, instead of going to the allocator for each of them. Containers are never
+ * moved out of the nursery, as there's no way to update all references to them, so the chunk is kept
+ * until all containers placed there are released. Most of them die before the next GC, and
+ * once everything placed in the current chunk is dead, it is reset and reused at once.
+ * Containers may leave the worker (transfer, freezing), so releasing them is thread-safe.
+ * As a single survivor keeps the whole retired chunk, the number of such chunks is limited by
+ * kMaxRetiredNurseryChunks, and containers are placed in the heap while the limit is reached.
+ */
+struct NurseryChunk {
+  // Number of containers placed in the chunk, only accessed by the owner.
+  int32_t allocated;
+  // Number of released containers. Once chunk is retired, it is biased by -allocated,
+  // so whoever brings it to zero frees the chunk.
+  int32_t released;
+  // Where the next container will be placed.
+  uint8_t* top;
+
+  uint8_t* start() {
+    return reinterpret_cast<uint8_t*>(this) + alignUp(sizeof(NurseryChunk), kObjectAlignment);
+  }
+
+  uint8_t* end() {
+    return reinterpret_cast<uint8_t*>(this) + kNurseryChunkSize;
+  }
+};
+
+NurseryChunk* allocNurseryChunk() {
+  auto* chunk = konanConstructSizedInstance<NurseryChunk>(kNurseryChunkSize);
+  RuntimeCheck(chunk != nullptr, "Cannot alloc memory");
+  chunk->top = chunk->start();
+  return chunk;
+}
+
+void freeRetiredNurseryChunk(NurseryChunk* chunk) {
+  atomicAdd(&retiredNurseryChunksCount, -1);
+  konanFreeMemory(chunk);
+}
+
+// Called by the owner once no more containers will be placed in the chunk.
+void retireNurseryChunk(NurseryChunk* chunk) {
+  atomicAdd(&retiredNurseryChunksCount, 1);
+  if (atomicAdd(&chunk->released, -chunk->allocated) == 0)
+    freeRetiredNurseryChunk(chunk);
+}
+
+// Could be called on any thread.
+void releaseNurseryContainer(ContainerHeader* container) {
+  auto* chunk = reinterpret_cast<NurseryChunk*>(
+      reinterpret_cast<uint8_t*>(container) - container->nurseryOffset() * kObjectAlignment);
+  if (atomicAdd(&chunk->released, 1) == 0)
+    freeRetiredNurseryChunk(chunk);
+}
+
+// Returns the chunk with space for at least one container of the given (aligned) size, or nullptr
+// if the current chunk is full and too many retired chunks are kept alive already.
+NurseryChunk* nurseryChunkFor(MemoryState* state, size_t size) {
+  auto* chunk = state->nursery;
+  if (chunk->top + size > chunk->end()) {
+    if (atomicGet(&chunk->released) == chunk->allocated) {
+      // Everything placed in the chunk is dead already, so it could be reset.
+      MEMORY_LOG("reset nursery chunk %p\n", chunk)
+      if (gcTelemetry != nullptr) gcTelemetry->values[kGcStatNurseryResets]++;
+      chunk->allocated = 0;
+      chunk->released = 0;
+      chunk->top = chunk->start();
+    } else if (atomicGet(&retiredNurseryChunksCount) >= kMaxRetiredNurseryChunks) {
+      // Keep the full chunk, it will be reset once its containers are dead.
+      return nullptr;
+    } else {
+      retireNurseryChunk(chunk);
+      chunk = allocNurseryChunk();
+      state->nursery = chunk;
+      if (gcTelemetry != nullptr) gcTelemetry->values[kGcStatNurseryChunks]++;
+    }
+  }
+  return chunk;
+}
+
+// Returns nullptr if the nursery cannot take the container.
+ContainerHeader* allocNurseryContainer(MemoryState* state, size_t size) {
+  size = alignUp(size, kObjectAlignment);
+  auto* chunk = nurseryChunkFor(state, size);
+  if (chunk == nullptr) return nullptr;
+  auto* result = reinterpret_cast<ContainerHeader*>(chunk->top);
+  chunk->top += size;
+  chunk->allocated++;
+  memset(result, 0, size);
+  result->setNurseryOffset((reinterpret_cast<uint8_t*>(result) - reinterpret_cast<uint8_t*>(chunk)) / kObjectAlignment);
+  return result;
+}
+
+void releaseContainerMemory(ContainerHeader* container) {
+  if (container->nursery())
+    releaseNurseryContainer(container);
+  else
+    konanFreeMemory(container);
+}
+
+inline size_t recycledSizeClass(size_t size) {
+  return alignUp(size, kObjectAlignment) / kObjectAlignment;
+}
+
+// Keeps released container for reuse, unless it doesn't fit the limits.
+bool recycleContainer(MemoryState* state, ContainerHeader* container) {
+  if (!container->hasContainerSize()) return false;
+  size_t size = container->containerSize();
+  // Zero size means the size is unknown.
+  if (size == 0 || size > kMaxRecycledContainerSize ||
+      state->recycledContainersSize + size > state->recycledContainersSizeLimit)
+    return false;
+  auto sizeClass = recycledSizeClass(size);
+  container->setNextLink(state->recycledContainers[sizeClass]);
+  state->recycledContainers[sizeClass] = container;
+  state->recycledContainersSize += size;
+  return true;
+}
+
+// Takes released container fitting the request, if any. Accepts containers up to 16 bytes bigger.
+ContainerHeader* reuseContainer(MemoryState* state, size_t size) {
+  if (size > kMaxRecycledContainerSize) return nullptr;
+  auto sizeClass = recycledSizeClass(size);
+  auto lastSizeClass = recycledSizeClass(size + 16);
+  if (lastSizeClass >= kRecycledSizeClasses) lastSizeClass = kRecycledSizeClasses - 1;
+  for (; sizeClass <= lastSizeClass; sizeClass++) {
+    auto* container = state->recycledContainers[sizeClass];
+    if (container == nullptr) continue;
+    MEMORY_LOG("recycle %p for request %d\n", container, size)
+    state->recycledContainers[sizeClass] = container->nextLink();
+    state->recycledContainersSize -= container->containerSize();
+    memset(container, 0, size);
+    return container;
+  }
+  return nullptr;
+}
+
+// Frees containers kept for reuse, until their total size fits the limit.
+void trimRecycledContainers(MemoryState* state, size_t limit) {
+  for (size_t sizeClass = kRecycledSizeClasses; sizeClass > 0 && state->recycledContainersSize > limit; sizeClass--) {
+    auto*& list = state->recycledContainers[sizeClass - 1];
+    while (list != nullptr && state->recycledContainersSize > limit) {
+      auto* container = list;
+      list = container->nextLink();
+      state->recycledContainersSize -= container->containerSize();
+      konanFreeMemory(container);
     }
-    previous = container;
-    container = container->nextLink();
   }
+}
+#endif  // USE_GC
+
+ContainerHeader* allocContainer(MemoryState* state, size_t size) {
+ ContainerHeader* result = nullptr;
+#if USE_GC
+  // We reuse released containers for new allocations, to avoid trashing memory manager.
+  if (state != nullptr)
+    result = reuseContainer(state, size);
 #endif
   if (result == nullptr) {
 #if USE_GC
@@ -832,8 +1358,8 @@ ContainerHeader* allocContainer(MemoryState* state, size_t size) {
         state->allocSinceLastGc += size;
 #endif
     result = konanConstructSizedInstance<ContainerHeader>(alignUp(size, kObjectAlignment));
-    atomicAdd(&allocCount, 1);
   }
+  atomicAdd(&allocCount, 1);
   if (state != nullptr) {
     CONTAINER_ALLOC_EVENT(state, size, result);
 #if TRACE_MEMORY
@@ -843,6 +1369,26 @@ ContainerHeader* allocContainer(MemoryState* state, size_t size) {
   return result;
 }
 
+// Allocates container for a single object, small containers are placed in the nursery.
+ContainerHeader* allocObjectContainer(MemoryState* state, size_t size) {
+#if USE_GC
+  ContainerHeader* result = nullptr;
+  if (state != nullptr && state->nursery != nullptr && size <= kNurseryMaxContainerSize)
+    result = allocNurseryContainer(state, size);
+  if (result != nullptr) {
+    state->allocSinceLastGc += size;
+    atomicAdd(&allocCount, 1);
+    CONTAINER_ALLOC_EVENT(state, size, result);
+    if (gcTelemetry != nullptr) gcTelemetry->values[kGcStatNurseryContainers]++;
+#if TRACE_MEMORY
+    state->containers->insert(result);
+#endif
+    return result;
+  }
+#endif  // USE_GC
+  return allocContainer(state, size);
+}
+
 ContainerHeader* allocAggregatingFrozenContainer(KStdVector<ContainerHeader*>& containers) {
   auto componentSize = containers.size();
   auto* superContainer = allocContainer(memoryState, sizeof(ContainerHeader) + sizeof(void*) * componentSize);
@@ -863,7 +1409,6 @@ ContainerHeader* allocAggregatingFrozenContainer(KStdVector<ContainerHeader*>& c
 #if USE_GC
 
 void processFinalizerQueue(MemoryState* state) {
-  // TODO: reuse elements of finalizer queue for new allocations.
   while (state->finalizerQueue != nullptr) {
     auto* container = state->finalizerQueue;
     state->finalizerQueue = container->nextLink();
@@ -872,31 +1417,28 @@ void processFinalizerQueue(MemoryState* state) {
     state->containers->erase(container);
 #endif
     CONTAINER_DESTROY_EVENT(state, container)
-    konanFreeMemory(container);
+    if (!recycleContainer(state, container))
+      releaseContainerMemory(container);
     atomicAdd(&allocCount, -1);
   }
   RuntimeAssert(state->finalizerQueueSize == 0, "Queue must be empty here");
 }
 
-bool hasExternalRefs(ContainerHeader* start, ContainerHeaderSet* visited) {
-  ContainerHeaderDeque toVisit;
-  toVisit.push_back(start);
-  while (!toVisit.empty()) {
-    auto* container = toVisit.front();
-    toVisit.pop_front();
-    visited->insert(container);
-    if (container->refCount() > 0) {
-      MEMORY_LOG("container %p with rc %d blocks transfer\n", container, container->refCount())
-      return true;
-    }
-    traverseContainerReferredObjects(container, [&toVisit, visited](ObjHeader* ref) {
+// Collects containers leaving this worker together with the start one, marking them as seen.
+// Appends containers reachable from start, which are not seen yet, to the subgraph.
+void collectTransferredSubgraph(ContainerHeader* start, ContainerHeaderList* subgraph) {
+  size_t index = subgraph->size();
+  start->setSeen();
+  subgraph->push_back(start);
+  for (; index < subgraph->size(); index++) {
+    traverseContainerReferredObjects((*subgraph)[index], [subgraph](ObjHeader* ref) {
         auto* child = ref->container();
-        if (!isShareable(child) && (visited->count(child) == 0)) {
-           toVisit.push_front(child);
+        if (!isShareable(child) && !isArena(child) && !child->seen()) {
+          child->setSeen();
+          subgraph->push_back(child);
         }
      });
   }
-  return false;
 }
 
 #endif  // USE_GC
@@ -951,6 +1493,9 @@ ALWAYS_INLINE void runDeallocationHooks(ContainerHeader* container) {
     if (type_info == theWorkerBoundReferenceTypeInfo) {
       DisposeWorkerBoundReference(obj);
     }
+    if (type_info == theStringTypeInfo && IsBufferString(obj->array())) {
+      ReleaseStringBuffer(obj->array());
+    }
 #if USE_CYCLIC_GC
     if ((type_info->flags_ & TF_LEAK_DETECTOR_CANDIDATE) != 0) {
       cyclicRemoveAtomicRoot(obj);
@@ -992,14 +1537,27 @@ void freeContainer(ContainerHeader* container) {
   *  - 'seen' bit as GRAY marker (object is being processed)
   *  - not 'marked' and not 'seen' as WHITE marker (object is unprocessed)
   * When we see GREY during DFS, it means we see cycle.
+  * If more than `limit` containers are seen, traversal is abandoned with all the marks reset and false is returned.
   */
-void depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
-                         KRef* firstBlocker, KStdVector<ContainerHeader*>* order) {
+bool depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
+                         KRef* firstBlocker, KStdVector<ContainerHeader*>* order, size_t limit = SIZE_MAX) {
   ContainerHeaderDeque toVisit;
   toVisit.push_back(start);
   start->setSeen();
+  size_t seen = 1;
 
   while (!toVisit.empty()) {
+    if (seen > limit && *firstBlocker == nullptr) {
+      for (auto* container : *order) {
+        container->unMark();
+      }
+      for (auto* container : toVisit) {
+        clearRemoved(container)->resetSeen();
+      }
+      order->clear();
+      *hasCycles = false;
+      return false;
+    }
     auto* container = toVisit.front();
     toVisit.pop_front();
     if (isMarkedAsRemoved(container)) {
@@ -1011,10 +1569,10 @@ void depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
       continue;
     }
     toVisit.push_front(markAsRemoved(container));
-    traverseContainerReferredObjects(container, [container, hasCycles, firstBlocker, &order, &toVisit](ObjHeader* obj) {
+    traverseContainerReferredObjects(container, [container, hasCycles, firstBlocker, &order, &toVisit, &seen](ObjHeader* obj) {
       if (*firstBlocker != nullptr)
         return;
-      if (obj->has_meta_object() && ((obj->meta_object()->flags_ & MF_NEVER_FROZEN) != 0)) {
+      if (blocksFreezing(obj)) {
           *firstBlocker = obj;
           return;
       }
@@ -1027,6 +1585,7 @@ void depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
         if (!objContainer->seen() && !objContainer->marked()) {
           // Mark GRAY.
           objContainer->setSeen();
+          seen++;
           // Here we do rather interesting trick: when doing DFS we postpone processing references going from
           // FreezableAtomic, so that in 'order' referred value will be seen as not actually belonging
           // to the same SCC (unless there are other edges not going through FreezableAtomic reaching the same value).
@@ -1039,6 +1598,7 @@ void depthFirstTraversal(ContainerHeader* start, bool* hasCycles,
       }
     });
   }
+  return true;
 }
 
 void traverseStronglyConnectedComponent(ContainerHeader* start,
@@ -1187,6 +1747,15 @@ inline void increaseGcThreshold(MemoryState* state) {
   auto newThreshold = state->gcThreshold * 3 / 2 + 1;
   if (newThreshold <= kMaxErgonomicThreshold) {
     initGcThreshold(state, newThreshold);
+    if (gcTelemetry != nullptr) gcTelemetry->values[kGcStatThresholdAdjustments]++;
+  }
+}
+
+inline void decreaseGcThreshold(MemoryState* state) {
+  auto newThreshold = state->gcThreshold * 2 / 3;
+  if (newThreshold >= kMinPauseTargetThreshold) {
+    initGcThreshold(state, newThreshold);
+    if (gcTelemetry != nullptr) gcTelemetry->values[kGcStatThresholdAdjustments]++;
   }
 }
 
@@ -1194,9 +1763,19 @@ inline void increaseGcCollectCyclesThreshold(MemoryState* state) {
   auto newThreshold = state->gcCollectCyclesThreshold * 2;
   if (newThreshold <= kMaxErgonomicToFreeSizeThreshold) {
     initGcCollectCyclesThreshold(state, newThreshold);
+    if (gcTelemetry != nullptr) gcTelemetry->values[kGcStatCyclesThresholdAdjustments]++;
   }
 }
 
+// Phase timing only queries the clock when telemetry is enabled.
+inline uint64_t gcPhaseStart() {
+  return gcTelemetry != nullptr ? konan::getTimeMicros() : 0;
+}
+
+inline void gcPhaseEnd(GcPhase phase, uint64_t startTime) {
+  if (gcTelemetry != nullptr) gcTelemetry->onPhase(phase, konan::getTimeMicros() - startTime);
+}
+
 #endif // USE_GC
 
 #if TRACE_MEMORY && USE_GC
@@ -1248,8 +1827,7 @@ void dumpWorker(const char* prefix, ContainerHeader* header, ContainerHeaderSet*
   if (!isAggregatingFrozenContainer(header)) {
     traverseContainerReferredObjects(header, [prefix, seen](ObjHeader* ref) {
       auto* child = ref->container();
-      RuntimeAssert(!isArena(child), "A reference to local object is encountered");
-      if (child != nullptr && (seen->count(child) == 0)) {
+      if (child != nullptr && !isArena(child) && (seen->count(child) == 0)) {
         dumpWorker(prefix, child, seen);
       }
     });
@@ -1265,6 +1843,218 @@ void dumpReachable(const char* prefix, const ContainerHeaderSet* roots) {
 
 #endif
 
+/**
+ * Heap snapshot is a census of containers reachable from roots of the current worker: stack frames,
+ * thread local and global references. Frozen and shared containers are included once reachable.
+ * Globals belong to the main thread, so on other threads only frozen and shared ones are roots.
+ * They are enumerated on request by the generated code, see VisitGlobalRoot().
+ * It is written as a stream of records, so the heap doesn't need to be described in memory first.
+ * All the integers are unsigned LEB128, except bytes.
+ *
+ *   snapshot := "KNHEAP01" record* END
+ *   record   := TYPE typeId nameLength name
+ *             | CONTAINER id typeId shallowSize refCount flags refsCount id*
+ *             | ROOT kind(byte) id
+ *
+ * Ids are assigned to containers in order of discovery, starting from 1, and type of a container
+ * is described before the first container of that type. Aggregating frozen container is a single
+ * container of the type of its first object, its shallow size includes all the objects.
+ * See tools/scripts/heap_snapshot.py for the analyzer.
+ */
+enum HeapSnapshotTag : uint8_t {
+  kHeapSnapshotEnd = 0,
+  kHeapSnapshotType = 1,
+  kHeapSnapshotContainer = 2,
+  kHeapSnapshotRoot = 3,
+};
+
+enum HeapSnapshotRootKind : uint8_t {
+  kHeapSnapshotRootStack = 1,
+  kHeapSnapshotRootThreadLocal = 2,
+  kHeapSnapshotRootGlobal = 3,
+};
+
+enum HeapSnapshotFlags : uint8_t {
+  kHeapSnapshotFrozen = 1,
+  kHeapSnapshotShared = 2,
+  kHeapSnapshotAggregating = 4,
+};
+
+class HeapSnapshotWriter {
+ public:
+  explicit HeapSnapshotWriter(int32_t file) : file_(file) {}
+
+  // Returns false if the snapshot cannot be written completely.
+  bool write(MemoryState* state);
+
+  void globalRoot(ObjHeader* obj) {
+    if (obj == nullptr || reinterpret_cast<uintptr_t>(obj) == 1) return;
+    auto* container = obj->container();
+    if (!ownsGlobals_ && container != nullptr && !isShareable(container)) return;
+    root(kHeapSnapshotRootGlobal, obj);
+  }
+
+ private:
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  void putByte(uint8_t value) {
+    if (size_ == kBufferSize) flush();
+    buffer_[size_++] = value;
+  }
+
+  void putVarint(uint64_t value) {
+    while (value >= 0x80) {
+      putByte(static_cast<uint8_t>(value) | 0x80);
+      value >>= 7;
+    }
+    putByte(static_cast<uint8_t>(value));
+  }
+
+  void putBytes(const char* data, size_t size) {
+    for (size_t index = 0; index < size; index++) putByte(data[index]);
+  }
+
+  void flush() {
+    // Once failed, the snapshot is broken anyway, so the rest is only traversed.
+    if (!failed_ && !konan::fileWrite(file_, buffer_, size_)) failed_ = true;
+    size_ = 0;
+  }
+
+  // Returns id of the container, scheduling it for description if seen for the first time.
+  uint32_t idOf(ContainerHeader* container) {
+    auto it = ids_.find(container);
+    if (it != ids_.end()) return it->second;
+    uint32_t id = ids_.size() + 1;
+    ids_.emplace(container, id);
+    toVisit_.push_back(container);
+    return id;
+  }
+
+  void root(HeapSnapshotRootKind kind, ObjHeader* obj);
+  uint32_t typeIdOf(const TypeInfo* typeInfo);
+  void describe(ContainerHeader* container);
+
+  int32_t file_;
+  bool failed_ = false;
+  bool ownsGlobals_ = false;
+  uint8_t buffer_[kBufferSize];
+  size_t size_ = 0;
+  KStdUnorderedMap<ContainerHeader*, uint32_t> ids_;
+  KStdUnorderedMap<const TypeInfo*, uint32_t> typeIds_;
+  ContainerHeaderList toVisit_;
+  KStdVector<uint64_t> refs_;
+};
+
+// Writer of the snapshot being taken by the current thread, if any.
+THREAD_LOCAL_VARIABLE HeapSnapshotWriter* heapSnapshotWriter = nullptr;
+
+void HeapSnapshotWriter::root(HeapSnapshotRootKind kind, ObjHeader* obj) {
+  if (obj == nullptr || reinterpret_cast<uintptr_t>(obj) == 1) return;
+  auto* container = obj->container();
+  // Permanent objects are never released, so they are not interesting.
+  if (container == nullptr) return;
+  if (isArena(container)) {
+    // Stack allocated object is not a container on its own, what it refers to is a root.
+    traverseReferredObjects(obj, [this, kind](ObjHeader* ref) {
+      root(kind, ref);
+    });
+    return;
+  }
+  putByte(kHeapSnapshotRoot);
+  putByte(kind);
+  putVarint(idOf(container));
+}
+
+uint32_t HeapSnapshotWriter::typeIdOf(const TypeInfo* typeInfo) {
+  auto it = typeIds_.find(typeInfo);
+  if (it != typeIds_.end()) return it->second;
+  uint32_t id = typeIds_.size();
+  typeIds_.emplace(typeInfo, id);
+  KStdString name;
+  if (typeInfo->packageName_ != nullptr) {
+    char* packageName = CreateCStringFromString(typeInfo->packageName_);
+    name += packageName;
+    DisposeCString(packageName);
+  }
+  if (!name.empty()) name += ".";
+  if (typeInfo->relativeName_ != nullptr) {
+    char* relativeName = CreateCStringFromString(typeInfo->relativeName_);
+    name += relativeName;
+    DisposeCString(relativeName);
+  } else {
+    name += "<anonymous>";
+  }
+  putByte(kHeapSnapshotType);
+  putVarint(id);
+  putVarint(name.size());
+  putBytes(name.data(), name.size());
+  return id;
+}
+
+void HeapSnapshotWriter::describe(ContainerHeader* container) {
+  uint32_t id = ids_[container];
+  uint8_t flags = container->frozen() ? kHeapSnapshotFrozen : container->shareable() ? kHeapSnapshotShared : 0;
+  size_t shallowSize = sizeof(ContainerHeader);
+  refs_.clear();
+  auto addRef = [this, container](ObjHeader* ref) {
+    auto* child = ref->container();
+    if (child != nullptr && child != container) refs_.push_back(idOf(child));
+  };
+  ObjHeader* first;
+  if (isAggregatingFrozenContainer(container)) {
+    flags |= kHeapSnapshotAggregating;
+    auto** subContainers = reinterpret_cast<ContainerHeader**>(container + 1);
+    shallowSize += sizeof(ContainerHeader*) * container->objectCount();
+    first = reinterpret_cast<ObjHeader*>(subContainers[0] + 1);
+    for (int index = 0; index < container->objectCount(); index++) {
+      auto* obj = reinterpret_cast<ObjHeader*>(subContainers[index] + 1);
+      shallowSize += sizeof(ContainerHeader) + objectSize(obj);
+      traverseReferredObjects(obj, addRef);
+    }
+  } else {
+    first = reinterpret_cast<ObjHeader*>(container + 1);
+    auto* obj = first;
+    for (int index = 0; index < container->objectCount(); index++) {
+      shallowSize += objectSize(obj);
+      obj = reinterpret_cast<ObjHeader*>(reinterpret_cast<uintptr_t>(obj) + objectSize(obj));
+    }
+    traverseContainerReferredObjects(container, addRef);
+  }
+  auto typeId = typeIdOf(first->type_info());
+  putByte(kHeapSnapshotContainer);
+  putVarint(id);
+  putVarint(typeId);
+  putVarint(shallowSize);
+  putVarint(container->refCount() > 0 ? container->refCount() : 0);
+  putByte(flags);
+  putVarint(refs_.size());
+  for (auto ref : refs_) putVarint(ref);
+}
+
+bool HeapSnapshotWriter::write(MemoryState* state) {
+  putBytes("KNHEAP01", 8);
+  for (auto* frame = currentFrame; frame != nullptr; frame = frame->previous) {
+    ObjHeader** current = reinterpret_cast<ObjHeader**>(frame + 1) + frame->parameters;
+    ObjHeader** end = current + frame->count - kFrameOverlaySlots - frame->parameters;
+    while (current < end) root(kHeapSnapshotRootStack, *current++);
+  }
+  for (auto& record : *state->tlsMap) {
+    for (int index = 0; index < record.second.second; index++)
+      root(kHeapSnapshotRootThreadLocal, record.second.first[index]);
+  }
+  ownsGlobals_ = Kotlin_isMainThread();
+  heapSnapshotWriter = this;
+  Kotlin_visitGlobalRoots();
+  heapSnapshotWriter = nullptr;
+  // Containers are described in order of discovery, which is breadth-first.
+  for (size_t index = 0; index < toVisit_.size(); index++) {
+    describe(toVisit_[index]);
+  }
+  putByte(kHeapSnapshotEnd);
+  flush();
+  return !failed_;
+}
+
 #if USE_GC
 
 void markRoots(MemoryState*);
@@ -1272,8 +2062,10 @@ void scanRoots(MemoryState*);
 void collectRoots(MemoryState*);
 void scan(ContainerHeader* container);
 
+// If `pending` is given, cycle candidates outside of the current slice, i.e. buffered but not marked,
+// met during traversal are added there.
 template <bool useColor>
-void markGray(ContainerHeader* start) {
+void markGray(ContainerHeader* start, ContainerHeaderList* pending = nullptr) {
   ContainerHeaderDeque toVisit;
   toVisit.push_front(start);
 
@@ -1290,6 +2082,8 @@ void markGray(ContainerHeader* start) {
       }
       // Only garbage green object could be recolored here.
       container->setColorEvenIfGreen(CONTAINER_TAG_GC_GRAY);
+      if (pending != nullptr && container->buffered() && !container->marked())
+        pending->push_back(container);
     } else {
       if (container->marked()) continue;
       container->mark();
@@ -1297,8 +2091,8 @@ void markGray(ContainerHeader* start) {
 
     traverseContainerReferredObjects(container, [&toVisit](ObjHeader* ref) {
       auto* childContainer = ref->container();
-      RuntimeAssert(!isArena(childContainer), "A reference to local object is encountered");
-      if (!isShareable(childContainer)) {
+      // Arena objects, such as ones in object regions, are not reference counted and released with the arena.
+      if (!isShareable(childContainer) && !isArena(childContainer)) {
         childContainer->decRefCount<false>();
         toVisit.push_front(childContainer);
       }
@@ -1324,8 +2118,7 @@ void scanBlack(ContainerHeader* start) {
     }
     traverseContainerReferredObjects(container, [&toVisit](ObjHeader* ref) {
         auto childContainer = ref->container();
-        RuntimeAssert(!isArena(childContainer), "A reference to local object is encountered");
-        if (!isShareable(childContainer)) {
+        if (!isShareable(childContainer) && !isArena(childContainer)) {
           childContainer->incRefCount<false>();
           if (useColor) {
             int color = childContainer->color();
@@ -1350,6 +2143,67 @@ void collectCycles(MemoryState* state) {
   state->roots->clear();
 }
 
+/**
+ * Single slice of the incremental cycle collection: trial deletion of the last `cycleSliceRoots`
+ * candidates in toFree, others are left for the next slices. Mutator runs between slices, so the slice
+ * cannot leave any trial deletion state behind. Trial deletion of a subset of candidates is safe, but
+ * candidates outside of the slice, reachable from it, are still buffered and cannot be collected now.
+ * So they are considered alive: restored with scanBlack() before the scan, and made purple again after
+ * the slice, so that they are processed as roots by one of the next slices.
+ */
+void collectCyclesSlice(MemoryState* state) {
+  auto* toFree = state->toFree;
+  auto* roots = state->roots;
+  size_t count = std::min(state->cycleSliceRoots, toFree->size());
+  ContainerHeaderList slice(toFree->end() - count, toFree->end());
+  toFree->resize(toFree->size() - count);
+  // Marked bit tells candidates of this slice from other buffered ones.
+  for (auto* container : slice) {
+    if (!isMarkedAsRemoved(container))
+      container->mark();
+  }
+  ContainerHeaderList pending;
+  for (auto* container : slice) {
+    if (isMarkedAsRemoved(container))
+      continue;
+    RuntimeCheck(container->color() != CONTAINER_TAG_GC_GREEN, "Must not be green");
+    auto color = container->color();
+    auto rcIsZero = container->refCount() == 0;
+    if (color == CONTAINER_TAG_GC_PURPLE && !rcIsZero) {
+      markGray<true>(container, &pending);
+      roots->push_back(container);
+    } else {
+      container->resetBuffered();
+      if (color == CONTAINER_TAG_GC_BLACK && rcIsZero) {
+        container->unMark();
+        scheduleDestroyContainer(state, container);
+      }
+    }
+  }
+  for (auto* container : slice) {
+    if (!isMarkedAsRemoved(container) && container->marked())
+      container->unMark();
+  }
+  for (auto* container : pending) {
+    if (container->color() == CONTAINER_TAG_GC_GRAY)
+      scanBlack<true>(container);
+  }
+  scanRoots(state);
+  collectRoots(state);
+  // Pending candidate referred only from the collected garbage is released now, and destroyed once reached
+  // by one of the next slices, same as candidate dead between collections.
+  state->gcSuspendCount++;
+  for (auto* container : pending) {
+    RuntimeAssert(container->buffered(), "Pending candidate must stay buffered");
+    if (container->refCount() == 0)
+      freeContainer(container);
+    else
+      container->setColorAssertIfGreen(CONTAINER_TAG_GC_PURPLE);
+  }
+  state->gcSuspendCount--;
+  roots->clear();
+}
+
 void markRoots(MemoryState* state) {
   for (auto container : *(state->toFree)) {
     if (isMarkedAsRemoved(container))
@@ -1403,8 +2257,7 @@ void scan(ContainerHeader* start) {
      container->setColorAssertIfGreen(CONTAINER_TAG_GC_WHITE);
      traverseContainerReferredObjects(container, [&toVisit](ObjHeader* ref) {
        auto* childContainer = ref->container();
-       RuntimeAssert(!isArena(childContainer), "A reference to local object is encountered");
-       if (!isShareable(childContainer)) {
+       if (!isShareable(childContainer) && !isArena(childContainer)) {
          toVisit.push_front(childContainer);
        }
      });
@@ -1424,8 +2277,7 @@ void collectWhite(MemoryState* state, ContainerHeader* start) {
         auto* ref = *location;
         if (ref == nullptr) return;
         auto* childContainer = ref->container();
-        RuntimeAssert(!isArena(childContainer), "A reference to local object is encountered");
-        if (isShareable(childContainer)) {
+        if (isShareable(childContainer) || isArena(childContainer)) {
           ZeroHeapRef(location);
         } else {
           toVisit.push_front(childContainer);
@@ -1435,35 +2287,475 @@ void collectWhite(MemoryState* state, ContainerHeader* start) {
      scheduleDestroyContainer(state, container);
   }
 }
-#endif
 
-inline bool needAtomicAccess(ContainerHeader* container) {
-  return container->shareable();
-}
+#if USE_CONCURRENT_CYCLE_GC
 
-inline bool canBeCyclic(ContainerHeader* container) {
-  if (container->refCount() == 1) return false;
-  if (container->color() == CONTAINER_TAG_GC_GREEN) return false;
-  return true;
-}
+/**
+ * Theory of operations.
+ *
+ * Concurrent cycle collection moves trial deletion (markGray/scan/collectWhite, see collectCycles())
+ * off the mutator, following Bacon and Rajan's concurrent cycle collector. At the point where cycles
+ * would be collected, garbageCollect() hands its toFree list over to the collector thread of this
+ * memory state and proceeds. The collector never writes to container headers: reference counters and
+ * colors used by the trial deletion are kept in a shadow table, so racing with the mutator can only make
+ * the result stale, not corrupt the heap.
+ * Traversing the snapshot concurrently is safe, as in the strict memory model local containers are only
+ * released inside garbageCollect(), which rendezvous with the collector before processing decrements.
+ * Operations moving objects out of this worker (transfer, freezing and sharing) cancel the background
+ * collection, so its candidate list returns to the toFree list.
+ * Candidate garbage cycles found by the collector are validated on the next GC, once reference counters
+ * include all stack references again. We compute how many references to each candidate cycle come from
+ * outside of the candidate set (sigma test); cycles having such references are live, and so is everything
+ * they refer to. What remains is garbage, and only releasing it is performed on the mutator.
+ */
+class ConcurrentCycleCollector {
+ public:
+  ConcurrentCycleCollector() {
+    CHECK_CALL(pthread_mutex_init(&lock_, nullptr), "Cannot init cycle collector mutex")
+    CHECK_CALL(pthread_cond_init(&cond_, nullptr), "Cannot init cycle collector condition")
+    CHECK_CALL(pthread_create(&thread_, nullptr, collectorRoutine, this), "Cannot start cycle collector thread")
+  }
+
+  ~ConcurrentCycleCollector() {
+    {
+      CycleCollectorLocker locker(&lock_);
+      terminate_ = true;
+      atomicSet(&abort_, 1);
+      pthread_cond_broadcast(&cond_);
+    }
+    pthread_join(thread_, nullptr);
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&lock_);
+  }
+
+  // Starts trial deletion over the given candidates, `candidates` becomes empty.
+  void start(ContainerHeaderList* candidates) {
+    CycleCollectorLocker locker(&lock_);
+    RuntimeAssert(!running_ && snapshot_.empty(), "Collector must be idle");
+    snapshot_.swap(*candidates);
+    atomicSet(&abort_, 0);
+    running_ = true;
+    pthread_cond_broadcast(&cond_);
+  }
+
+  // Waits for the current collection, if any. If `cancel` is set, collection is interrupted
+  // and its results are discarded. Returns true if there are results to be adopted.
+  bool finish(bool cancel) {
+    CycleCollectorLocker locker(&lock_);
+    if (cancel && running_) atomicSet(&abort_, 1);
+    while (running_) {
+      pthread_cond_wait(&cond_, &lock_);
+    }
+    return !snapshot_.empty() && !aborted_;
+  }
 
-inline void addHeapRef(ContainerHeader* container) {
-  MEMORY_LOG("AddHeapRef %p: rc=%d\n", container, container->refCount())
-  UPDATE_ADDREF_STAT(memoryState, container, needAtomicAccess(container), 0)
-  switch (container->tag()) {
-    case CONTAINER_TAG_STACK:
-      break;
-    case CONTAINER_TAG_LOCAL:
-      incrementRC</* Atomic = */ false>(container);
-      break;
-    /* case CONTAINER_TAG_FROZEN: case CONTAINER_TAG_SHARED: */
-    default:
-      incrementRC</* Atomic = */ true>(container);
-      break;
+  bool idle() {
+    CycleCollectorLocker locker(&lock_);
+    return !running_ && snapshot_.empty();
   }
-}
 
-inline void addHeapRef(const ObjHeader* header) {
+  bool running() {
+    CycleCollectorLocker locker(&lock_);
+    return running_;
+  }
+
+  // Must only be called after finish().
+  ContainerHeaderList* snapshot() { return &snapshot_; }
+  KStdVector<ContainerHeaderList>* cycles() { return &cycles_; }
+
+  void reset() {
+    snapshot_.clear();
+    cycles_.clear();
+    aborted_ = false;
+  }
+
+ private:
+  struct ShadowNode {
+    int refCount;
+    unsigned color;
+  };
+
+  class CycleCollectorLocker {
+   public:
+    explicit CycleCollectorLocker(pthread_mutex_t* lock) : lock_(lock) {
+      pthread_mutex_lock(lock_);
+    }
+    ~CycleCollectorLocker() {
+      pthread_mutex_unlock(lock_);
+    }
+   private:
+    pthread_mutex_t* lock_;
+  };
+
+  static void* collectorRoutine(void* argument) {
+    reinterpret_cast<ConcurrentCycleCollector*>(argument)->loop();
+    return nullptr;
+  }
+
+  void loop() {
+    while (true) {
+      {
+        CycleCollectorLocker locker(&lock_);
+        while (!running_ && !terminate_) {
+          pthread_cond_wait(&cond_, &lock_);
+        }
+        if (terminate_) return;
+      }
+      bool completed = collect();
+      nodes_.clear();
+      roots_.clear();
+      toVisit_.clear();
+      {
+        CycleCollectorLocker locker(&lock_);
+        aborted_ = !completed;
+        if (aborted_) cycles_.clear();
+        running_ = false;
+        pthread_cond_broadcast(&cond_);
+      }
+    }
+  }
+
+  ShadowNode* node(ContainerHeader* container) {
+    auto it = nodes_.find(container);
+    if (it != nodes_.end()) return &it->second;
+    // Acyclic containers keep their color, all others start as not visited.
+    ShadowNode node = { container->refCount(),
+        container->color() == CONTAINER_TAG_GC_GREEN ? CONTAINER_TAG_GC_GREEN : CONTAINER_TAG_GC_BLACK };
+    return &nodes_.emplace(container, node).first->second;
+  }
+
+  bool shallAbort() {
+    return (++visited_ & 0xff) == 0 && atomicGet(&abort_) != 0;
+  }
+
+  // Same as markRoots()/scanRoots()/collectRoots(), but on the shadow table.
+  bool collect() {
+    for (auto* container : snapshot_) {
+      if (isMarkedAsRemoved(container)) continue;
+      if (container->color() == CONTAINER_TAG_GC_PURPLE && container->refCount() != 0) {
+        if (!markGray(container)) return false;
+        roots_.push_back(container);
+      }
+    }
+    for (auto* container : roots_) {
+      if (!scan(container)) return false;
+    }
+    for (auto* container : roots_) {
+      ContainerHeaderList cycle;
+      if (!collectWhite(container, &cycle)) return false;
+      if (!cycle.empty()) cycles_.push_back(std::move(cycle));
+    }
+    return true;
+  }
+
+  bool markGray(ContainerHeader* start) {
+    toVisit_.push_front(start);
+    while (!toVisit_.empty()) {
+      if (shallAbort()) return false;
+      auto* container = toVisit_.front();
+      toVisit_.pop_front();
+      auto* shadow = node(container);
+      if (shadow->color == CONTAINER_TAG_GC_GRAY) continue;
+      if (shadow->color == CONTAINER_TAG_GC_GREEN && shadow->refCount != 0) continue;
+      shadow->color = CONTAINER_TAG_GC_GRAY;
+      traverseContainerReferredObjects(container, [this](ObjHeader* ref) {
+        auto* childContainer = ref->container();
+        if (!isShareable(childContainer) && !isArena(childContainer)) {
+          node(childContainer)->refCount--;
+          toVisit_.push_front(childContainer);
+        }
+      });
+    }
+    return true;
+  }
+
+  bool scanBlack(ContainerHeader* start) {
+    ContainerHeaderDeque toVisit;
+    toVisit.push_front(start);
+    while (!toVisit.empty()) {
+      if (shallAbort()) return false;
+      auto* container = toVisit.front();
+      toVisit.pop_front();
+      auto* shadow = node(container);
+      if (shadow->color == CONTAINER_TAG_GC_GREEN || shadow->color == CONTAINER_TAG_GC_BLACK) continue;
+      shadow->color = CONTAINER_TAG_GC_BLACK;
+      traverseContainerReferredObjects(container, [this, &toVisit](ObjHeader* ref) {
+        auto* childContainer = ref->container();
+        if (!isShareable(childContainer) && !isArena(childContainer)) {
+          auto* childShadow = node(childContainer);
+          childShadow->refCount++;
+          if (childShadow->color != CONTAINER_TAG_GC_BLACK)
+            toVisit.push_front(childContainer);
+        }
+      });
+    }
+    return true;
+  }
+
+  bool scan(ContainerHeader* start) {
+    toVisit_.push_front(start);
+    while (!toVisit_.empty()) {
+      if (shallAbort()) return false;
+      auto* container = toVisit_.front();
+      toVisit_.pop_front();
+      auto* shadow = node(container);
+      if (shadow->color != CONTAINER_TAG_GC_GRAY) continue;
+      if (shadow->refCount > 0) {
+        if (!scanBlack(container)) return false;
+        continue;
+      }
+      shadow->color = CONTAINER_TAG_GC_WHITE;
+      traverseContainerReferredObjects(container, [this](ObjHeader* ref) {
+        auto* childContainer = ref->container();
+        if (!isShareable(childContainer) && !isArena(childContainer))
+          toVisit_.push_front(childContainer);
+      });
+    }
+    return true;
+  }
+
+  bool collectWhite(ContainerHeader* start, ContainerHeaderList* cycle) {
+    toVisit_.push_front(start);
+    while (!toVisit_.empty()) {
+      if (shallAbort()) return false;
+      auto* container = toVisit_.front();
+      toVisit_.pop_front();
+      auto* shadow = node(container);
+      if (shadow->color != CONTAINER_TAG_GC_WHITE) continue;
+      shadow->color = CONTAINER_TAG_GC_BLACK;
+      cycle->push_back(container);
+      traverseContainerReferredObjects(container, [this](ObjHeader* ref) {
+        auto* childContainer = ref->container();
+        if (!isShareable(childContainer) && !isArena(childContainer))
+          toVisit_.push_front(childContainer);
+      });
+    }
+    return true;
+  }
+
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  pthread_t thread_;
+  bool running_ = false;
+  bool terminate_ = false;
+  bool aborted_ = false;
+  int abort_ = 0;
+  unsigned visited_ = 0;
+  // Candidates handed over by the mutator, owned by the collector while it runs.
+  ContainerHeaderList snapshot_;
+  // Results of the collection: candidate garbage cycles.
+  KStdVector<ContainerHeaderList> cycles_;
+  // Collector-private state.
+  KStdUnorderedMap<ContainerHeader*, ShadowNode> nodes_;
+  ContainerHeaderList roots_;
+  ContainerHeaderDeque toVisit_;
+};
+
+// Returns candidates of the interrupted background collection to the toFree list.
+void cancelConcurrentCycleCollection(MemoryState* state) {
+  auto* collector = state->concurrentCycleCollector;
+  if (collector == nullptr || collector->idle()) return;
+  collector->finish(/* cancel = */ true);
+  if (state->toFree != nullptr) {
+    for (auto* container : *collector->snapshot())
+      state->toFree->push_back(container);
+  }
+  collector->reset();
+}
+
+// Called on GC start, before any container could be released. Takes results of the background
+// collection, and keeps its candidate cycles buffered, so that they are not destroyed until validation.
+void adoptConcurrentCycles(MemoryState* state, bool wait) {
+  auto* collector = state->concurrentCycleCollector;
+  if (collector->idle()) return;
+  if (!wait && collector->running() &&
+      state->cancelledConcurrentCycleCollections < kMaxCancelledConcurrentCycleCollections) {
+    state->cancelledConcurrentCycleCollections++;
+    GC_LOG("||| GC: cancelling background cycle collection\n")
+    cancelConcurrentCycleCollection(state);
+    return;
+  }
+  if (!collector->finish(/* cancel = */ false)) {
+    cancelConcurrentCycleCollection(state);
+    return;
+  }
+  state->cancelledConcurrentCycleCollections = 0;
+  KStdUnorderedSet<ContainerHeader*> members;
+  for (auto& cycle : *collector->cycles()) {
+    for (auto* container : cycle) {
+      container->setBuffered();
+      members.insert(container);
+    }
+  }
+  // All other candidates are processed the same way as in markRoots(), and roots found alive are blackened.
+  for (auto* container : *collector->snapshot()) {
+    if (isMarkedAsRemoved(container) || members.count(container) != 0) continue;
+    auto color = container->color();
+    auto rcIsZero = container->refCount() == 0;
+    container->resetBuffered();
+    if (color == CONTAINER_TAG_GC_PURPLE && !rcIsZero) {
+      container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
+    } else if (color == CONTAINER_TAG_GC_BLACK && rcIsZero) {
+      scheduleDestroyContainer(state, container);
+    }
+  }
+  state->pendingCycles->swap(*collector->cycles());
+  collector->reset();
+}
+
+/**
+ * Validates candidate cycles adopted on GC start against the current reference counters, and releases
+ * the garbage ones. Must be called at the point where reference counters include stack references.
+ */
+void collectConcurrentCycles(MemoryState* state) {
+  auto* cycles = state->pendingCycles;
+  if (cycles->empty()) return;
+  KStdUnorderedMap<ContainerHeader*, size_t> cycleOf;
+  KStdVector<int> externalRefs(cycles->size(), 0);
+  KStdVector<bool> alive(cycles->size(), false);
+  for (size_t index = 0; index < cycles->size(); index++) {
+    auto& cycle = (*cycles)[index];
+    size_t kept = 0;
+    for (auto* container : cycle) {
+      if (container->refCount() == 0) {
+        // Already released during decrements processing, only memory is kept.
+        container->resetBuffered();
+        scheduleDestroyContainer(state, container);
+        continue;
+      }
+      if (!container->local()) alive[index] = true;
+      externalRefs[index] += container->refCount();
+      cycleOf[container] = index;
+      cycle[kept++] = container;
+    }
+    cycle.resize(kept);
+  }
+  // Subtract references coming from the candidate set itself.
+  for (auto& cycle : *cycles) {
+    for (auto* container : cycle) {
+      traverseContainerReferredObjects(container, [&cycleOf, &externalRefs](ObjHeader* ref) {
+        auto it = cycleOf.find(ref->container());
+        if (it != cycleOf.end()) externalRefs[it->second]--;
+      });
+    }
+  }
+  // Cycles referred from outside are alive, as is everything they refer to.
+  KStdVector<size_t> toVisit;
+  for (size_t index = 0; index < cycles->size(); index++) {
+    if (externalRefs[index] > 0 || alive[index]) {
+      alive[index] = true;
+      toVisit.push_back(index);
+    }
+  }
+  while (!toVisit.empty()) {
+    size_t index = toVisit.back();
+    toVisit.pop_back();
+    for (auto* container : (*cycles)[index]) {
+      traverseContainerReferredObjects(container, [&cycleOf, &alive, &toVisit](ObjHeader* ref) {
+        auto it = cycleOf.find(ref->container());
+        if (it != cycleOf.end() && !alive[it->second]) {
+          alive[it->second] = true;
+          toVisit.push_back(it->second);
+        }
+      });
+    }
+  }
+  // Release garbage cycles, same as collectWhite(), but reference counters of the alive local
+  // containers still account references from the garbage.
+  state->gcSuspendCount++;
+  for (size_t index = 0; index < cycles->size(); index++) {
+    auto& cycle = (*cycles)[index];
+    if (alive[index]) {
+      // Let the next collection reconsider them.
+      for (auto* container : cycle) {
+        if (container->color() == CONTAINER_TAG_GC_GREEN) {
+          container->resetBuffered();
+          continue;
+        }
+        container->setColorAssertIfGreen(CONTAINER_TAG_GC_PURPLE);
+        state->toFree->push_back(container);
+      }
+      continue;
+    }
+    GC_LOG("||| GC: releasing concurrently found cycle of %d containers\n", cycle.size())
+    for (auto* container : cycle) {
+      traverseContainerObjectFields(container, [&cycleOf](ObjHeader** location) {
+        auto* ref = *location;
+        if (ref == nullptr) return;
+        auto* childContainer = ref->container();
+        if (isShareable(childContainer) || isArena(childContainer)) {
+          ZeroHeapRef(location);
+        } else if (cycleOf.count(childContainer) == 0) {
+          enqueueDecrementRC</* CanCollect = */ false>(childContainer);
+        }
+      });
+    }
+    for (auto* container : cycle) {
+      container->resetBuffered();
+      container->setColorEvenIfGreen(CONTAINER_TAG_GC_BLACK);
+      runDeallocationHooks(container);
+      scheduleDestroyContainer(state, container);
+    }
+  }
+  state->gcSuspendCount--;
+  cycles->clear();
+}
+
+void setConcurrentCycleCollection(MemoryState* state, bool enabled) {
+  if (enabled == (state->concurrentCycleCollector != nullptr)) return;
+  if (enabled) {
+    state->pendingCycles = konanConstructInstance<KStdVector<ContainerHeaderList>>();
+    state->cancelledConcurrentCycleCollections = 0;
+    state->concurrentCycleCollector = konanConstructInstance<ConcurrentCycleCollector>();
+  } else {
+    cancelConcurrentCycleCollection(state);
+    RuntimeAssert(state->pendingCycles->empty(), "Cycles must be validated by GC");
+    konanDestructInstance(state->concurrentCycleCollector);
+    konanDestructInstance(state->pendingCycles);
+    state->concurrentCycleCollector = nullptr;
+    state->pendingCycles = nullptr;
+  }
+}
+
+#endif  // USE_CONCURRENT_CYCLE_GC
+
+inline void cancelBackgroundGC(MemoryState* state) {
+#if USE_CONCURRENT_CYCLE_GC
+  cancelConcurrentCycleCollection(state);
+#endif  // USE_CONCURRENT_CYCLE_GC
+}
+
+#endif  // USE_GC
+
+inline bool needAtomicAccess(ContainerHeader* container) {
+  return container->shareable();
+}
+
+inline bool canBeCyclic(ContainerHeader* container) {
+  if (container->refCount() == 1) return false;
+  if (container->color() == CONTAINER_TAG_GC_GREEN) return false;
+  return true;
+}
+
+inline void addHeapRef(ContainerHeader* container) {
+  MEMORY_LOG("AddHeapRef %p: rc=%d\n", container, container->refCount())
+  UPDATE_ADDREF_STAT(memoryState, container, needAtomicAccess(container), 0)
+  if (gcTelemetry != nullptr && container->tag() != CONTAINER_TAG_STACK)
+    gcTelemetry->onAddRef(container->tag() != CONTAINER_TAG_LOCAL);
+  switch (container->tag()) {
+    case CONTAINER_TAG_STACK:
+      break;
+    case CONTAINER_TAG_LOCAL:
+      incrementRC</* Atomic = */ false>(container);
+      break;
+    /* case CONTAINER_TAG_FROZEN: case CONTAINER_TAG_SHARED: */
+    default:
+      incrementRC</* Atomic = */ true>(container);
+      break;
+  }
+}
+
+inline void addHeapRef(const ObjHeader* header) {
   auto* container = header->container();
   if (container != nullptr)
     addHeapRef(const_cast<ContainerHeader*>(container));
@@ -1484,6 +2776,8 @@ inline bool tryAddHeapRef(ContainerHeader* container) {
 
   MEMORY_LOG("AddHeapRef %p: rc=%d\n", container, container->refCount() - 1)
   UPDATE_ADDREF_STAT(memoryState, container, needAtomicAccess(container), 0)
+  if (gcTelemetry != nullptr && container->tag() != CONTAINER_TAG_STACK)
+    gcTelemetry->onAddRef(container->tag() != CONTAINER_TAG_LOCAL);
   return true;
 }
 
@@ -1497,6 +2791,8 @@ inline void releaseHeapRef(ContainerHeader* container) {
   MEMORY_LOG("ReleaseHeapRef %p: rc=%d\n", container, container->refCount())
   UPDATE_RELEASEREF_STAT(memoryState, container, needAtomicAccess(container), canBeCyclic(container), 0)
   if (container->tag() != CONTAINER_TAG_STACK) {
+    if (gcTelemetry != nullptr)
+      gcTelemetry->onReleaseRef(container->tag() != CONTAINER_TAG_LOCAL);
     if (Strict)
       enqueueDecrementRC</* CanCollect = */ true>(container);
     else
@@ -1511,6 +2807,95 @@ inline void releaseHeapRef(const ObjHeader* header) {
     releaseHeapRef<Strict>(const_cast<ContainerHeader*>(container));
 }
 
+#if COALESCE_HEAP_WRITES
+/**
+ * Coalescing of heap writes, after Levanoni and Petrank. Instead of updating reference counters on every
+ * write, the first write to a slot remembers the value reference counters are accounted for, and further
+ * writes only store the new value. Once the entry is flushed, only the difference between the accounted value
+ * and the current one is applied. So a field overwritten in a loop costs two reference counter updates
+ * per GC epoch instead of two per write.
+ * Slot values not accounted yet are safe, as in the strict memory model local containers are only released
+ * by the GC, and it flushes the log first. Shareable values can be released by other workers at any time,
+ * so they are always accounted immediately. Operations relying on exact reference counters outside of GC
+ * (transfer, freezing), and anyone releasing slot memory without ZeroHeapRef() shall flush the log as well.
+ * Slots of shared objects could be released by other workers before the flush, and the slot owner is not
+ * known here, so once any object with reference slots is shared, writes are never coalesced.
+ */
+inline HeapWriteLogEntry* heapWriteLogEntry(MemoryState* state, ObjHeader** location) {
+  return &state->heapWriteLog[(reinterpret_cast<uintptr_t>(location) / sizeof(ObjHeader*)) & (kHeapWriteLogSize - 1)];
+}
+
+void flushHeapWriteLogEntry(MemoryState* state, HeapWriteLogEntry* entry) {
+  const ObjHeader* current = *entry->location;
+  const ObjHeader* accounted = entry->accounted;
+  entry->location = nullptr;
+  state->heapWriteLogCount--;
+  if (current == accounted) return;
+  if (reinterpret_cast<uintptr_t>(current) > 1)
+    addHeapRef(current);
+  if (reinterpret_cast<uintptr_t>(accounted) > 1) {
+    auto* container = accounted->container();
+    // Cannot collect here, as GC flushes the log.
+    if (container != nullptr && container->tag() != CONTAINER_TAG_STACK)
+      enqueueDecrementRC</* CanCollect = */ false>(container);
+  }
+}
+
+void flushHeapWriteLog(MemoryState* state) {
+  if (state->heapWriteLogCount == 0) return;
+  for (auto& entry : state->heapWriteLog) {
+    if (entry.location != nullptr)
+      flushHeapWriteLogEntry(state, &entry);
+  }
+  RuntimeAssert(state->heapWriteLogCount == 0, "Heap write log must be empty");
+}
+
+// Shall be called before the slot is written bypassing logHeapWrite().
+inline void flushHeapWriteLog(ObjHeader** location) {
+  auto* state = memoryState;
+  if (state == nullptr || state->heapWriteLogCount == 0) return;
+  auto* entry = heapWriteLogEntry(state, location);
+  if (entry->location == location)
+    flushHeapWriteLogEntry(state, entry);
+}
+
+// Stores the value to the slot without updating reference counters, if possible.
+inline bool logHeapWrite(ObjHeader** location, ObjHeader* old, const ObjHeader* object) {
+  if (atomicGet(&hasSharedReferenceSlots) != 0) return false;
+  auto* state = memoryState;
+  // Threads without memory state, including the one being deinitialized, account writes immediately.
+  if (state == nullptr) return false;
+  if (object != nullptr) {
+    auto* container = object->container();
+    if (container != nullptr && container->shareable()) return false;
+  }
+  if (state->gcInProgress) return false;
+  auto* entry = heapWriteLogEntry(state, location);
+  if (entry->location != location) {
+    if (entry->location != nullptr)
+      flushHeapWriteLogEntry(state, entry);
+    entry->location = location;
+    entry->accounted = old;
+    state->heapWriteLogCount++;
+  }
+  *const_cast<const ObjHeader**>(location) = object;
+  UPDATE_COALESCED_STAT(state)
+  return true;
+}
+#endif  // COALESCE_HEAP_WRITES
+
+inline void flushHeapWrites(MemoryState* state) {
+#if COALESCE_HEAP_WRITES
+  flushHeapWriteLog(state);
+#endif  // COALESCE_HEAP_WRITES
+}
+
+inline void flushHeapWrites(ObjHeader** location) {
+#if COALESCE_HEAP_WRITES
+  flushHeapWriteLog(location);
+#endif  // COALESCE_HEAP_WRITES
+}
+
 // We use first slot as place to store frame-local arena container.
 // TODO: create ArenaContainer object on the stack, so that we don't
 // do two allocations per frame (ArenaContainer + actual container).
@@ -1547,7 +2932,8 @@ void incrementStack(MemoryState* state) {
       ObjHeader* obj = *current++;
       if (obj != nullptr) {
         auto* container = obj->container();
-        if (container == nullptr) continue;
+        // Arena chunks are not released by reference counting, and may be freed before the next collection.
+        if (container == nullptr || container->stack()) continue;
         if (container->shareable()) {
           incrementRC<true>(container);
         } else {
@@ -1592,7 +2978,7 @@ void decrementStack(MemoryState* state) {
       if (obj != nullptr) {
         MEMORY_LOG("decrement stack %p\n", obj)
         auto* container = obj->container();
-        if (container != nullptr)
+        if (container != nullptr && !container->stack())
           enqueueDecrementRC</* CanCollect = */ false>(container);
       }
     }
@@ -1606,6 +2992,9 @@ void garbageCollect(MemoryState* state, bool force) {
 
   uint64_t allocSinceLastGc = state->allocSinceLastGc;
   state->allocSinceLastGc = 0;
+  // Collection reorganizes toFree and toRelease.
+  state->toFreeIndex->reset();
+  state->toReleaseIndex->reset();
 
   if (!IsStrictMemoryModel) {
     // In relaxed model we just process finalizer queue and be done with it.
@@ -1621,65 +3010,98 @@ void garbageCollect(MemoryState* state, bool force) {
 
   state->gcInProgress = true;
   state->gcEpoque++;
+  if (gcTelemetry != nullptr) gcTelemetry->onGcStart();
 
   incrementStack(state);
+  // Reference counters must be exact before anything could be released.
+  flushHeapWrites(state);
+#if USE_CONCURRENT_CYCLE_GC
+  // Must happen before any container is released, as background collector may traverse them.
+  if (state->concurrentCycleCollector != nullptr)
+    adoptConcurrentCycles(state, force);
+#endif  // USE_CONCURRENT_CYCLE_GC
 #if USE_CYCLIC_GC
   // Block if the concurrent cycle collector is running.
   // We must do that to ensure collector sees state where actual RC properly upper estimated.
   if (g_hasCyclicCollector)
     cyclicLocalGC();
 #endif  // USE_CYCLIC_GC
-#if PROFILE_GC
-  auto processDecrementsStartTime = konan::getTimeMicros();
-#endif
+  auto phaseStartTime = gcPhaseStart();
   processDecrements(state);
-#if PROFILE_GC
-  auto processDecrementsDuration = konan::getTimeMicros() - processDecrementsStartTime;
-  GC_LOG("||| GC: processDecrementsDuration = %lld\n", processDecrementsDuration);
-  auto decrementStackStartTime = konan::getTimeMicros();
-#endif
+  gcPhaseEnd(kGcPhaseProcessDecrements, phaseStartTime);
+  phaseStartTime = gcPhaseStart();
   size_t beforeDecrements = state->toRelease->size();
   decrementStack(state);
   size_t afterDecrements = state->toRelease->size();
-#if PROFILE_GC
-  auto decrementStackDuration = konan::getTimeMicros() - decrementStackStartTime;
-  GC_LOG("||| GC: decrementStackDuration = %lld\n", decrementStackDuration);
-#endif
+  gcPhaseEnd(kGcPhaseDecrementStack, phaseStartTime);
   long stackReferences = afterDecrements - beforeDecrements;
-  if (state->gcErgonomics && stackReferences * 5 > state->gcThreshold) {
+  if (state->gcErgonomics && state->gcPauseTarget == 0 && stackReferences * 5 > state->gcThreshold) {
     increaseGcThreshold(state);
     GC_LOG("||| GC: too many stack references, increased threshold to %d\n", state->gcThreshold);
   }
 
   GC_LOG("||| GC: toFree %d toRelease %d\n", state->toFree->size(), state->toRelease->size())
-#if PROFILE_GC
-  auto processFinalizerQueueStartTime = konan::getTimeMicros();
-#endif
+  phaseStartTime = gcPhaseStart();
   processFinalizerQueue(state);
-#if PROFILE_GC
-  auto processFinalizerQueueDuration = konan::getTimeMicros() - processFinalizerQueueStartTime;
-  GC_LOG("||| GC: processFinalizerQueueDuration %lld\n", processFinalizerQueueDuration);
-#endif
+  gcPhaseEnd(kGcPhaseFinalizerQueue, phaseStartTime);
+
+#if USE_CONCURRENT_CYCLE_GC
+  if (state->concurrentCycleCollector != nullptr) {
+    collectConcurrentCycles(state);
+    processFinalizerQueue(state);
+    // Forced GC collects cycles synchronously below.
+    if (!force && state->toFree->size() > state->gcCollectCyclesThreshold) {
+      GC_LOG("||| GC: starting background cycle collection of %d candidates\n", state->toFree->size())
+      state->concurrentCycleCollector->start(state->toFree);
+    }
+  }
+#endif  // USE_CONCURRENT_CYCLE_GC
 
-  if (force || state->toFree->size() > state->gcCollectCyclesThreshold) {
+  bool collectCyclesNow = force || state->toFree->size() > state->gcCollectCyclesThreshold;
+  if (state->gcPauseTarget != 0 && !force && (collectCyclesNow || state->cycleCollectionInProgress)) {
+    // Spend what is left of the pause target on cycle collection slices, but at least a quarter of it,
+    // so that cycle collection always progresses.
+    auto elapsed = konan::getTimeMicros() - gcStartTime;
+    auto budget = std::max(state->gcPauseTarget > elapsed ? state->gcPauseTarget - elapsed : 0,
+                           state->gcPauseTarget / 4);
+    auto cyclicGcStartTime = konan::getTimeMicros();
+    auto sliceEndTime = cyclicGcStartTime;
+    while (state->toFree->size() > 0 && sliceEndTime - cyclicGcStartTime < budget) {
+      auto sliceStartTime = sliceEndTime;
+      collectCyclesSlice(state);
+      processFinalizerQueue(state);
+      sliceEndTime = konan::getTimeMicros();
+      auto sliceDuration = sliceEndTime - sliceStartTime;
+      // Adapt slice size, so that a few slices fit into the budget.
+      if (sliceDuration > budget / 2) {
+        state->cycleSliceRoots = std::max(state->cycleSliceRoots / 2, static_cast<size_t>(1));
+      } else if (sliceDuration < budget / 8) {
+        state->cycleSliceRoots = std::min(state->cycleSliceRoots * 3 / 2 + 1, kMaxCycleSliceRoots);
+      }
+    }
+    state->cycleCollectionInProgress = state->toFree->size() > 0;
+    if (gcTelemetry != nullptr) {
+      gcTelemetry->values[kGcStatPhaseTime + kGcPhaseCollectCycles] += sliceEndTime - cyclicGcStartTime;
+      if (!state->cycleCollectionInProgress) gcTelemetry->values[kGcStatCycleCollections]++;
+    }
+    GC_LOG("||| GC: cycle collection slices took %lld, %d candidates left, slice is %d\n",
+           sliceEndTime - cyclicGcStartTime, state->toFree->size(), state->cycleSliceRoots)
+    if (!state->cycleCollectionInProgress) state->lastCyclicGcTimestamp = sliceEndTime;
+  } else if (collectCyclesNow) {
+    state->cycleCollectionInProgress = false;
     auto cyclicGcStartTime = konan::getTimeMicros();
     while (state->toFree->size() > 0) {
+      phaseStartTime = gcPhaseStart();
       collectCycles(state);
-      #if PROFILE_GC
-        processFinalizerQueueStartTime = konan::getTimeMicros();
-      #endif
+      gcPhaseEnd(kGcPhaseCollectCycles, phaseStartTime);
+      phaseStartTime = gcPhaseStart();
       processFinalizerQueue(state);
-      #if PROFILE_GC
-        processFinalizerQueueDuration += konan::getTimeMicros() - processFinalizerQueueStartTime;
-        GC_LOG("||| GC: processFinalizerQueueDuration = %lld\n", processFinalizerQueueDuration);
-      #endif
+      gcPhaseEnd(kGcPhaseFinalizerQueue, phaseStartTime);
     }
     auto cyclicGcEndTime = konan::getTimeMicros();
-    #if PROFILE_GC
-      GC_LOG("||| GC: collectCyclesDuration = %lld\n", cyclicGcEndTime - cyclicGcStartTime);
-    #endif
     auto cyclicGcDuration = cyclicGcEndTime - cyclicGcStartTime;
-    if (state->gcErgonomics && cyclicGcDuration > kGcCollectCyclesMinimumDuration &&
+    if (gcTelemetry != nullptr) gcTelemetry->values[kGcStatCycleCollections]++;
+    if (state->gcErgonomics && state->gcPauseTarget == 0 && cyclicGcDuration > kGcCollectCyclesMinimumDuration &&
         double(cyclicGcDuration) / (cyclicGcStartTime - state->lastCyclicGcTimestamp + 1) > kGcCollectCyclesLoadRatio) {
       increaseGcCollectCyclesThreshold(state);
       GC_LOG("Adjusting GC collecting cycles threshold to %lld\n", state->gcCollectCyclesThreshold);
@@ -1690,13 +3112,29 @@ void garbageCollect(MemoryState* state, bool force) {
   state->gcInProgress = false;
   auto gcEndTime = konan::getTimeMicros();
 
-  if (state->gcErgonomics) {
+  if (state->gcPauseTarget != 0) {
+    // Pause target ergonomics: GC threshold follows the pause, in both directions.
+    auto pause = gcEndTime - gcStartTime;
+    if (pause > state->gcPauseTarget) {
+      decreaseGcThreshold(state);
+      GC_LOG("Pause %lld exceeds target, decreased GC threshold to %d\n", pause, state->gcThreshold);
+    } else if (pause < state->gcPauseTarget / 4) {
+      increaseGcThreshold(state);
+      GC_LOG("Pause %lld is well below target, increased GC threshold to %d\n", pause, state->gcThreshold);
+    }
+  } else if (state->gcErgonomics) {
     auto gcToComputeRatio = double(gcEndTime - gcStartTime) / (gcStartTime - state->lastGcTimestamp + 1);
     if (gcToComputeRatio > kGcToComputeRatioThreshold) {
       increaseGcThreshold(state);
       GC_LOG("Adjusting GC threshold to %d\n", state->gcThreshold);
     }
   }
+  state->gcPauses[state->gcPauseCount % kGcPauseHistorySize] = static_cast<uint32_t>(gcEndTime - gcStartTime);
+  state->gcPauseCount++;
+  if (gcTelemetry != nullptr) {
+    gcTelemetry->onGcEnd(force, gcEndTime - gcStartTime, state->toFree->size(), state->toRelease->size(),
+                         state->gcThreshold, state->gcCollectCyclesThreshold);
+  }
   GC_LOG("GC: gcToComputeRatio=%f duration=%lld sinceLast=%lld\n", double(gcEndTime - gcStartTime) / (gcStartTime - state->lastGcTimestamp + 1), (gcEndTime - gcStartTime), gcStartTime - state->lastGcTimestamp);
   state->lastGcTimestamp = gcEndTime;
 
@@ -1796,10 +3234,17 @@ MemoryState* initMemory() {
   memoryState->gcInProgress = false;
   memoryState->gcSuspendCount = 0;
   memoryState->toRelease = konanConstructInstance<ContainerHeaderList>();
+  memoryState->toFreeIndex = konanConstructInstance<ContainerPositionIndex>();
+  memoryState->toReleaseIndex = konanConstructInstance<ContainerPositionIndex>();
   initGcThreshold(memoryState, kGcThreshold);
   initGcCollectCyclesThreshold(memoryState, kMaxToFreeSizeThreshold);
   memoryState->allocSinceLastGcThreshold = kMaxGcAllocThreshold;
   memoryState->gcErgonomics = true;
+  memoryState->gcPauseTarget = 0;
+  memoryState->cycleSliceRoots = kCycleSliceRoots;
+  memoryState->cycleCollectionInProgress = false;
+  memoryState->nursery = allocNurseryChunk();
+  memoryState->recycledContainersSizeLimit = kRecycledContainersSizeLimit;
 #endif
   memoryState->tlsMap = konanConstructInstance<KThreadLocalStorageMap>();
   memoryState->foreignRefManager = ForeignRefManager::create();
@@ -1835,17 +3280,28 @@ void deinitMemory(MemoryState* memoryState) {
     GC_LOG("Calling garbageCollect from DeinitMemory()\n")
     garbageCollect(memoryState, true);
   } while (memoryState->toRelease->size() > 0 || !memoryState->foreignRefManager->tryReleaseRefOwned());
+#if USE_CONCURRENT_CYCLE_GC
+  setConcurrentCycleCollection(memoryState, false);
+#endif  // USE_CONCURRENT_CYCLE_GC
   RuntimeAssert(memoryState->toFree->size() == 0, "Some memory have not been released after GC");
   RuntimeAssert(memoryState->toRelease->size() == 0, "Some memory have not been released after GC");
   konanDestructInstance(memoryState->toFree);
   konanDestructInstance(memoryState->roots);
   konanDestructInstance(memoryState->toRelease);
+  konanDestructInstance(memoryState->toFreeIndex);
+  konanDestructInstance(memoryState->toReleaseIndex);
   RuntimeAssert(memoryState->tlsMap->size() == 0, "Must be already cleared");
   konanDestructInstance(memoryState->tlsMap);
   RuntimeAssert(memoryState->finalizerQueue == nullptr, "Finalizer queue must be empty");
   RuntimeAssert(memoryState->finalizerQueueSize == 0, "Finalizer queue must be empty");
+  trimRecycledContainers(memoryState, 0);
+  // Chunk is freed once containers left by this worker are released.
+  retireNurseryChunk(memoryState->nursery);
+  memoryState->nursery = nullptr;
 #endif // USE_GC
 
+  setGCStatistics(false);
+
   atomicAdd(&pendingDeinit, -1);
 
 #if TRACE_MEMORY
@@ -1899,6 +3355,8 @@ template<bool Strict>
 void setHeapRef(ObjHeader** location, const ObjHeader* object) {
   MEMORY_LOG("SetHeapRef *%p: %p\n", location, object)
   UPDATE_REF_EVENT(memoryState, nullptr, object, location, 0);
+  flushHeapWrites(location);
+  trackRegionRef(location, nullptr, object);
   if (object != nullptr)
     addHeapRef(const_cast<ObjHeader*>(object));
   *const_cast<const ObjHeader**>(location) = object;
@@ -1906,9 +3364,11 @@ void setHeapRef(ObjHeader** location, const ObjHeader* object) {
 
 void zeroHeapRef(ObjHeader** location) {
   MEMORY_LOG("ZeroHeapRef %p\n", location)
+  flushHeapWrites(location);
   auto* value = *location;
   if (reinterpret_cast<uintptr_t>(value) > 1) {
     UPDATE_REF_EVENT(memoryState, value, nullptr, location, 0);
+    trackRegionRef(location, value, nullptr);
     *location = nullptr;
     ReleaseHeapRef(value);
   }
@@ -1931,6 +3391,13 @@ void updateHeapRef(ObjHeader** location, const ObjHeader* object) {
   UPDATE_REF_EVENT(memoryState, *location, object, location, 0);
   ObjHeader* old = *location;
   if (old != object) {
+    trackRegionRef(location, old, object);
+#if COALESCE_HEAP_WRITES
+    if (Strict) {
+      if (logHeapWrite(location, old, object)) return;
+      flushHeapWriteLog(location);
+    }
+#endif  // COALESCE_HEAP_WRITES
     if (object != nullptr) {
       addHeapRef(object);
     }
@@ -1968,6 +3435,7 @@ void updateReturnRef(ObjHeader** returnSlot, const ObjHeader* value) {
 
 void updateHeapRefIfNull(ObjHeader** location, const ObjHeader* object) {
   if (object != nullptr) {
+    flushHeapWrites(location);
 #if KONAN_NO_THREADS
     ObjHeader* old = *location;
     if (old == nullptr) {
@@ -1982,6 +3450,7 @@ void updateHeapRefIfNull(ObjHeader** location, const ObjHeader* object) {
      ReleaseHeapRef(const_cast<ObjHeader*>(object));
     }
 #endif
+    if (old == nullptr) trackRegionRef(location, nullptr, object);
     UPDATE_REF_EVENT(memoryState, old, object, location, 0);
   }
 }
@@ -2000,18 +3469,24 @@ template <bool Strict>
 OBJ_GETTER(allocInstance, const TypeInfo* type_info) {
   RuntimeAssert(type_info->instanceSize_ >= 0, "must be an object");
   auto* state = memoryState;
+  ObjHeader* obj;
+  if (auto* region = allocationRegion(state)) {
+    // Region objects are not reference counted, so there is nothing to remember.
+    obj = region->arena.PlaceObject(type_info);
+  } else {
 #if USE_GC
-  checkIfGcNeeded(state);
+    checkIfGcNeeded(state);
 #endif  // USE_GC
-  auto container = ObjectContainer(state, type_info);
-  ObjHeader* obj = container.GetPlace();
+    auto container = ObjectContainer(state, type_info);
+    obj = container.GetPlace();
 #if USE_GC
-  if (Strict) {
-    rememberNewContainer(container.header());
-  } else {
-    makeShareable(container.header());
-  }
+    if (Strict) {
+      rememberNewContainer(container.header());
+    } else {
+      makeShareable(container.header());
+    }
 #endif  // USE_GC
+  }
 #if USE_CYCLIC_GC
   if ((obj->type_info()->flags_ & TF_LEAK_DETECTOR_CANDIDATE) != 0) {
     // Note: this should be performed after [rememberNewContainer] (above).
@@ -2028,6 +3503,9 @@ OBJ_GETTER(allocArrayInstance, const TypeInfo* type_info, int32_t elements) {
   RuntimeAssert(type_info->instanceSize_ < 0, "must be an array");
   if (elements < 0) ThrowIllegalArgumentException();
   auto* state = memoryState;
+  if (auto* region = allocationRegion(state)) {
+    RETURN_OBJ(region->arena.PlaceArray(type_info, elements)->obj());
+  }
 #if USE_GC
   checkIfGcNeeded(state);
 #endif  // USE_GC
@@ -2050,6 +3528,7 @@ OBJ_GETTER(initInstance,
     // OK'ish, inited by someone else.
     RETURN_OBJ(value);
   }
+  ObjectRegionSuspender suspender(memoryState);
   ObjHeader* object = allocInstance<Strict>(typeInfo, OBJ_RESULT);
   updateHeapRef<Strict>(location, object);
 #if KONAN_NO_EXCEPTIONS
@@ -2076,6 +3555,7 @@ OBJ_GETTER(initSharedInstance,
     // OK'ish, inited by someone else.
     RETURN_OBJ(value);
   }
+  ObjectRegionSuspender suspender(memoryState);
   ObjHeader* object = AllocInstance(typeInfo, OBJ_RESULT);
   UpdateHeapRef(location, object);
 #if KONAN_NO_EXCEPTIONS
@@ -2111,6 +3591,7 @@ OBJ_GETTER(initSharedInstance,
     // OK'ish, inited by someone else.
     RETURN_OBJ(value);
   }
+  ObjectRegionSuspender suspender(memoryState);
   ObjHeader* object = AllocInstance(typeInfo, OBJ_RESULT);
   memoryState->initializingSingletons.push_back(std::make_pair(location, object));
 #if KONAN_NO_EXCEPTIONS
@@ -2141,42 +3622,62 @@ OBJ_GETTER(initSharedInstance,
 #endif  // KONAN_NO_THREADS
 }
 
+#if USE_GC
 /**
- * We keep thread affinity and reference value based cookie in the atomic references, so that
- * repeating read operation of the same value do not lead to the repeating rememberNewContainer() operation.
- * We must invalidate cookie after the local GC, as otherwise fact that container of the `value` is retained
- * may change, if the last reference to the value read is lost during GC and we re-read same value from
- * the same atomic reference. Thus we also include GC epoque into the cookie.
+ * Values read from the shared locations (atomic references, weak references) are remembered by the reading thread,
+ * so that it holds a reference to the value until its next GC. While held, the value cannot be released by
+ * the concurrent update of the location, so repeated reads of the same value by the same thread need neither
+ * the lock nor another rememberNewContainer(). Every thread tracks the values it remembered since its last GC
+ * on its own, so readers of the same location don't interfere with each other. The cache is lossy: a value
+ * not found in it is just read under the lock and remembered again.
  */
-inline int32_t computeCookie() {
-  auto* state = memoryState;
-  auto epoque = state->gcEpoque;
-  return (static_cast<int32_t>(reinterpret_cast<intptr_t>(state))) ^ static_cast<int32_t>(epoque);
+inline ObjHeader** rememberedValueEntry(MemoryState* state, ObjHeader* value) {
+  return &state->rememberedValues[(reinterpret_cast<uintptr_t>(value) / sizeof(ObjHeader)) & (kRememberedValuesSize - 1)];
+}
+
+inline bool isRemembered(MemoryState* state, ObjHeader* value) {
+  return state->rememberedValuesEpoque == state->gcEpoque && *rememberedValueEntry(state, value) == value;
+}
+
+// Shall be called under the location lock, with the value in the stack slot.
+void rememberValue(MemoryState* state, ObjHeader* value) {
+  if (isRemembered(state, value)) return;
+  // May run GC, so the epoque is checked afterwards: remembered reference is released by the next GC only.
+  rememberNewContainer(value->container());
+  if (state->rememberedValuesEpoque != state->gcEpoque) {
+    memset(state->rememberedValues, 0, sizeof(state->rememberedValues));
+    state->rememberedValuesEpoque = state->gcEpoque;
+  }
+  *rememberedValueEntry(state, value) = value;
+}
+
+// Called when remembered references are dropped before the GC, as they no longer keep values alive.
+inline void forgetRememberedValues(MemoryState* state) {
+  memset(state->rememberedValues, 0, sizeof(state->rememberedValues));
 }
+#endif  // USE_GC
 
 OBJ_GETTER(swapHeapRefLocked,
     ObjHeader** location, ObjHeader* expectedValue, ObjHeader* newValue, int32_t* spinlock, int32_t* cookie) {
   lock(spinlock);
   ObjHeader* oldValue = *location;
-  bool shallRemember = false;
-  if (IsStrictMemoryModel) {
-    auto realCookie = computeCookie();
-    shallRemember = *cookie != realCookie;
-    if (shallRemember) *cookie = realCookie;
-  }
   if (oldValue == expectedValue) {
+    SetHeapRef(location, newValue);
 #if USE_CYCLIC_GC
+    // Notify after the update, so that collector either sees the new value or restarts its analysis.
     if (g_hasCyclicCollector)
-      cyclicMutateAtomicRoot(newValue);
+      cyclicMutateAtomicRoot(location, newValue);
 #endif  // USE_CYCLIC_GC
-    SetHeapRef(location, newValue);
   }
   UpdateReturnRef(OBJ_RESULT, oldValue);
 
-  if (IsStrictMemoryModel && shallRemember && oldValue != nullptr && oldValue != expectedValue) {
+#if USE_GC
+  auto* state = memoryState;
+  if (IsStrictMemoryModel && state != nullptr && oldValue != nullptr && oldValue != expectedValue) {
     // Only remember container if it is not known to this thread (i.e. != expectedValue).
-    rememberNewContainer(oldValue->container());
+    rememberValue(state, oldValue);
   }
+#endif  // USE_GC
   unlock(spinlock);
 
   if (oldValue != nullptr && oldValue == expectedValue) {
@@ -2188,13 +3689,12 @@ OBJ_GETTER(swapHeapRefLocked,
 void setHeapRefLocked(ObjHeader** location, ObjHeader* newValue, int32_t* spinlock, int32_t* cookie) {
   lock(spinlock);
   ObjHeader* oldValue = *location;
+  // We do not use UpdateRef() here to avoid having ReleaseRef() on old value under the lock.
+  SetHeapRef(location, newValue);
 #if USE_CYCLIC_GC
   if (g_hasCyclicCollector)
-    cyclicMutateAtomicRoot(newValue);
+    cyclicMutateAtomicRoot(location, newValue);
 #endif  // USE_CYCLIC_GC
-  // We do not use UpdateRef() here to avoid having ReleaseRef() on old value under the lock.
-  SetHeapRef(location, newValue);
-  *cookie = computeCookie();
   unlock(spinlock);
   if (oldValue != nullptr)
     ReleaseHeapRef(oldValue);
@@ -2202,16 +3702,25 @@ void setHeapRefLocked(ObjHeader** location, ObjHeader* newValue, int32_t* spinlo
 
 OBJ_GETTER(readHeapRefLocked, ObjHeader** location, int32_t* spinlock, int32_t* cookie) {
   MEMORY_LOG("ReadHeapRefLocked: %p\n", location)
+#if USE_GC
+  auto* state = memoryState;
+  // Lock-free path for the repeated reads. Value remembered by this thread since its last GC is kept alive by
+  // this thread's own reference, whatever the location holds by now. Any other value could be released by
+  // the concurrent update between the load and the reference counter increment, so it is read under the lock.
+  if (IsStrictMemoryModel && state != nullptr) {
+    ObjHeader* value = atomicGet(location);
+    if (value == nullptr || isRemembered(state, value)) {
+      UpdateReturnRef(OBJ_RESULT, value);
+      return value;
+    }
+  }
+#endif  // USE_GC
   lock(spinlock);
   ObjHeader* value = *location;
-  auto realCookie = computeCookie();
-  bool shallRemember = *cookie != realCookie;
-  if (shallRemember) *cookie = realCookie;
   UpdateReturnRef(OBJ_RESULT, value);
 #if USE_GC
-  if (IsStrictMemoryModel && shallRemember && value != nullptr) {
-    auto* container = value->container();
-    rememberNewContainer(container);
+  if (IsStrictMemoryModel && state != nullptr && value != nullptr) {
+    rememberValue(state, value);
   }
 #endif  // USE_GC
   unlock(spinlock);
@@ -2287,6 +3796,7 @@ void stopGC() {
   GC_LOG("stopGC\n")
   if (memoryState->toRelease != nullptr) {
     memoryState->gcSuspendCount = 0;
+    cancelBackgroundGC(memoryState);
     garbageCollect(memoryState, true);
     konanDestructInstance(memoryState->toRelease);
     konanDestructInstance(memoryState->toFree);
@@ -2347,6 +3857,25 @@ KLong getGCThresholdAllocations() {
   return memoryState->allocSinceLastGcThreshold;
 }
 
+void setGCContainerCacheLimit(KLong value) {
+  GC_LOG("setGCContainerCacheLimit %lld\n", value)
+  if (value < 0) {
+    ThrowIllegalArgumentException();
+  }
+  memoryState->recycledContainersSizeLimit = value;
+  trimRecycledContainers(memoryState, value);
+}
+
+KLong getGCContainerCacheLimit() {
+  GC_LOG("getGCContainerCacheLimit\n")
+  return memoryState->recycledContainersSizeLimit;
+}
+
+KLong getGCContainerCacheSize() {
+  GC_LOG("getGCContainerCacheSize\n")
+  return memoryState->recycledContainersSize;
+}
+
 void setTuneGCThreshold(KBoolean value) {
   GC_LOG("setTuneGCThreshold %d\n", value)
   memoryState->gcErgonomics = value;
@@ -2357,21 +3886,146 @@ KBoolean getTuneGCThreshold() {
   return memoryState->gcErgonomics;
 }
 
-KNativePtr createStablePointer(KRef any) {
-  if (any == nullptr) return nullptr;
-  MEMORY_LOG("CreateStablePointer for %p rc=%d\n", any, any->container() ? any->container()->refCount() : 0)
-  addHeapRef(any);
-  return reinterpret_cast<KNativePtr>(any);
+void setConcurrentCycleGC(KBoolean value) {
+  GC_LOG("setConcurrentCycleGC %d\n", value)
+#if USE_CONCURRENT_CYCLE_GC
+  if (!IsStrictMemoryModel) {
+    if (value) ThrowIllegalArgumentException();
+    return;
+  }
+  setConcurrentCycleCollection(memoryState, value);
+#else
+  if (value)
+    ThrowIllegalArgumentException();
+#endif  // USE_CONCURRENT_CYCLE_GC
 }
 
-void disposeStablePointer(KNativePtr pointer) {
-  if (pointer == nullptr) return;
-  KRef ref = reinterpret_cast<KRef>(pointer);
-  ReleaseHeapRef(ref);
+KBoolean getConcurrentCycleGC() {
+  GC_LOG("getConcurrentCycleGC\n")
+#if USE_CONCURRENT_CYCLE_GC
+  return memoryState->concurrentCycleCollector != nullptr;
+#else
+  return false;
+#endif  // USE_CONCURRENT_CYCLE_GC
 }
 
-OBJ_GETTER(derefStablePointer, KNativePtr pointer) {
-  KRef ref = reinterpret_cast<KRef>(pointer);
+void setGCPauseTarget(KLong value) {
+  GC_LOG("setGCPauseTarget %lld\n", value)
+  if (value < 0) {
+    ThrowIllegalArgumentException();
+  }
+  memoryState->gcPauseTarget = value;
+}
+
+KLong getGCPauseTarget() {
+  GC_LOG("getGCPauseTarget\n")
+  return memoryState->gcPauseTarget;
+}
+
+KLong getGCPausePercentile(KDouble percentile) {
+  GC_LOG("getGCPausePercentile %f\n", percentile)
+  if (!(percentile >= 0 && percentile <= 100)) {
+    ThrowIllegalArgumentException();
+  }
+  auto* state = memoryState;
+  auto count = state->gcPauseCount < kGcPauseHistorySize ? state->gcPauseCount : kGcPauseHistorySize;
+  if (count == 0) return 0;
+  KStdVector<uint32_t> pauses(state->gcPauses, state->gcPauses + count);
+  size_t index = static_cast<size_t>(percentile * (count - 1) / 100 + 0.5);
+  std::nth_element(pauses.begin(), pauses.begin() + index, pauses.end());
+  return pauses[index];
+}
+
+void stopGCStatisticsStream() {
+  GC_LOG("stopGCStatisticsStream\n")
+  if (gcTelemetry != nullptr && gcTelemetry->stream >= 0) {
+    konan::fileClose(gcTelemetry->stream);
+    gcTelemetry->stream = -1;
+  }
+}
+
+void setGCStatistics(KBoolean value) {
+  GC_LOG("setGCStatistics %d\n", value)
+  if (value) {
+    if (gcTelemetry == nullptr)
+      gcTelemetry = konanConstructInstance<GcTelemetry>();
+  } else if (gcTelemetry != nullptr) {
+    stopGCStatisticsStream();
+    konanDestructInstance(gcTelemetry);
+    gcTelemetry = nullptr;
+  }
+}
+
+KBoolean getGCStatistics() {
+  GC_LOG("getGCStatistics\n")
+  return gcTelemetry != nullptr;
+}
+
+void copyGCStatistics(KRef values) {
+  GC_LOG("copyGCStatistics %p\n", values)
+  auto* array = values->array();
+  if (array->count_ != kGcStatCount) {
+    ThrowIllegalArgumentException();
+  }
+  for (int index = 0; index < kGcStatCount; index++) {
+    *AddressOfElementAt<KLong>(array, index) = gcTelemetry != nullptr ? gcTelemetry->values[index] : 0;
+  }
+#if USE_GC
+  if (gcTelemetry != nullptr)
+    *AddressOfElementAt<KLong>(array, kGcStatRetiredNurseryChunks) = atomicGet(&retiredNurseryChunksCount);
+#endif  // USE_GC
+}
+
+void startGCStatisticsStream(KRef path) {
+  GC_LOG("startGCStatisticsStream\n")
+  char* cpath = CreateCStringFromString(path);
+  int32_t file = konan::fileOpenForAppend(cpath);
+  DisposeCString(cpath);
+  if (file < 0) {
+    ThrowIllegalArgumentException();
+  }
+  setGCStatistics(true);
+  stopGCStatisticsStream();
+  gcTelemetry->stream = file;
+}
+
+void dumpHeap(KRef path) {
+  char* cpath = CreateCStringFromString(path);
+  int32_t file = konan::fileOpenForWrite(cpath);
+  DisposeCString(cpath);
+  if (file < 0) {
+    ThrowIllegalArgumentException();
+  }
+#if USE_GC
+  // Deferred heap writes must be reflected in the reported reference counters.
+  flushHeapWrites(memoryState);
+#endif  // USE_GC
+  auto* writer = konanConstructInstance<HeapSnapshotWriter>(file);
+  bool written = writer->write(memoryState);
+  konanDestructInstance(writer);
+  konan::fileClose(file);
+  if (!written) {
+    ThrowIllegalStateException();
+  }
+}
+
+KNativePtr createStablePointer(KRef any) {
+  if (any == nullptr) return nullptr;
+  MEMORY_LOG("CreateStablePointer for %p rc=%d\n", any, any->container() ? any->container()->refCount() : 0)
+  trackRegionRef(nullptr, nullptr, any);
+  addHeapRef(any);
+  return reinterpret_cast<KNativePtr>(any);
+}
+
+void disposeStablePointer(KNativePtr pointer) {
+  if (pointer == nullptr) return;
+  KRef ref = reinterpret_cast<KRef>(pointer);
+  trackRegionRef(nullptr, ref, nullptr);
+  ReleaseHeapRef(ref);
+}
+
+OBJ_GETTER(derefStablePointer, KNativePtr pointer) {
+  KRef ref = reinterpret_cast<KRef>(pointer);
   AdoptReferenceFromSharedVariable(ref);
   RETURN_OBJ(ref);
 }
@@ -2386,70 +4040,96 @@ OBJ_GETTER(adoptStablePointer, KNativePtr pointer) {
   return ref;
 }
 
-bool clearSubgraphReferences(ObjHeader* root, bool checked) {
+/**
+ * Roots are referred by stable pointers, and the union of their subgraphs is checked at once,
+ * so the per-call costs are paid once for all of them.
+ */
+bool clearSubgraphReferences(ObjHeader* const* roots, size_t count, bool checked) {
 #if USE_GC
-  MEMORY_LOG("ClearSubgraphReferences %p\n", root)
-  if (root == nullptr) return true;
-  auto state = memoryState;
-  auto* container = root->container();
-
-  if (isShareable(container))
+  MEMORY_LOG("ClearSubgraphReferences of %d roots\n", count)
+  ContainerHeaderList containers;
+  for (size_t index = 0; index < count; index++) {
+    if (roots[index] == nullptr) continue;
+    auto* container = roots[index]->container();
     // We assume, that frozen/shareable objects can be safely passed and not present
-    // in the GC candidate list.
+    // in the GC candidate list, and arena objects are never there.
     // TODO: assert for that?
-    return true;
+    if (isShareable(container) || isArena(container)) continue;
+    containers.push_back(container);
+  }
+  if (containers.empty()) return true;
+  auto state = memoryState;
 
-  ContainerHeaderSet visited;
-  if (!checked) {
-    hasExternalRefs(container, &visited);
-  } else {
-    // Now decrement RC of elements in toRelease set for reachibility analysis.
-    for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
-      auto released = *it;
-      if (!isMarkedAsRemoved(released) && released->local()) {
-        released->decRefCount<false>();
+  // Background collector must not traverse objects leaving this worker.
+  cancelBackgroundGC(state);
+  flushHeapWrites(state);
+
+  // All the work is proportional to the size of the transferred subgraph, not to the GC backlog.
+  ContainerHeaderList subgraph;
+  for (auto* container : containers) {
+    if (!container->seen())
+      collectTransferredSubgraph(container, &subgraph);
+  }
+  auto* toRelease = state->toRelease;
+  state->toReleaseIndex->update(*toRelease);
+  if (checked) {
+    // Now decrement RC of subgraph elements in toRelease set for reachibility analysis.
+    for (auto* member : subgraph) {
+      if (member->local())
+        state->toReleaseIndex->forEach(*toRelease, member, [member](size_t) { member->decRefCount<false>(); });
+    }
+    for (auto* container : containers) {
+      container->decRefCount<false>();
+      markGray<false>(container);
+    }
+    // Subgraph elements referred from outside the subgraph keep non-zero RC.
+    bool bad = false;
+    for (auto* member : subgraph) {
+      if (member->refCount() > 0) {
+        MEMORY_LOG("container %p with rc %d blocks transfer\n", member, member->refCount())
+        bad = true;
+        break;
       }
     }
-    container->decRefCount<false>();
-    markGray<false>(container);
-    auto bad = hasExternalRefs(container, &visited);
-    scanBlack<false>(container);
     // Restore original RC.
-    container->incRefCount<false>();
-    for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
-       auto released = *it;
-       if (!isMarkedAsRemoved(released) && released->local()) {
-         released->incRefCount<false>();
-       }
+    for (auto* container : containers) {
+      scanBlack<false>(container);
+      container->incRefCount<false>();
+    }
+    for (auto* member : subgraph) {
+      if (member->local())
+        state->toReleaseIndex->forEach(*toRelease, member, [member](size_t) { member->incRefCount<false>(); });
     }
     if (bad) {
+      for (auto* member : subgraph)
+        member->resetSeen();
       return false;
     }
   }
 
   // Remove all no longer owned containers from GC structures.
-  // TODO: not very efficient traversal.
-  for (auto it = state->toFree->begin(); it != state->toFree->end(); ++it) {
-    auto container = *it;
-    if (visited.count(container) != 0) {
-      MEMORY_LOG("removing %p from the toFree list\n", container)
-      container->resetBuffered();
-      container->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
-      *it = markAsRemoved(container);
-    }
-  }
-  for (auto it = state->toRelease->begin(); it != state->toRelease->end(); ++it) {
-    auto container = *it;
-    if (!isMarkedAsRemoved(container) && visited.count(container) != 0) {
-      MEMORY_LOG("removing %p from the toRelease list\n", container)
-      container->decRefCount<false>();
-      *it = markAsRemoved(container);
-    }
+  auto* toFree = state->toFree;
+  state->toFreeIndex->update(*toFree);
+  for (auto* member : subgraph) {
+    member->resetSeen();
+    state->toFreeIndex->forEach(*toFree, member, [toFree, member](size_t position) {
+      MEMORY_LOG("removing %p from the toFree list\n", member)
+      member->resetBuffered();
+      member->setColorAssertIfGreen(CONTAINER_TAG_GC_BLACK);
+      (*toFree)[position] = markAsRemoved(member);
+    });
+    state->toReleaseIndex->forEach(*toRelease, member, [toRelease, member](size_t position) {
+      MEMORY_LOG("removing %p from the toRelease list\n", member)
+      member->decRefCount<false>();
+      (*toRelease)[position] = markAsRemoved(member);
+    });
   }
+  // Dropped decrements could be the remembered references of the values read from shared locations.
+  forgetRememberedValues(state);
 
 #if TRACE_MEMORY
   // Forget transferred containers.
-  for (auto* it: visited) {
+  for (auto* it: subgraph) {
     state->containers->erase(it);
   }
 #endif
@@ -2458,7 +4138,107 @@ bool clearSubgraphReferences(ObjHeader* root, bool checked) {
   return true;
 }
 
-void freezeAcyclic(ContainerHeader* rootContainer, ContainerHeaderSet* newlyFrozen) {
+ObjectRegion* createObjectRegion() {
+  auto* region = konanConstructInstance<ObjectRegion>();
+  region->arena.Init(kObjectRegionChunkSize);
+  MEMORY_LOG("Created object region %p\n", region)
+  return region;
+}
+
+bool ObjectRegion::contains(const void* address) {
+  auto value = reinterpret_cast<uintptr_t>(address);
+  auto* current = arena.currentChunk();
+  if (value >= reinterpret_cast<uintptr_t>(current) && value < reinterpret_cast<uintptr_t>(current->end))
+    return true;
+  for (auto* chunk = current; chunk != indexedChunk; chunk = chunk->next) {
+    chunks[reinterpret_cast<uintptr_t>(chunk)] = reinterpret_cast<uintptr_t>(chunk->end);
+  }
+  indexedChunk = current;
+  auto it = chunks.upper_bound(value);
+  if (it == chunks.begin()) return false;
+  --it;
+  return value < it->second;
+}
+
+void trackRegionRefSlowPath(ObjHeader** location, const ObjHeader* old, const ObjHeader* object) {
+  auto* state = memoryState;
+  if (state == nullptr) return;
+  for (auto* region = state->guardedRegion; region != nullptr; region = region->previousGuardedRegion) {
+    int delta = 0;
+    if (reinterpret_cast<uintptr_t>(object) > 1 && region->arena.Owns(object->container())) delta++;
+    if (reinterpret_cast<uintptr_t>(old) > 1 && region->arena.Owns(old->container())) delta--;
+    if (delta == 0 || (location != nullptr && region->contains(location))) continue;
+    MEMORY_LOG("Object region %p is referred from %p\n", region, location)
+    region->outsideRefs += delta;
+  }
+}
+
+void enterObjectRegion(ObjectRegion* region, bool allocate) {
+  auto* state = memoryState;
+  region->previousAllocationRegion = state->allocationRegion;
+  region->previousGuardedRegion = state->guardedRegion;
+  if (allocate) state->allocationRegion = region;
+  state->guardedRegion = region;
+  atomicAdd(&guardedObjectRegionsCount, 1);
+}
+
+void leaveObjectRegion(ObjectRegion* region) {
+  auto* state = memoryState;
+  RuntimeAssert(state->guardedRegion == region, "Object regions must be left in the reverse order");
+  state->allocationRegion = region->previousAllocationRegion;
+  state->guardedRegion = region->previousGuardedRegion;
+  atomicAdd(&guardedObjectRegionsCount, -1);
+}
+
+// Checks if region is still referred from outside, once the garbage referring to it is collected.
+bool isReferredFromOutside(ObjectRegion* region) {
+  if (region->outsideRefs == 0) return false;
+#if USE_GC
+  // Released garbage must be counted as well.
+  enterObjectRegion(region, false);
+  garbageCollect(memoryState, true);
+  leaveObjectRegion(region);
+#endif  // USE_GC
+  return region->outsideRefs != 0;
+}
+
+bool sealObjectRegion(ObjectRegion* region, ObjHeader* root, bool checked) {
+  auto* state = memoryState;
+  RuntimeAssert(state->allocationRegion != region, "Object region must be left before sealing");
+  region->root = region->arena.getSlot();
+  UpdateHeapRef(region->root, root);
+#if USE_GC
+  // Background collector must not traverse objects leaving this worker.
+  cancelBackgroundGC(state);
+#endif  // USE_GC
+  // Region memory is released by another worker, so the log must not keep its slots.
+  flushHeapWrites(state);
+  // Region objects are not reference counted, so references both from and to the region are checked.
+  return !checked || (region->arena.IsSelfContained() && !isReferredFromOutside(region));
+}
+
+bool isInObjectRegion(ObjectRegion* region, const ObjHeader* object) {
+  return object != nullptr && region->arena.Owns(object->container());
+}
+
+bool releaseObjectRegion(ObjectRegion* region) {
+  if (isReferredFromOutside(region)) {
+    // Leaked, as its objects are still reachable.
+    MEMORY_LOG("Object region %p is referred from outside, cannot free it\n", region)
+    return false;
+  }
+  MEMORY_LOG("Freeing object region %p\n", region)
+  auto* state = memoryState;
+#if USE_GC
+  cancelBackgroundGC(state);
+#endif  // USE_GC
+  flushHeapWrites(state);
+  region->arena.Deinit();
+  konanDestructInstance(region);
+  return true;
+}
+
+void freezeAcyclic(ContainerHeader* rootContainer) {
   KStdDeque<ContainerHeader*> queue;
   queue.push_back(rootContainer);
   while (!queue.empty()) {
@@ -2469,8 +4249,6 @@ void freezeAcyclic(ContainerHeader* rootContainer, ContainerHeaderSet* newlyFroz
     current->setColorUnlessGreen(CONTAINER_TAG_GC_BLACK);
     // Note, that once object is frozen, it could be concurrently accessed, so
     // color and similar attributes shall not be used.
-    if (!current->frozen())
-      newlyFrozen->insert(current);
     MEMORY_LOG("freezing %p\n", current)
     current->freeze();
     traverseContainerReferredObjects(current, [current, &queue](ObjHeader* obj) {
@@ -2483,27 +4261,19 @@ void freezeAcyclic(ContainerHeader* rootContainer, ContainerHeaderSet* newlyFroz
   }
 }
 
-void freezeCyclic(ObjHeader* root,
-                  const KStdVector<ContainerHeader*>& order,
-                  ContainerHeaderSet* newlyFrozen) {
+void freezeCyclic(const KStdVector<ContainerHeader*>& order) {
   KStdUnorderedMap<ContainerHeader*, KStdVector<ContainerHeader*>> reversedEdges;
-  KStdDeque<ObjHeader*> queue;
-  queue.push_back(root);
-  while (!queue.empty()) {
-    ObjHeader* current = queue.front();
-    queue.pop_front();
-    ContainerHeader* currentContainer = current->container();
+  // Order contains all the containers seen by depthFirstTraversal().
+  for (auto* currentContainer : order) {
     currentContainer->unMark();
     reversedEdges.emplace(currentContainer, KStdVector<ContainerHeader*>(0));
-    traverseContainerReferredObjects(currentContainer, [current, currentContainer, &queue, &reversedEdges](ObjHeader* obj) {
+    // We ignore references from FreezableAtomicsReference during condensation, to avoid KT-33824.
+    if (isFreezableAtomic(currentContainer)) continue;
+    traverseContainerReferredObjects(currentContainer, [currentContainer, &reversedEdges](ObjHeader* obj) {
           ContainerHeader* objContainer = obj->container();
           if (canFreeze(objContainer)) {
-            if (objContainer->marked())
-              queue.push_back(obj);
-            // We ignore references from FreezableAtomicsReference during condensation, to avoid KT-33824.
-            if (!isFreezableAtomic(current))
-              reversedEdges.emplace(objContainer, KStdVector<ContainerHeader*>(0)).
-                first->second.push_back(currentContainer);
+            reversedEdges.emplace(objContainer, KStdVector<ContainerHeader*>(0)).
+              first->second.push_back(currentContainer);
           }
       });
    }
@@ -2547,8 +4317,6 @@ void freezeCyclic(ObjHeader* root,
     for (auto* container : component) {
       container->resetBuffered();
       container->setColorUnlessGreen(CONTAINER_TAG_GC_BLACK);
-      if (!container->frozen())
-        newlyFrozen->insert(container);
       // Note, that once object is frozen, it could be concurrently accessed, so
       // color and similar attributes shall not be used.
       MEMORY_LOG("freezing %p\n", container)
@@ -2564,10 +4332,354 @@ void freezeCyclic(ObjHeader* root,
     MEMORY_LOG("Setting aggregating %p rc to %d (total %d inner %d)\n", \
        superContainer, totalCount - internalRefsCount, totalCount, internalRefsCount)
     superContainer->setRefCount(totalCount - internalRefsCount);
-    newlyFrozen->insert(superContainer);
   }
 }
 
+#if USE_PARALLEL_FREEZE
+/**
+ * Theory of operations.
+ *
+ * Freezing of big graphs (more than kParallelFreezeThreshold containers, as found by the bounded sequential
+ * traversal in freezeSubgraph()) is split between the calling thread and helper threads, started once per
+ * freezing, so that graph is not mutated meanwhile. It happens in phases, each one is finished by all the threads
+ * before the next one starts:
+ *   - mark: all reachable freezable containers are claimed by the atomic 'marked' bit, and freeze blockers
+ *     are looked for. Each claimed container gets a slot for the worker-local bookkeeping, which index is
+ *     kept in place of the reference counter until the end of freezing
+ *   - count: for each container number of references from other containers of the graph is computed
+ *   - peel: containers not referred from the graph are removed from it, and so on (Kahn's algorithm).
+ *     Removed containers are not parts of any cycle, and so are just frozen
+ *   - finish: reference counters are restored, peeled containers are frozen
+ * Containers left after peeling are ones in strongly connected components or reachable from them only,
+ * they are frozen by the sequential pass, building aggregating containers if needed.
+ * Work is shared between threads by handing chunks of the traversal stack to idle ones.
+ */
+class ParallelFreezer {
+ public:
+  explicit ParallelFreezer(int workersCount) : workersCount_(workersCount) {
+    CHECK_CALL(pthread_mutex_init(&lock_, nullptr), "Cannot init freezer mutex")
+    CHECK_CALL(pthread_cond_init(&cond_, nullptr), "Cannot init freezer condition")
+    CHECK_CALL(pthread_cond_init(&phaseCond_, nullptr), "Cannot init freezer phase condition")
+    for (int index = 1; index < workersCount_; index++) {
+      helpers_[index] = { this, index };
+      CHECK_CALL(pthread_create(&threads_[index], nullptr, helperRoutine, &helpers_[index]),
+          "Cannot start freezer thread")
+    }
+  }
+
+  ~ParallelFreezer() {
+    // Null phase makes helpers exit.
+    startPhase(nullptr);
+    for (int index = 1; index < workersCount_; index++) {
+      pthread_join(threads_[index], nullptr);
+    }
+    pthread_cond_destroy(&phaseCond_);
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&lock_);
+  }
+
+  /**
+   * Freezes graph reachable from the root.
+   * Returns false, if graph was not touched, `firstBlocker` is set if freezing is impossible.
+   * Otherwise containers left for the sequential pass are added to `residual`.
+   */
+  bool freeze(ContainerHeader* root, KRef* firstBlocker, ContainerHeaderList* residual) {
+    RuntimeCheck(root->tryMarkAtomically(), "Root must not be marked");
+    claim(0, root);
+    MEMORY_LOG("Freezing graph of %p by %d threads\n", root, workersCount_)
+    runPhase(&ParallelFreezer::markPhase);
+    if (aborted_) {
+      runPhase(&ParallelFreezer::restorePhase);
+      *firstBlocker = firstBlocker_;
+      // Blocker is reported, otherwise graph is too big for slots and is frozen sequentially.
+      return false;
+    }
+    runPhase(&ParallelFreezer::countPhase);
+    runPhase(&ParallelFreezer::peelPhase);
+    runPhase(&ParallelFreezer::finishPhase);
+    for (int index = 0; index < workersCount_; index++) {
+      residual->insert(residual->end(), workers_[index].residual.begin(), workers_[index].residual.end());
+    }
+    MEMORY_LOG("Graph of %p is frozen in parallel, %d containers left\n", root, residual->size())
+    return true;
+  }
+
+ private:
+  struct Entry {
+    ContainerHeader* container;
+    // Actual reference counter of the container.
+    int refCount;
+    // Number of references from the containers of the graph, not peeled yet.
+    int inDegree;
+  };
+
+  struct Worker {
+    KStdVector<Entry> entries;
+    ContainerHeaderList stack;
+    ContainerHeaderList residual;
+  };
+
+  struct Helper {
+    ParallelFreezer* freezer;
+    int index;
+  };
+
+  typedef void (ParallelFreezer::*Phase)(int);
+
+  Worker workers_[kMaxParallelFreezeWorkers];
+  int workersCount_;
+  pthread_t threads_[kMaxParallelFreezeWorkers];
+  Helper helpers_[kMaxParallelFreezeWorkers];
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  // Phase run by helpers, its generation and number of helpers still running it, protected by lock_.
+  pthread_cond_t phaseCond_;
+  Phase phase_ = nullptr;
+  int phaseGeneration_ = 0;
+  int phaseRunning_ = 0;
+  // Work handed to idle threads, protected by lock_.
+  KStdVector<ContainerHeaderList> chunks_;
+  volatile int idle_ = 0;
+  bool done_ = false;
+  volatile int aborted_ = 0;
+  KRef firstBlocker_ = nullptr;
+
+  static void* helperRoutine(void* argument) {
+    auto* helper = reinterpret_cast<Helper*>(argument);
+    helper->freezer->helperLoop(helper->index);
+    return nullptr;
+  }
+
+  // Runs phases as they are started, until the null one.
+  void helperLoop(int workerIndex) {
+    int generation = 0;
+    while (true) {
+      pthread_mutex_lock(&lock_);
+      while (phaseGeneration_ == generation) pthread_cond_wait(&phaseCond_, &lock_);
+      generation = phaseGeneration_;
+      Phase phase = phase_;
+      pthread_mutex_unlock(&lock_);
+      if (phase == nullptr) return;
+      (this->*phase)(workerIndex);
+      pthread_mutex_lock(&lock_);
+      if (--phaseRunning_ == 0) pthread_cond_broadcast(&phaseCond_);
+      pthread_mutex_unlock(&lock_);
+    }
+  }
+
+  void startPhase(Phase phase) {
+    pthread_mutex_lock(&lock_);
+    phase_ = phase;
+    phaseRunning_ = workersCount_ - 1;
+    phaseGeneration_++;
+    pthread_cond_broadcast(&phaseCond_);
+    pthread_mutex_unlock(&lock_);
+  }
+
+  // Runs phase on all the workers, the calling thread being the first one, and waits for all of them to finish.
+  void runPhase(Phase phase) {
+    // Helpers are waiting for the phase, so the shared state may be reset.
+    chunks_.clear();
+    idle_ = 0;
+    done_ = false;
+    startPhase(phase);
+    (this->*phase)(0);
+    pthread_mutex_lock(&lock_);
+    while (phaseRunning_ > 0) pthread_cond_wait(&phaseCond_, &lock_);
+    pthread_mutex_unlock(&lock_);
+  }
+
+  static inline int slotWorker(int slot) {
+    return slot & ((1 << kParallelFreezeWorkerBits) - 1);
+  }
+
+  static inline int slotIndex(int slot) {
+    return slot >> kParallelFreezeWorkerBits;
+  }
+
+  inline Entry& entryOf(ContainerHeader* container) {
+    int slot = container->refCount();
+    return workers_[slotWorker(slot)].entries[slotIndex(slot)];
+  }
+
+  void abort(KRef blocker) {
+    if (blocker != nullptr)
+      compareAndSwap(&firstBlocker_, static_cast<KRef>(nullptr), blocker);
+    atomicSet(&aborted_, 1);
+    pthread_mutex_lock(&lock_);
+    done_ = true;
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&lock_);
+  }
+
+  // Takes ownership of the container already marked by the worker.
+  void claim(int workerIndex, ContainerHeader* container) {
+    auto& worker = workers_[workerIndex];
+    if (worker.entries.size() >= kMaxParallelFreezeWorkerContainers) {
+      // Leave it marked, so that it is found and restored by restorePhase.
+      worker.entries.push_back({ container, container->refCount(), 0 });
+      abort(nullptr);
+      return;
+    }
+    int slot = (static_cast<int>(worker.entries.size()) << kParallelFreezeWorkerBits) | workerIndex;
+    worker.entries.push_back({ container, container->refCount(), 0 });
+    container->setRefCount(slot);
+    worker.stack.push_back(container);
+  }
+
+  // Hands part of the stack to idle workers, if any.
+  void share(Worker& worker) {
+    if (worker.stack.size() < 2 * kParallelFreezeChunkSize || atomicGet(&idle_) == 0) return;
+    auto begin = worker.stack.end() - kParallelFreezeChunkSize;
+    pthread_mutex_lock(&lock_);
+    chunks_.emplace_back(begin, worker.stack.end());
+    pthread_cond_signal(&cond_);
+    pthread_mutex_unlock(&lock_);
+    worker.stack.erase(begin, worker.stack.end());
+  }
+
+  // Waits for work from other workers, returns false once all of them are out of work.
+  bool takeWork(Worker& worker) {
+    pthread_mutex_lock(&lock_);
+    idle_++;
+    while (chunks_.empty() && !done_) {
+      if (idle_ == workersCount_) {
+        done_ = true;
+        pthread_cond_broadcast(&cond_);
+        break;
+      }
+      pthread_cond_wait(&cond_, &lock_);
+    }
+    bool result = !done_;
+    if (result) {
+      idle_--;
+      worker.stack.swap(chunks_.back());
+      chunks_.pop_back();
+    }
+    pthread_mutex_unlock(&lock_);
+    return result;
+  }
+
+  template <typename func>
+  void drain(int workerIndex, func process) {
+    auto& worker = workers_[workerIndex];
+    do {
+      while (!worker.stack.empty() && !atomicGet(&aborted_)) {
+        auto* container = worker.stack.back();
+        worker.stack.pop_back();
+        process(container);
+        share(worker);
+      }
+      worker.stack.clear();
+    } while (takeWork(worker));
+  }
+
+  void mark(int workerIndex, ContainerHeader* container) {
+    traverseContainerReferredObjects(container, [this, workerIndex](ObjHeader* obj) {
+      if (blocksFreezing(obj)) {
+        abort(obj);
+        return;
+      }
+      ContainerHeader* objContainer = obj->container();
+      if (canFreeze(objContainer) && objContainer->tryMarkAtomically())
+        claim(workerIndex, objContainer);
+    });
+  }
+
+  void markPhase(int workerIndex) {
+    drain(workerIndex, [this, workerIndex](ContainerHeader* container) {
+      mark(workerIndex, container);
+    });
+  }
+
+  void countPhase(int workerIndex) {
+    for (auto& entry : workers_[workerIndex].entries) {
+      traverseContainerReferredObjects(entry.container, [this](ObjHeader* obj) {
+        ContainerHeader* objContainer = obj->container();
+        if (canFreeze(objContainer))
+          atomicAdd(&entryOf(objContainer).inDegree, 1);
+      });
+    }
+  }
+
+  void peelPhase(int workerIndex) {
+    auto& worker = workers_[workerIndex];
+    for (auto& entry : worker.entries) {
+      if (entry.inDegree == 0)
+        worker.stack.push_back(entry.container);
+    }
+    drain(workerIndex, [this, &worker](ContainerHeader* container) {
+      traverseContainerReferredObjects(container, [this, &worker](ObjHeader* obj) {
+        ContainerHeader* objContainer = obj->container();
+        if (canFreeze(objContainer) && atomicAdd(&entryOf(objContainer).inDegree, -1) == 0)
+          worker.stack.push_back(objContainer);
+      });
+    });
+  }
+
+  void finishPhase(int workerIndex) {
+    auto& worker = workers_[workerIndex];
+    for (auto& entry : worker.entries) {
+      auto* container = entry.container;
+      container->setRefCount(entry.refCount);
+      container->unMark();
+      if (entry.inDegree != 0) {
+        worker.residual.push_back(container);
+        continue;
+      }
+      container->resetBuffered();
+      container->setColorUnlessGreen(CONTAINER_TAG_GC_BLACK);
+      MEMORY_LOG("freezing %p\n", container)
+      container->freeze();
+    }
+  }
+
+  void restorePhase(int workerIndex) {
+    for (auto& entry : workers_[workerIndex].entries) {
+      entry.container->setRefCount(entry.refCount);
+      entry.container->unMark();
+    }
+  }
+};
+
+// Number of threads used for freezing, computed once.
+int g_parallelFreezeWorkers = 0;
+
+int parallelFreezeWorkers() {
+  int result = atomicGet(&g_parallelFreezeWorkers);
+  if (result == 0) {
+    int processors = konan::availableProcessors();
+    result = processors < kMaxParallelFreezeWorkers ? processors : kMaxParallelFreezeWorkers;
+    atomicSet(&g_parallelFreezeWorkers, result);
+  }
+  return result;
+}
+
+/**
+ * Freezes graph of the root in parallel.
+ * Returns false if graph is not changed, with `firstBlocker` set if freezing is impossible.
+ */
+bool freezeInParallel(ContainerHeader* rootContainer, KRef* firstBlocker) {
+  int workers = parallelFreezeWorkers();
+  ContainerHeaderList residual;
+  {
+    ParallelFreezer freezer(workers);
+    if (!freezer.freeze(rootContainer, firstBlocker, &residual)) return false;
+  }
+  // Containers left belong to strongly connected components or are reachable from them only,
+  // so are frozen with the sequential algorithm.
+  bool hasCycles = false;
+  KStdVector<ContainerHeader*> order;
+  for (auto* container : residual) {
+    if (!container->marked())
+      depthFirstTraversal(container, &hasCycles, firstBlocker, &order);
+  }
+  RuntimeAssert(*firstBlocker == nullptr, "Blockers must be found by parallel freezer");
+  freezeCyclic(order);
+  return true;
+}
+#endif  // USE_PARALLEL_FREEZE
+
 /**
  * Theory of operations.
  *
@@ -2600,24 +4712,47 @@ void freezeSubgraph(ObjHeader* root) {
 
   MEMORY_LOG("Freeze subgraph of %p\n", root)
 
+#if USE_GC
+  // Background collector must not observe containers changing their kind.
+  cancelBackgroundGC(memoryState);
+  // Freezing relies on exact reference counters.
+  flushHeapWrites(memoryState);
+#endif
+
   // Do DFS cycle detection.
   bool hasCycles = false;
-  KRef firstBlocker = root->has_meta_object() && ((root->meta_object()->flags_ & MF_NEVER_FROZEN) != 0) ?
-    root : nullptr;
+  KRef firstBlocker = blocksFreezing(root) ? root : nullptr;
   KStdVector<ContainerHeader*> order;
-  depthFirstTraversal(rootContainer, &hasCycles, &firstBlocker, &order);
+  bool frozen = false;
+  if (firstBlocker == nullptr) {
+    size_t limit = SIZE_MAX;
+#if USE_PARALLEL_FREEZE
+    // Most frozen graphs are small, so the sequential traversal result is used, unless it sees too many containers.
+    if (IsStrictMemoryModel && parallelFreezeWorkers() > 1)
+      limit = kParallelFreezeThreshold;
+#endif  // USE_PARALLEL_FREEZE
+    if (!depthFirstTraversal(rootContainer, &hasCycles, &firstBlocker, &order, limit)) {
+#if USE_PARALLEL_FREEZE
+      frozen = freezeInParallel(rootContainer, &firstBlocker);
+#endif  // USE_PARALLEL_FREEZE
+      // Unless blocked, graph is too big for the parallel freezer.
+      if (!frozen && firstBlocker == nullptr)
+        depthFirstTraversal(rootContainer, &hasCycles, &firstBlocker, &order);
+    }
+  }
   if (firstBlocker != nullptr) {
     MEMORY_LOG("See freeze blocker for %p: %p\n", root, firstBlocker)
     ThrowFreezingException(root, firstBlocker);
   }
-  ContainerHeaderSet newlyFrozen;
   // Now unmark all marked objects, and freeze them, if no cycles detected.
-  if (hasCycles) {
-    freezeCyclic(root, order, &newlyFrozen);
+  if (frozen) {
+    MEMORY_LOG("Graph of %p is frozen in parallel\n", root)
+  } else if (hasCycles) {
+    freezeCyclic(order);
   } else {
-    freezeAcyclic(rootContainer, &newlyFrozen);
+    freezeAcyclic(rootContainer);
   }
-  MEMORY_LOG("Graph of %p is %s with %d elements\n", root, hasCycles ? "cyclic" : "acyclic", newlyFrozen.size())
+  MEMORY_LOG("Graph of %p is %s with %d elements\n", root, hasCycles ? "cyclic" : "acyclic", order.size())
 
 #if USE_GC
   // Now remove frozen objects from the toFree list.
@@ -2626,7 +4761,6 @@ void freezeSubgraph(ObjHeader* root) {
   auto state = memoryState;
   for (auto& container : *(state->toFree)) {
     if (!isMarkedAsRemoved(container) && container->frozen()) {
-      RuntimeAssert(newlyFrozen.count(container) != 0, "Must be newly frozen");
       container = markAsRemoved(container);
     }
   }
@@ -2644,8 +4778,18 @@ void ensureNeverFrozen(ObjHeader* object) {
 
 void shareAny(ObjHeader* obj) {
   auto* container = obj->container();
-  if (isShareable(container)) return;
+  // Arena objects are never reference counted, so could be passed along with their arena only.
+  if (isShareable(container) || isArena(container)) return;
   RuntimeCheck(container->objectCount() == 1, "Must be a single object container");
+#if USE_GC
+  cancelBackgroundGC(memoryState);
+  flushHeapWrites(memoryState);
+#endif
+#if COALESCE_HEAP_WRITES
+  const TypeInfo* typeInfo = obj->type_info();
+  if (typeInfo == theArrayTypeInfo || typeInfo->objOffsetsCount_ > 0)
+    atomicSet(&hasSharedReferenceSlots, 1);
+#endif  // COALESCE_HEAP_WRITES
   container->makeShared();
 }
 
@@ -2684,6 +4828,9 @@ void ObjHeader::destroyMetaObject(TypeInfo** location) {
     WeakReferenceCounterClear(meta->WeakReference.counter_);
     ZeroHeapRef(&meta->WeakReference.counter_);
   }
+  if (meta->String.utf16_ != nullptr) {
+    konanFreeMemory(meta->String.utf16_);
+  }
 
 #ifdef KONAN_OBJC_INTEROP
   Kotlin_ObjCExport_releaseAssociatedObject(meta->associatedObject_);
@@ -2695,10 +4842,11 @@ void ObjHeader::destroyMetaObject(TypeInfo** location) {
 void ObjectContainer::Init(MemoryState* state, const TypeInfo* typeInfo) {
   RuntimeAssert(typeInfo->instanceSize_ >= 0, "Must be an object");
   uint32_t allocSize = sizeof(ContainerHeader) + typeInfo->instanceSize_;
-  header_ = allocContainer(state, allocSize);
+  header_ = allocObjectContainer(state, allocSize);
   RuntimeCheck(header_ != nullptr, "Cannot alloc memory");
   // One object in this container, no need to set.
-  header_->setContainerSize(allocSize);
+  if (!header_->nursery())
+    header_->setContainerSize(allocSize);
   RuntimeAssert(header_->objectCount() == 1, "Must work properly");
   // header->refCount_ is zero initialized by allocContainer().
   SetHeader(GetPlace(), typeInfo);
@@ -2709,10 +4857,11 @@ void ArrayContainer::Init(MemoryState* state, const TypeInfo* typeInfo, uint32_t
   RuntimeAssert(typeInfo->instanceSize_ < 0, "Must be an array");
   uint32_t allocSize =
       sizeof(ContainerHeader) + arrayObjectSize(typeInfo, elements);
-  header_ = allocContainer(state, allocSize);
+  header_ = allocObjectContainer(state, allocSize);
   RuntimeCheck(header_ != nullptr, "Cannot alloc memory");
   // One object in this container, no need to set.
-  header_->setContainerSize(allocSize);
+  if (!header_->nursery())
+    header_->setContainerSize(allocSize);
   RuntimeAssert(header_->objectCount() == 1, "Must work properly");
   // header->refCount_ is zero initialized by allocContainer().
   GetPlace()->count_ = elements;
@@ -2722,8 +4871,9 @@ void ArrayContainer::Init(MemoryState* state, const TypeInfo* typeInfo, uint32_t
 
 // TODO: store arena containers in some reuseable data structure, similar to
 // finalizer queue.
-void ArenaContainer::Init() {
-  allocContainer(1024);
+void ArenaContainer::Init(container_size_t minChunkSize) {
+  minChunkSize_ = minChunkSize;
+  allocContainer(minChunkSize > 1024 ? minChunkSize : 1024);
 }
 
 void ArenaContainer::Deinit() {
@@ -2752,6 +4902,7 @@ bool ArenaContainer::allocContainer(container_size_t minSize) {
   if (result == nullptr) return false;
   result->next = currentChunk_;
   result->arena = this;
+  result->end = reinterpret_cast<uint8_t*>(result) + size;
   result->asHeader()->refCount_ = (CONTAINER_TAG_STACK | CONTAINER_TAG_INCREMENT);
   currentChunk_ = result;
   current_ = reinterpret_cast<uint8_t*>(result->asHeader() + 1);
@@ -2767,7 +4918,7 @@ void* ArenaContainer::place(container_size_t size) {
     current_ += size;
     return result;
   }
-  if (!allocContainer(size)) {
+  if (!allocContainer(size > minChunkSize_ ? size : minChunkSize_)) {
     return nullptr;
   }
   void* result = current_;
@@ -2776,6 +4927,21 @@ void* ArenaContainer::place(container_size_t size) {
   return result;
 }
 
+bool ArenaContainer::IsSelfContained() const {
+  for (auto* chunk = currentChunk_; chunk != nullptr; chunk = chunk->next) {
+    bool selfContained = true;
+    traverseContainerReferredObjects(chunk->asHeader(), [this, &selfContained](ObjHeader* ref) {
+      auto* container = ref->container();
+      if (!isShareable(container) && !Owns(container)) {
+        MEMORY_LOG("%p refers to the object %p outside of arena\n", this, ref)
+        selfContained = false;
+      }
+    });
+    if (!selfContained) return false;
+  }
+  return true;
+}
+
 #define ARENA_SLOTS_CHUNK_SIZE 16
 
 ObjHeader** ArenaContainer::getSlot() {
@@ -3062,6 +5228,28 @@ KLong Kotlin_native_internal_GC_getThresholdAllocations(KRef) {
 #endif
 }
 
+void Kotlin_native_internal_GC_setContainerCacheLimit(KRef, KLong value) {
+#if USE_GC
+  setGCContainerCacheLimit(value);
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getContainerCacheLimit(KRef) {
+#if USE_GC
+  return getGCContainerCacheLimit();
+#else
+  return -1;
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getContainerCacheSize(KRef) {
+#if USE_GC
+  return getGCContainerCacheSize();
+#else
+  return 0;
+#endif
+}
+
 void Kotlin_native_internal_GC_setTuneThreshold(KRef, KInt value) {
 #if USE_GC
   setTuneGCThreshold(value);
@@ -3076,6 +5264,74 @@ KBoolean Kotlin_native_internal_GC_getTuneThreshold(KRef) {
 #endif
 }
 
+void Kotlin_native_internal_GC_setConcurrentCycleCollection(KRef, KBoolean value) {
+#if USE_GC
+  setConcurrentCycleGC(value);
+#else
+  if (value)
+    ThrowIllegalArgumentException();
+#endif
+}
+
+KBoolean Kotlin_native_internal_GC_getConcurrentCycleCollection(KRef) {
+#if USE_GC
+  return getConcurrentCycleGC();
+#else
+  return false;
+#endif
+}
+
+void Kotlin_native_internal_GC_setPauseTarget(KRef, KLong value) {
+#if USE_GC
+  setGCPauseTarget(value);
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getPauseTarget(KRef) {
+#if USE_GC
+  return getGCPauseTarget();
+#else
+  return 0;
+#endif
+}
+
+KLong Kotlin_native_internal_GC_getPausePercentile(KRef, KDouble percentile) {
+#if USE_GC
+  return getGCPausePercentile(percentile);
+#else
+  return -1;
+#endif
+}
+
+void Kotlin_native_internal_GC_setStatistics(KRef, KBoolean value) {
+  setGCStatistics(value);
+}
+
+KBoolean Kotlin_native_internal_GC_getStatistics(KRef) {
+  return getGCStatistics();
+}
+
+void Kotlin_native_internal_GC_copyStatistics(KRef, KRef values) {
+  copyGCStatistics(values);
+}
+
+void Kotlin_native_internal_GC_startStatisticsStream(KRef, KRef path) {
+  startGCStatisticsStream(path);
+}
+
+void Kotlin_native_internal_GC_stopStatisticsStream(KRef) {
+  stopGCStatisticsStream();
+}
+
+void Kotlin_native_internal_GC_dumpHeap(KRef, KRef path) {
+  dumpHeap(path);
+}
+
+void VisitGlobalRoot(ObjHeader** location) {
+  if (heapSnapshotWriter != nullptr)
+    heapSnapshotWriter->globalRoot(*location);
+}
+
 KNativePtr CreateStablePointer(KRef any) {
   return createStablePointer(any);
 }
@@ -3093,7 +5349,39 @@ OBJ_GETTER(AdoptStablePointer, KNativePtr pointer) {
 }
 
 bool ClearSubgraphReferences(ObjHeader* root, bool checked) {
-  return clearSubgraphReferences(root, checked);
+  return clearSubgraphReferences(&root, 1, checked);
+}
+
+bool ClearSubgraphsReferences(ObjHeader* const* roots, int32_t count, bool checked) {
+  return clearSubgraphReferences(roots, count, checked);
+}
+
+void* CreateObjectRegion() {
+  return createObjectRegion();
+}
+
+void EnterObjectRegion(void* region, bool allocate) {
+  enterObjectRegion(reinterpret_cast<ObjectRegion*>(region), allocate);
+}
+
+void LeaveObjectRegion(void* region) {
+  leaveObjectRegion(reinterpret_cast<ObjectRegion*>(region));
+}
+
+bool SealObjectRegion(void* region, ObjHeader* root, bool checked) {
+  return sealObjectRegion(reinterpret_cast<ObjectRegion*>(region), root, checked);
+}
+
+OBJ_GETTER(ObjectRegionRoot, void* region) {
+  RETURN_OBJ(*reinterpret_cast<ObjectRegion*>(region)->root);
+}
+
+bool IsInObjectRegion(void* region, const ObjHeader* object) {
+  return isInObjectRegion(reinterpret_cast<ObjectRegion*>(region), object);
+}
+
+bool ReleaseObjectRegion(void* region) {
+  return releaseObjectRegion(reinterpret_cast<ObjectRegion*>(region));
 }
 
 void FreezeSubgraph(ObjHeader* root) {
@@ -3112,6 +5400,13 @@ void EnsureNeverFrozen(ObjHeader* object) {
   ensureNeverFrozen(object);
 }
 
+void AddExternalAllocation(container_size_t size) {
+#if USE_GC
+  auto* state = memoryState;
+  if (state != nullptr) state->allocSinceLastGc += size;
+#endif  // USE_GC
+}
+
 void Kotlin_Any_share(ObjHeader* obj) {
   shareAny(obj);
 }
@@ -3133,8 +5428,9 @@ void ClearTLSRecord(MemoryState* memory, void** key) {
   if (it != tlsMap->end()) {
     KRef* start = it->second.first;
     int count = it->second.second;
+    // ZeroHeapRef() also forgets coalesced writes to the slots being freed.
     for (int i = 0; i < count; i++) {
-      UpdateHeapRef(start + i, nullptr);
+      ZeroHeapRef(start + i);
     }
     konanFreeMemory(start);
     tlsMap->erase(it);
@@ -3194,4 +5490,22 @@ void Kotlin_native_internal_GC_setCyclicCollector(KRef gc, KBoolean value) {
 #endif  // USE_CYCLIC_GC
 }
 
+KInt Kotlin_native_internal_GC_getCyclicCollectorThreads(KRef gc) {
+#if USE_CYCLIC_GC
+  return cyclicThreads();
+#else
+  return 0;
+#endif  // USE_CYCLIC_GC
+}
+
+void Kotlin_native_internal_GC_setCyclicCollectorThreads(KRef gc, KInt value) {
+#if USE_CYCLIC_GC
+  if (value <= 0)
+    ThrowIllegalArgumentException();
+  cyclicSetThreads(value);
+#else
+  ThrowIllegalArgumentException();
+#endif  // USE_CYCLIC_GC
+}
+
 } // extern "C"
@@ -68,7 +68,11 @@ typedef enum {
   CONTAINER_TAG_GC_BUFFERED = 1 << (CONTAINER_TAG_COLOR_SHIFT + 1),
   CONTAINER_TAG_GC_SEEN     = 1 << (CONTAINER_TAG_COLOR_SHIFT + 2),
   // If indeed has more that one object.
-  CONTAINER_TAG_GC_HAS_OBJECT_COUNT = 1 << (CONTAINER_TAG_COLOR_SHIFT + 3)
+  CONTAINER_TAG_GC_HAS_OBJECT_COUNT = 1 << (CONTAINER_TAG_COLOR_SHIFT + 3),
+  // Single object container placed in the nursery, keeps offset in the chunk instead of the size.
+  CONTAINER_TAG_GC_NURSERY = 1 << 30,
+  // Container sizes starting from this one are not stored.
+  CONTAINER_TAG_GC_MAX_SIZE = CONTAINER_TAG_GC_NURSERY >> CONTAINER_TAG_GC_SHIFT
 } ContainerTag;
 
 typedef enum {
@@ -213,11 +217,27 @@ struct ContainerHeader {
 
   inline void setContainerSize(unsigned size) {
     RuntimeAssert((objectCount_ & CONTAINER_TAG_GC_HAS_OBJECT_COUNT) == 0, "Must not have object count");
+    // Too big containers are never recycled, so it is fine to forget their size.
+    if (size >= CONTAINER_TAG_GC_MAX_SIZE) size = 0;
     objectCount_ = (objectCount_ & CONTAINER_TAG_GC_MASK) | (size << CONTAINER_TAG_GC_SHIFT);
   }
 
   inline bool hasContainerSize() {
-    return (objectCount_ & CONTAINER_TAG_GC_HAS_OBJECT_COUNT) == 0;
+    return (objectCount_ & (CONTAINER_TAG_GC_HAS_OBJECT_COUNT | CONTAINER_TAG_GC_NURSERY)) == 0;
+  }
+
+  inline bool nursery() const {
+    return (objectCount_ & (CONTAINER_TAG_GC_HAS_OBJECT_COUNT | CONTAINER_TAG_GC_NURSERY)) == CONTAINER_TAG_GC_NURSERY;
+  }
+
+  inline unsigned nurseryOffset() const {
+    RuntimeAssert(nursery(), "Must be in the nursery");
+    return (objectCount_ & ~CONTAINER_TAG_GC_NURSERY) >> CONTAINER_TAG_GC_SHIFT;
+  }
+
+  inline void setNurseryOffset(unsigned offset) {
+    RuntimeAssert(offset < CONTAINER_TAG_GC_MAX_SIZE, "Offset is too big");
+    objectCount_ = (objectCount_ & CONTAINER_TAG_GC_MASK) | CONTAINER_TAG_GC_NURSERY | (offset << CONTAINER_TAG_GC_SHIFT);
   }
 
   inline unsigned color() const {
@@ -265,6 +285,11 @@ struct ContainerHeader {
     objectCount_ &= ~CONTAINER_TAG_GC_MARKED;
   }
 
+  // Returns false if container is already marked. Safe to call concurrently.
+  inline bool tryMarkAtomically() {
+    return (__sync_fetch_and_or(&objectCount_, CONTAINER_TAG_GC_MARKED) & CONTAINER_TAG_GC_MARKED) == 0;
+  }
+
   inline bool seen() const {
     return (objectCount_ & CONTAINER_TAG_GC_SEEN) != 0;
   }
@@ -329,6 +354,11 @@ struct MetaObjHeader {
     // Strong reference to the counter object.
     ObjHeader* counter_;
   } WeakReference;
+
+  struct {
+    // UTF-16 copy of Latin-1 string, made for the interop, see KString.h.
+    uint16_t* utf16_;
+  } String;
 };
 
 // Header of every object.
@@ -382,6 +412,13 @@ struct ObjHeader {
   static void destroyMetaObject(TypeInfo** location);
 };
 
+// On 64-bit targets the array header has a spare word after the count, strings cache their hash codes there.
+#if __SIZEOF_POINTER__ == 8
+#define KONAN_STRING_HASH_CACHE 1
+#else
+#define KONAN_STRING_HASH_CACHE 0
+#endif
+
 // Header of value type array objects. Keep layout in sync with that of object header.
 struct ArrayHeader {
   TypeInfo* typeInfoOrMeta_;
@@ -395,6 +432,11 @@ struct ArrayHeader {
 
   // Elements count. Element size is stored in instanceSize_ field of TypeInfo, negated.
   uint32_t count_;
+
+#if KONAN_STRING_HASH_CACHE
+  // Hash code of the string, or 0 if not computed yet. Unused for other arrays.
+  int32_t hashCode_;
+#endif
 };
 
 inline bool isPermanentOrFrozen(ObjHeader* obj) {
@@ -512,6 +554,8 @@ MODEL_VARIANTS(void, UpdateHeapRef, ObjHeader** location, const ObjHeader* objec
 MODEL_VARIANTS(void, UpdateHeapRefIfNull, ObjHeader** location, const ObjHeader* object);
 // Updates reference in return slot.
 MODEL_VARIANTS(void, UpdateReturnRef, ObjHeader** returnSlot, const ObjHeader* object);
+// Locked accessors below don't use `cookie` anymore, it is kept as the objects with locked fields have it
+// in their layout.
 // Compares and swaps reference with taken lock.
 OBJ_GETTER(SwapHeapRefLocked,
     ObjHeader** location, ObjHeader* expectedValue, ObjHeader* newValue, int32_t* spinlock,
@@ -519,7 +563,7 @@ OBJ_GETTER(SwapHeapRefLocked,
 // Sets reference with taken lock.
 void SetHeapRefLocked(ObjHeader** location, ObjHeader* newValue, int32_t* spinlock,
     int32_t* cookie) RUNTIME_NOTHROW;
-// Reads reference with taken lock.
+// Reads reference with taken lock, repeated reads of the same value by the same thread don't take the lock.
 OBJ_GETTER(ReadHeapRefLocked, ObjHeader** location, int32_t* spinlock, int32_t* cookie) RUNTIME_NOTHROW;
 // Called on frame enter, if it has object slots.
 MODEL_VARIANTS(void, EnterFrame, ObjHeader** start, int parameters, int count);
@@ -529,6 +573,8 @@ MODEL_VARIANTS(void, LeaveFrame, ObjHeader** start, int parameters, int count);
 // checks if subgraph referenced by given root is disjoint from the rest of
 // object graph, i.e. no external references exists.
 bool ClearSubgraphReferences(ObjHeader* root, bool checked) RUNTIME_NOTHROW;
+// Same as above for multiple roots at once, subgraphs may overlap.
+bool ClearSubgraphsReferences(ObjHeader* const* roots, int32_t count, bool checked) RUNTIME_NOTHROW;
 // Creates stable pointer out of the object.
 void* CreateStablePointer(ObjHeader* obj) RUNTIME_NOTHROW;
 // Disposes stable pointer to the object.
@@ -537,12 +583,35 @@ void DisposeStablePointer(void* pointer) RUNTIME_NOTHROW;
 OBJ_GETTER(DerefStablePointer, void*) RUNTIME_NOTHROW;
 // Move stable pointer ownership.
 OBJ_GETTER(AdoptStablePointer, void*) RUNTIME_NOTHROW;
+// Creates object region, an arena of objects passed between workers and released as a whole.
+void* CreateObjectRegion() RUNTIME_NOTHROW;
+// Counts references to region objects stored by the current thread outside of the region, and if allocate is true,
+// places objects allocated by the current thread into the region.
+void EnterObjectRegion(void* region, bool allocate) RUNTIME_NOTHROW;
+// Restores regions of the current thread active before EnterObjectRegion().
+void LeaveObjectRegion(void* region) RUNTIME_NOTHROW;
+// Makes root the root of the region, and optionally checks that region objects only refer
+// to each other, permanent or frozen objects, and are not referred from outside of the region.
+bool SealObjectRegion(void* region, ObjHeader* root, bool checked) RUNTIME_NOTHROW;
+// Returns root of the sealed region.
+OBJ_GETTER(ObjectRegionRoot, void* region) RUNTIME_NOTHROW;
+// Checks if object is allocated in the region.
+bool IsInObjectRegion(void* region, const ObjHeader* object) RUNTIME_NOTHROW;
+// Releases region along with all its objects, unless they are still referred from outside of the region.
+// Such region is never released, and false is returned.
+bool ReleaseObjectRegion(void* region) RUNTIME_NOTHROW;
 // Check mutability state.
 void MutationCheck(ObjHeader* obj);
 // Freeze object subgraph.
 void FreezeSubgraph(ObjHeader* obj);
 // Ensure this object shall block freezing.
 void EnsureNeverFrozen(ObjHeader* obj);
+// Counts memory allocated outside of the heap for objects of the current thread, such as string buffers,
+// towards the allocation threshold of GC.
+void AddExternalAllocation(container_size_t size) RUNTIME_NOTHROW;
+// Report global reference at location as a root for the heap snapshot being taken,
+// called by the generated code on Kotlin_visitGlobalRoots().
+void VisitGlobalRoot(ObjHeader** location) RUNTIME_NOTHROW;
 // Add TLS object storage, called by the generated code.
 void AddTLSRecord(MemoryState* memory, void** key, int size) RUNTIME_NOTHROW;
 // Clear TLS object storage, called by the generated code.
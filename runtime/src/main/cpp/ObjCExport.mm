@@ -16,6 +16,7 @@
 
 #import "Types.h"
 #import "Memory.h"
+#include "KString.h"
 #include "Natives.h"
 #include "ObjCInterop.h"
 
@@ -143,12 +144,34 @@ extern "C" id Kotlin_ObjCExport_convertUnit(ObjHeader* unitInstance) {
   return instance;
 }
 
+static id associateNSString(ObjHeader* str, NSString* candidate) {
+  if (!str->container()->shareable()) {
+    SetAssociatedObject(str, candidate);
+  } else {
+    id old = AtomicCompareAndSwapAssociatedObject(str, nullptr, candidate);
+    if (old != nullptr) {
+      objc_release(candidate);
+      return objc_retainAutoreleaseReturnValue(old);
+    }
+  }
+
+  return objc_retainAutoreleaseReturnValue(candidate);
+}
+
 extern "C" id Kotlin_ObjCExport_CreateNSStringFromKString(ObjHeader* str) {
-  KChar* utf16Chars = CharArrayAddressOfElementAt(str->array(), 0);
-  auto numBytes = str->array()->count_ * sizeof(KChar);
+  if (IsLatin1String(str->array())) {
+    // Latin-1 strings are created in runtime, so never permanent.
+    NSString* candidate = [[NSString alloc] initWithBytes:Latin1StringAddressOfElementAt(str->array(), 0)
+      length:StringLength(str->array())
+      encoding:NSISOLatin1StringEncoding];
+    return associateNSString(str, candidate);
+  }
+
+  const KChar* utf16Chars = Utf16StringAddressOfElementAt(str->array(), 0);
+  auto numBytes = StringLength(str->array()) * sizeof(KChar);
 
   if (str->permanent()) {
-    return [[[NSString alloc] initWithBytesNoCopy:utf16Chars
+    return [[[NSString alloc] initWithBytesNoCopy:const_cast<KChar*>(utf16Chars)
         length:numBytes
         encoding:NSUTF16LittleEndianStringEncoding
         freeWhenDone:NO] autorelease];
@@ -157,18 +180,7 @@ extern "C" id Kotlin_ObjCExport_CreateNSStringFromKString(ObjHeader* str) {
     NSString* candidate = [[NSString alloc] initWithBytes:utf16Chars
       length:numBytes
       encoding:NSUTF16LittleEndianStringEncoding];
-
-    if (!str->container()->shareable()) {
-      SetAssociatedObject(str, candidate);
-    } else {
-      id old = AtomicCompareAndSwapAssociatedObject(str, nullptr, candidate);
-      if (old != nullptr) {
-        objc_release(candidate);
-        return objc_retainAutoreleaseReturnValue(old);
-      }
-    }
-
-    return objc_retainAutoreleaseReturnValue(candidate);
+    return associateNSString(str, candidate);
   }
 }
 static const ObjCTypeAdapter* findAdapterByName(
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include "Parking.h"
+
+#include "Alloc.h"
+#include "Atomic.h"
+#include "KAssert.h"
+
+#ifndef KONAN_NO_THREADS
+#if KONAN_LINUX || KONAN_ANDROID
+#define USE_FUTEX 1
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define USE_FUTEX 0
+#include <pthread.h>
+#endif
+#endif  // KONAN_NO_THREADS
+
+namespace {
+
+// Lock word states.
+constexpr int32_t kUnlocked = 0;
+constexpr int32_t kLocked = 1;
+// Locked, and there may be parked threads.
+constexpr int32_t kContended = 2;
+
+#if !defined(KONAN_NO_THREADS) && !USE_FUTEX
+
+// Without futex, threads park on one of the condition variables selected by the address.
+constexpr int kBuckets = 64;
+
+struct Bucket {
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+};
+
+Bucket* buckets() {
+  static Bucket* result = nullptr;
+  if (result != nullptr) return result;
+  Bucket* created = konanAllocArray<Bucket>(kBuckets);
+  for (int index = 0; index < kBuckets; index++) {
+    pthread_mutex_init(&created[index].lock, nullptr);
+    pthread_cond_init(&created[index].cond, nullptr);
+  }
+  Bucket* old = __sync_val_compare_and_swap(&result, nullptr, created);
+  if (old != nullptr) {
+    for (int index = 0; index < kBuckets; index++) {
+      pthread_mutex_destroy(&created[index].lock);
+      pthread_cond_destroy(&created[index].cond);
+    }
+    konanFreeMemory(created);
+    return old;
+  }
+  return created;
+}
+
+Bucket* bucketFor(volatile int32_t* address) {
+  auto value = reinterpret_cast<uintptr_t>(address);
+  return buckets() + (((value >> 2) ^ (value >> 8)) % kBuckets);
+}
+
+#endif  // !KONAN_NO_THREADS && !USE_FUTEX
+
+}  // namespace
+
+void ParkWait(volatile int32_t* address, int32_t expected) {
+#ifndef KONAN_NO_THREADS
+#if USE_FUTEX
+  syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+  Bucket* bucket = bucketFor(address);
+  pthread_mutex_lock(&bucket->lock);
+  // Waker takes the same lock, so it cannot wake between the check and the wait.
+  if (atomicGet(address) == expected)
+    pthread_cond_wait(&bucket->cond, &bucket->lock);
+  pthread_mutex_unlock(&bucket->lock);
+#endif  // USE_FUTEX
+#endif  // KONAN_NO_THREADS
+}
+
+void ParkWake(volatile int32_t* address, bool all) {
+#ifndef KONAN_NO_THREADS
+#if USE_FUTEX
+  syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, all ? INT32_MAX : 1, nullptr, nullptr, 0);
+#else
+  Bucket* bucket = bucketFor(address);
+  pthread_mutex_lock(&bucket->lock);
+  // Bucket is shared by the different addresses, so waking a single thread may wake the wrong one.
+  pthread_cond_broadcast(&bucket->cond);
+  pthread_mutex_unlock(&bucket->lock);
+#endif  // USE_FUTEX
+#endif  // KONAN_NO_THREADS
+}
+
+// See "Futexes Are Tricky" by Ulrich Drepper, mutex #3.
+void ParkingLock(volatile int32_t* address) {
+  int32_t state = compareAndSwap(address, kUnlocked, kLocked);
+  if (state == kUnlocked) return;
+  SpinBackoff backoff;
+  while (state == kLocked && backoff.spin()) {
+    state = atomicGet(address);
+    if (state == kUnlocked) {
+      state = compareAndSwap(address, kUnlocked, kLocked);
+      if (state == kUnlocked) return;
+    }
+  }
+  // Mark lock as contended, so that the owner wakes us up on unlock.
+  if (state != kContended) state = __sync_lock_test_and_set(address, kContended);
+  while (state != kUnlocked) {
+    ParkWait(address, kContended);
+    state = __sync_lock_test_and_set(address, kContended);
+  }
+}
+
+void ParkingUnlock(volatile int32_t* address) {
+  int32_t state = atomicAdd(address, -1);
+  RuntimeAssert(state == kUnlocked || state == kLocked, "Lock must be taken");
+  if (state != kUnlocked) {
+    atomicSet(address, kUnlocked);
+    ParkWake(address, false);
+  }
+}
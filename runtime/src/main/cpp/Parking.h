@@ -0,0 +1,50 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_PARKING_H
+#define RUNTIME_PARKING_H
+
+#include <cstdint>
+
+#include "Common.h"
+
+// Hints the CPU that the caller is busy-waiting.
+ALWAYS_INLINE inline void SpinPause() {
+#if defined(__x86_64__) || defined(__i386__)
+  __asm__ __volatile__("pause");
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+// Exponential backoff for the spin loops: every round spins twice as long as the previous one.
+class SpinBackoff {
+ public:
+  // Returns false once spinning is not worth it anymore, so the caller shall park or yield.
+  bool spin() {
+    if (round_ >= kRounds) return false;
+    for (int i = 0; i < (1 << round_); i++) SpinPause();
+    round_++;
+    return true;
+  }
+
+ private:
+  static constexpr int kRounds = 8;
+  int round_ = 0;
+};
+
+// Blocks the calling thread while *address == expected, until ParkWake() is called for the same address.
+// Spurious wakeups are possible, so callers must recheck their condition.
+// Uses futex on Linux and hashed condition variables elsewhere.
+void ParkWait(volatile int32_t* address, int32_t expected);
+// Wakes either one or all threads blocked in ParkWait() on the address.
+void ParkWake(volatile int32_t* address, bool all);
+
+// Lock on a single int32_t word, which is 0 when unlocked. Spins with backoff while lock is
+// contended for a short time, and then parks the thread until the lock is released.
+void ParkingLock(volatile int32_t* address);
+void ParkingUnlock(volatile int32_t* address);
+
+#endif  // RUNTIME_PARKING_H
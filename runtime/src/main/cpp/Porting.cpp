@@ -17,6 +17,7 @@
 #ifdef KONAN_ANDROID
 #include <android/log.h>
 #endif
+#include <limits.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -26,6 +27,10 @@
 #include <pthread.h>
 #endif
 #include <unistd.h>
+#if !KONAN_WASM && !KONAN_ZEPHYR
+#include <errno.h>
+#include <fcntl.h>
+#endif
 #if KONAN_WINDOWS
 #include <windows.h>
 #endif
@@ -99,6 +104,48 @@ int32_t consoleReadUtf8(void* utf8, uint32_t maxSizeBytes) {
 #endif
 }
 
+// File output operations.
+int32_t fileOpenForAppend(const char* path) {
+#if KONAN_WASM || KONAN_ZEPHYR
+  return -1;
+#else
+  return ::open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+}
+
+int32_t fileOpenForWrite(const char* path) {
+#if KONAN_WASM || KONAN_ZEPHYR
+  return -1;
+#else
+  return ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+bool fileWrite(int32_t file, const void* data, uint32_t sizeBytes) {
+#if KONAN_WASM || KONAN_ZEPHYR
+  return false;
+#else
+  const char* current = reinterpret_cast<const char*>(data);
+  while (sizeBytes > 0) {
+    auto written = ::write(file, current, sizeBytes);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    // Short writes are possible, for example, when a signal interrupts the write.
+    current += written;
+    sizeBytes -= static_cast<uint32_t>(written);
+  }
+  return true;
+#endif
+}
+
+void fileClose(int32_t file) {
+#if !KONAN_WASM && !KONAN_ZEPHYR
+  ::close(file);
+#endif
+}
+
 #if KONAN_INTERNAL_SNPRINTF
 extern "C" int rpl_vsnprintf(char *, size_t, const char *, va_list);
 #define vsnprintf_impl rpl_vsnprintf
@@ -191,6 +238,48 @@ void onThreadExit(void (*destructor)(void*), void* destructorParameter) {
 #endif  // !KONAN_NO_THREADS
 }
 
+// System information.
+int32_t availableProcessors() {
+#if KONAN_WINDOWS
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwNumberOfProcessors < 1 ? 1 : static_cast<int32_t>(info.dwNumberOfProcessors);
+#elif KONAN_WASM || KONAN_ZEPHYR
+  return 1;
+#else
+  long result = ::sysconf(_SC_NPROCESSORS_ONLN);
+  return result < 1 ? 1 : static_cast<int32_t>(result);
+#endif
+}
+
+size_t pageSize() {
+#if KONAN_WINDOWS
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwPageSize;
+#elif KONAN_WASM
+  return 65536;
+#elif KONAN_ZEPHYR
+  return 4096;
+#else
+  long result = ::sysconf(_SC_PAGESIZE);
+  return result < 1 ? 4096 : static_cast<size_t>(result);
+#endif
+}
+
+size_t minThreadStackSize() {
+#if KONAN_WINDOWS
+  // Thread stacks are reserved with the allocation granularity.
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+#elif defined(PTHREAD_STACK_MIN)
+  return PTHREAD_STACK_MIN;
+#else
+  return 16384;
+#endif
+}
+
 // Process execution.
 void abort(void) {
   ::abort();
@@ -33,6 +33,14 @@ void consoleErrorUtf8(const void* utf8, uint32_t sizeBytes);
 // Negative return value denotes that read wasn't successful.
 int32_t consoleReadUtf8(void* utf8, uint32_t maxSizeBytes);
 
+// File output operations, used for diagnostics.
+// Negative return value denotes that file cannot be opened.
+int32_t fileOpenForAppend(const char* path);
+int32_t fileOpenForWrite(const char* path);
+// Writes all the data, returns false if it cannot be done.
+bool fileWrite(int32_t file, const void* data, uint32_t sizeBytes);
+void fileClose(int32_t file);
+
 // Process control.
 RUNTIME_NORETURN void abort(void);
 RUNTIME_NORETURN void exit(int32_t status);
@@ -79,6 +87,14 @@ void* calloc(size_t count, size_t size);
 void* calloc_aligned(size_t count, size_t size, size_t alignment);
 void free(void* ptr);
 
+// System information.
+// Number of processors available to the process, at least one.
+int32_t availableProcessors();
+// Size of the virtual memory page in bytes.
+size_t pageSize();
+// Smallest stack size in bytes a new thread may be created with.
+size_t minThreadStackSize();
+
 // Time operations.
 uint64_t getTimeMillis();
 uint64_t getTimeMicros();
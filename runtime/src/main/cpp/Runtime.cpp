@@ -45,7 +45,8 @@ enum {
   INIT_GLOBALS = 0,
   INIT_THREAD_LOCAL_GLOBALS = 1,
   DEINIT_THREAD_LOCAL_GLOBALS = 2,
-  DEINIT_GLOBALS = 3
+  DEINIT_GLOBALS = 3,
+  VISIT_GLOBALS = 4
 };
 
 enum {
@@ -194,6 +195,14 @@ bool Kotlin_hasRuntime() {
   return isValidRuntime();
 }
 
+void Kotlin_visitGlobalRoots() {
+  InitOrDeinitGlobalVariables(VISIT_GLOBALS, ::runtimeState->memoryState);
+}
+
+bool Kotlin_isMainThread() {
+  return isMainThread != 0;
+}
+
 void CheckIsMainThread() {
   if (!isMainThread)
     ThrowIncorrectDereferenceException();
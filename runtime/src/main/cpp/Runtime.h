@@ -50,6 +50,11 @@ bool Kotlin_hasRuntime();
 // Appends given node to an initializer list.
 void AppendToInitializersTail(struct InitNode*);
 
+// Calls VisitGlobalRoot() for all the global references, except thread local ones.
+void Kotlin_visitGlobalRoots();
+
+bool Kotlin_isMainThread();
+
 // Zero out all Kotlin thread local globals.
 void Kotlin_zeroOutTLSGlobals();
 
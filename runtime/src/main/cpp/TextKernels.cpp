@@ -0,0 +1,291 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define KONAN_TEXT_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KONAN_TEXT_NEON 1
+#endif
+
+#include "TextKernels.h"
+
+namespace {
+
+inline KChar toLowerAscii(KChar ch) {
+  return ch >= 'A' && ch <= 'Z' ? ch + ('a' - 'A') : ch;
+}
+
+#if KONAN_TEXT_SSE2 || KONAN_TEXT_NEON
+#define KONAN_TEXT_SIMD 1
+
+// Characters of both representations are processed in 16-bit lanes, eight at a time.
+constexpr size_t kLanes = 8;
+// Lane masks have a bit per lane.
+constexpr unsigned kAllLanes = 0xff;
+
+#if KONAN_TEXT_SSE2
+typedef __m128i Chars;
+
+inline Chars load(const KChar* chars) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars));
+}
+
+inline Chars load(const uint8_t* chars) {
+  return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(chars)), _mm_setzero_si128());
+}
+
+inline void store(KChar* to, Chars chars) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(to), chars);
+}
+
+// All lanes must be below 0x100.
+inline void store(uint8_t* to, Chars chars) {
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(to), _mm_packus_epi16(chars, chars));
+}
+
+inline Chars splat(KChar ch) {
+  return _mm_set1_epi16(static_cast<int16_t>(ch));
+}
+
+inline unsigned equalLanes(Chars first, Chars second) {
+  return _mm_movemask_epi8(_mm_packs_epi16(_mm_cmpeq_epi16(first, second), _mm_setzero_si128()));
+}
+
+inline bool isAscii(Chars chars) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, splat(0xff80)), _mm_setzero_si128())) == 0xffff;
+}
+
+// Bounds are ASCII, so signed comparison is fine, as the lanes above U+7FFF are negative.
+inline Chars inRange(Chars chars, KChar low, KChar high) {
+  return _mm_and_si128(_mm_cmpgt_epi16(chars, splat(low - 1)), _mm_cmplt_epi16(chars, splat(high + 1)));
+}
+
+inline Chars toggleCase(Chars chars, KChar low, KChar high) {
+  return _mm_xor_si128(chars, _mm_and_si128(inRange(chars, low, high), splat('a' - 'A')));
+}
+#else  // KONAN_TEXT_NEON
+typedef uint16x8_t Chars;
+
+inline Chars load(const KChar* chars) {
+  return vld1q_u16(chars);
+}
+
+inline Chars load(const uint8_t* chars) {
+  return vmovl_u8(vld1_u8(chars));
+}
+
+inline void store(KChar* to, Chars chars) {
+  vst1q_u16(to, chars);
+}
+
+// All lanes must be below 0x100.
+inline void store(uint8_t* to, Chars chars) {
+  vst1_u8(to, vmovn_u16(chars));
+}
+
+inline Chars splat(KChar ch) {
+  return vdupq_n_u16(ch);
+}
+
+inline unsigned equalLanes(Chars first, Chars second) {
+  static const uint16_t kLaneBits[kLanes] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+  return vaddvq_u16(vandq_u16(vceqq_u16(first, second), vld1q_u16(kLaneBits)));
+}
+
+inline bool isAscii(Chars chars) {
+  return vmaxvq_u16(chars) < 0x80;
+}
+
+inline Chars inRange(Chars chars, KChar low, KChar high) {
+  return vandq_u16(vcgeq_u16(chars, splat(low)), vcleq_u16(chars, splat(high)));
+}
+
+inline Chars toggleCase(Chars chars, KChar low, KChar high) {
+  return veorq_u16(chars, vandq_u16(inRange(chars, low, high), splat('a' - 'A')));
+}
+#endif
+
+inline Chars toLowerAscii(Chars chars) {
+  return toggleCase(chars, 'A', 'Z');
+}
+#endif  // KONAN_TEXT_SSE2 || KONAN_TEXT_NEON
+
+template <bool ignoreAsciiCase, typename T1, typename T2>
+size_t mismatch(const T1* first, const T2* second, size_t count) {
+  size_t index = 0;
+#if KONAN_TEXT_SIMD
+  for (; index + kLanes <= count; index += kLanes) {
+    Chars firstChars = load(first + index);
+    Chars secondChars = load(second + index);
+    if (ignoreAsciiCase) {
+      firstChars = toLowerAscii(firstChars);
+      secondChars = toLowerAscii(secondChars);
+    }
+    unsigned equal = equalLanes(firstChars, secondChars);
+    if (equal != kAllLanes) return index + __builtin_ctz(~equal);
+  }
+#endif
+  for (; index < count; index++) {
+    KChar firstChar = first[index];
+    KChar secondChar = second[index];
+    if (ignoreAsciiCase) {
+      firstChar = toLowerAscii(firstChar);
+      secondChar = toLowerAscii(secondChar);
+    }
+    if (firstChar != secondChar) break;
+  }
+  return index;
+}
+
+template <typename T>
+const T* findChar(const T* start, const T* end, KChar ch) {
+  const T* current = start;
+#if KONAN_TEXT_SIMD
+  Chars pattern = splat(ch);
+  for (; end - current >= static_cast<ptrdiff_t>(kLanes); current += kLanes) {
+    unsigned equal = equalLanes(load(current), pattern);
+    if (equal != 0) return current + __builtin_ctz(equal);
+  }
+#endif
+  for (; current < end; current++) {
+    if (*current == ch) return current;
+  }
+  return nullptr;
+}
+
+template <typename T>
+const T* findLastChar(const T* start, const T* end, KChar ch) {
+  const T* current = end;
+#if KONAN_TEXT_SIMD
+  Chars pattern = splat(ch);
+  while (current - start >= static_cast<ptrdiff_t>(kLanes)) {
+    current -= kLanes;
+    unsigned equal = equalLanes(load(current), pattern);
+    if (equal != 0) return current + (31 - __builtin_clz(equal));
+  }
+#endif
+  while (current > start) {
+    if (*--current == ch) return current;
+  }
+  return nullptr;
+}
+
+// Candidates are filtered by both the first and the last character of the sequence, so that
+// periodic texts do not cause false positives on every position.
+template <typename T>
+const T* findChars(const T* start, const T* end, const T* chars, size_t count) {
+  if (count == 1) return FindChar(start, end, chars[0]);
+  if (end - start < static_cast<ptrdiff_t>(count)) return nullptr;
+  const T* last = end - count;
+  const T* current = start;
+#if KONAN_TEXT_SIMD
+  Chars firstPattern = splat(chars[0]);
+  Chars lastPattern = splat(chars[count - 1]);
+  for (; last - current >= static_cast<ptrdiff_t>(kLanes) - 1; current += kLanes) {
+    unsigned candidates =
+        equalLanes(load(current), firstPattern) & equalLanes(load(current + count - 1), lastPattern);
+    while (candidates != 0) {
+      int lane = __builtin_ctz(candidates);
+      if (memcmp(current + lane + 1, chars + 1, (count - 2) * sizeof(T)) == 0) return current + lane;
+      candidates &= candidates - 1;
+    }
+  }
+#endif
+  for (; current <= last; current++) {
+    if (*current == chars[0] && memcmp(current + 1, chars + 1, (count - 1) * sizeof(T)) == 0) return current;
+  }
+  return nullptr;
+}
+
+template <typename T>
+size_t convertAsciiCase(const T* from, T* to, size_t count, bool toUpper) {
+  KChar low = toUpper ? 'a' : 'A';
+  KChar high = toUpper ? 'z' : 'Z';
+  size_t index = 0;
+#if KONAN_TEXT_SIMD
+  for (; index + kLanes <= count; index += kLanes) {
+    Chars chars = load(from + index);
+    if (!isAscii(chars)) break;
+    store(to + index, toggleCase(chars, low, high));
+  }
+#endif
+  for (; index < count && from[index] < 0x80; index++) {
+    KChar ch = from[index];
+    to[index] = ch >= low && ch <= high ? ch ^ ('a' - 'A') : ch;
+  }
+  return index;
+}
+
+}  // namespace
+
+size_t MismatchChars(const uint8_t* first, const uint8_t* second, size_t count) {
+  return mismatch<false>(first, second, count);
+}
+
+size_t MismatchChars(const KChar* first, const KChar* second, size_t count) {
+  return mismatch<false>(first, second, count);
+}
+
+size_t MismatchChars(const uint8_t* first, const KChar* second, size_t count) {
+  return mismatch<false>(first, second, count);
+}
+
+size_t MismatchChars(const KChar* first, const uint8_t* second, size_t count) {
+  return mismatch<false>(second, first, count);
+}
+
+size_t MismatchCharsIgnoreAsciiCase(const uint8_t* first, const uint8_t* second, size_t count) {
+  return mismatch<true>(first, second, count);
+}
+
+size_t MismatchCharsIgnoreAsciiCase(const KChar* first, const KChar* second, size_t count) {
+  return mismatch<true>(first, second, count);
+}
+
+size_t MismatchCharsIgnoreAsciiCase(const uint8_t* first, const KChar* second, size_t count) {
+  return mismatch<true>(first, second, count);
+}
+
+size_t MismatchCharsIgnoreAsciiCase(const KChar* first, const uint8_t* second, size_t count) {
+  return mismatch<true>(second, first, count);
+}
+
+const uint8_t* FindChar(const uint8_t* start, const uint8_t* end, KChar ch) {
+  if (ch > 0xff) return nullptr;
+  return static_cast<const uint8_t*>(memchr(start, ch, end - start));
+}
+
+const KChar* FindChar(const KChar* start, const KChar* end, KChar ch) {
+  return findChar(start, end, ch);
+}
+
+const uint8_t* FindLastChar(const uint8_t* start, const uint8_t* end, KChar ch) {
+  if (ch > 0xff) return nullptr;
+  return findLastChar(start, end, ch);
+}
+
+const KChar* FindLastChar(const KChar* start, const KChar* end, KChar ch) {
+  return findLastChar(start, end, ch);
+}
+
+const uint8_t* FindChars(const uint8_t* start, const uint8_t* end, const uint8_t* chars, size_t count) {
+  return findChars(start, end, chars, count);
+}
+
+const KChar* FindChars(const KChar* start, const KChar* end, const KChar* chars, size_t count) {
+  return findChars(start, end, chars, count);
+}
+
+size_t ConvertAsciiCase(const uint8_t* from, uint8_t* to, size_t count, bool toUpper) {
+  return convertAsciiCase(from, to, count, toUpper);
+}
+
+size_t ConvertAsciiCase(const KChar* from, KChar* to, size_t count, bool toUpper) {
+  return convertAsciiCase(from, to, count, toUpper);
+}
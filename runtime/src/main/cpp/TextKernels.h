@@ -0,0 +1,43 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_TEXT_KERNELS_H
+#define RUNTIME_TEXT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Types.h"
+
+// Search, comparison and case conversion over characters of strings, uint8_t for Latin-1 and KChar
+// for UTF-16. Vectorized with SSE2 or NEON when available, and scalar otherwise.
+
+// Index of the first mismatching character, or count if there is none.
+size_t MismatchChars(const uint8_t* first, const uint8_t* second, size_t count);
+size_t MismatchChars(const KChar* first, const KChar* second, size_t count);
+size_t MismatchChars(const uint8_t* first, const KChar* second, size_t count);
+size_t MismatchChars(const KChar* first, const uint8_t* second, size_t count);
+
+// Same as above, but ASCII letters of different case are considered equal.
+size_t MismatchCharsIgnoreAsciiCase(const uint8_t* first, const uint8_t* second, size_t count);
+size_t MismatchCharsIgnoreAsciiCase(const KChar* first, const KChar* second, size_t count);
+size_t MismatchCharsIgnoreAsciiCase(const uint8_t* first, const KChar* second, size_t count);
+size_t MismatchCharsIgnoreAsciiCase(const KChar* first, const uint8_t* second, size_t count);
+
+// First and last occurrences of the character, or nullptr.
+const uint8_t* FindChar(const uint8_t* start, const uint8_t* end, KChar ch);
+const KChar* FindChar(const KChar* start, const KChar* end, KChar ch);
+const uint8_t* FindLastChar(const uint8_t* start, const uint8_t* end, KChar ch);
+const KChar* FindLastChar(const KChar* start, const KChar* end, KChar ch);
+
+// First occurrence of non-empty sequence of characters, or nullptr.
+const uint8_t* FindChars(const uint8_t* start, const uint8_t* end, const uint8_t* chars, size_t count);
+const KChar* FindChars(const KChar* start, const KChar* end, const KChar* chars, size_t count);
+
+// Converts case of the leading ASCII characters, returns the number of converted ones.
+size_t ConvertAsciiCase(const uint8_t* from, uint8_t* to, size_t count, bool toUpper);
+size_t ConvertAsciiCase(const KChar* from, KChar* to, size_t count, bool toUpper);
+
+#endif  // RUNTIME_TEXT_KERNELS_H
@@ -0,0 +1,306 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define KONAN_TEXT_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define KONAN_TEXT_NEON 1
+#endif
+
+#include "Transcoding.h"
+
+namespace {
+
+constexpr KChar kReplacementChar = 0xfffd;
+
+// Number of leading bytes below 0x80.
+size_t asciiLength(const uint8_t* start, const uint8_t* end) {
+  const uint8_t* current = start;
+#if KONAN_TEXT_SSE2
+  while (end - current >= 16) {
+    int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current)));
+    if (mask != 0) return current - start + __builtin_ctz(mask);
+    current += 16;
+  }
+#elif KONAN_TEXT_NEON
+  while (end - current >= 16 && vmaxvq_u8(vld1q_u8(current)) < 0x80) {
+    current += 16;
+  }
+#else
+  while (end - current >= 8) {
+    uint64_t word;
+    memcpy(&word, current, sizeof(word));
+    if ((word & 0x8080808080808080ULL) != 0) break;
+    current += 8;
+  }
+#endif
+  while (current < end && *current < 0x80) current++;
+  return current - start;
+}
+
+// Number of leading code units having no bits of the mask set.
+size_t utf16Length(const KChar* start, const KChar* end, KChar mask) {
+  const KChar* current = start;
+#if KONAN_TEXT_SSE2
+  const __m128i maskVector = _mm_set1_epi16(mask);
+  const __m128i zero = _mm_setzero_si128();
+  while (end - current >= 8) {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, maskVector), zero)) != 0xffff) break;
+    current += 8;
+  }
+#elif KONAN_TEXT_NEON
+  const uint16x8_t maskVector = vdupq_n_u16(mask);
+  while (end - current >= 8 && vmaxvq_u16(vandq_u16(vld1q_u16(current), maskVector)) == 0) {
+    current += 8;
+  }
+#endif
+  while (current < end && (*current & mask) == 0) current++;
+  return current - start;
+}
+
+// Number of leading code units below U+0080.
+inline size_t utf16AsciiLength(const KChar* start, const KChar* end) {
+  return utf16Length(start, end, 0xff80);
+}
+
+void widen(const uint8_t* start, size_t count, KChar* result) {
+  size_t index = 0;
+#if KONAN_TEXT_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; index + 16 <= count; index += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(start + index));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + index), _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + index + 8), _mm_unpackhi_epi8(bytes, zero));
+  }
+#elif KONAN_TEXT_NEON
+  for (; index + 16 <= count; index += 16) {
+    uint8x16_t bytes = vld1q_u8(start + index);
+    vst1q_u16(result + index, vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(result + index + 8, vmovl_high_u8(bytes));
+  }
+#endif
+  for (; index < count; index++) result[index] = start[index];
+}
+
+// All code units must be below U+0100.
+void narrow(const KChar* start, size_t count, uint8_t* result) {
+  size_t index = 0;
+#if KONAN_TEXT_SSE2
+  for (; index + 16 <= count; index += 16) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(start + index));
+    __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(start + index + 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result + index), _mm_packus_epi16(low, high));
+  }
+#elif KONAN_TEXT_NEON
+  for (; index + 16 <= count; index += 16) {
+    uint8x8_t low = vmovn_u16(vld1q_u16(start + index));
+    uint8x8_t high = vmovn_u16(vld1q_u16(start + index + 8));
+    vst1q_u8(result + index, vcombine_u8(low, high));
+  }
+#endif
+  for (; index < count; index++) result[index] = static_cast<uint8_t>(start[index]);
+}
+
+inline bool isContinuation(uint8_t byte) {
+  return (byte & 0xc0) == 0x80;
+}
+
+inline bool isLeadSurrogate(KChar ch) {
+  return (ch & 0xfc00) == 0xd800;
+}
+
+inline bool isTrailSurrogate(KChar ch) {
+  return (ch & 0xfc00) == 0xdc00;
+}
+
+// Size of well-formed sequence at the start, or 0 for ill-formed one.
+int sequenceSize(const uint8_t* start, const uint8_t* end) {
+  uint8_t lead = start[0];
+  // Continuation bytes and overlong 2-byte forms.
+  if (lead < 0xc2) return 0;
+  if (lead < 0xe0) {
+    return end - start >= 2 && isContinuation(start[1]) ? 2 : 0;
+  }
+  if (lead < 0xf0) {
+    if (end - start < 3 || !isContinuation(start[1]) || !isContinuation(start[2])) return 0;
+    // Overlong forms and surrogates.
+    if (lead == 0xe0 && start[1] < 0xa0) return 0;
+    if (lead == 0xed && start[1] >= 0xa0) return 0;
+    return 3;
+  }
+  if (lead < 0xf5) {
+    if (end - start < 4 || !isContinuation(start[1]) || !isContinuation(start[2]) || !isContinuation(start[3]))
+      return 0;
+    // Overlong forms and code points above U+10FFFF.
+    if (lead == 0xf0 && start[1] < 0x90) return 0;
+    if (lead == 0xf4 && start[1] >= 0x90) return 0;
+    return 4;
+  }
+  return 0;
+}
+
+inline uint8_t* appendUtf8(uint32_t codePoint, uint8_t* result) {
+  if (codePoint < 0x80) {
+    *result++ = codePoint;
+  } else if (codePoint < 0x800) {
+    *result++ = 0xc0 | (codePoint >> 6);
+    *result++ = 0x80 | (codePoint & 0x3f);
+  } else if (codePoint < 0x10000) {
+    *result++ = 0xe0 | (codePoint >> 12);
+    *result++ = 0x80 | ((codePoint >> 6) & 0x3f);
+    *result++ = 0x80 | (codePoint & 0x3f);
+  } else {
+    *result++ = 0xf0 | (codePoint >> 18);
+    *result++ = 0x80 | ((codePoint >> 12) & 0x3f);
+    *result++ = 0x80 | ((codePoint >> 6) & 0x3f);
+    *result++ = 0x80 | (codePoint & 0x3f);
+  }
+  return result;
+}
+
+}  // namespace
+
+Utf8Scan ScanUtf8(const uint8_t* start, const uint8_t* end) {
+  Utf8Scan result = { true, true, 0 };
+  const uint8_t* current = start;
+  while (current < end) {
+    size_t ascii = asciiLength(current, end);
+    current += ascii;
+    result.utf16Length += ascii;
+    if (current == end) break;
+    int size = sequenceSize(current, end);
+    if (size == 0) {
+      result.wellFormed = false;
+      return result;
+    }
+    result.latin1 = result.latin1 && size == 2 && *current <= 0xc3;
+    result.utf16Length += size == 4 ? 2 : 1;
+    current += size;
+  }
+  return result;
+}
+
+void DecodeUtf8ToUtf16(const uint8_t* start, const uint8_t* end, KChar* result) {
+  const uint8_t* current = start;
+  while (current < end) {
+    size_t ascii = asciiLength(current, end);
+    widen(current, ascii, result);
+    current += ascii;
+    result += ascii;
+    if (current == end) break;
+    uint8_t lead = *current;
+    if (lead < 0xe0) {
+      *result++ = ((lead & 0x1f) << 6) | (current[1] & 0x3f);
+      current += 2;
+    } else if (lead < 0xf0) {
+      *result++ = ((lead & 0x0f) << 12) | ((current[1] & 0x3f) << 6) | (current[2] & 0x3f);
+      current += 3;
+    } else {
+      uint32_t codePoint = ((lead & 0x07) << 18) | ((current[1] & 0x3f) << 12) |
+          ((current[2] & 0x3f) << 6) | (current[3] & 0x3f);
+      *result++ = 0xd7c0 + (codePoint >> 10);
+      *result++ = 0xdc00 | (codePoint & 0x3ff);
+      current += 4;
+    }
+  }
+}
+
+void DecodeUtf8ToLatin1(const uint8_t* start, const uint8_t* end, uint8_t* result) {
+  const uint8_t* current = start;
+  while (current < end) {
+    size_t ascii = asciiLength(current, end);
+    memcpy(result, current, ascii);
+    current += ascii;
+    result += ascii;
+    if (current == end) break;
+    *result++ = ((current[0] & 0x1f) << 6) | (current[1] & 0x3f);
+    current += 2;
+  }
+}
+
+uint32_t Utf16Utf8Length(const KChar* start, const KChar* end, bool* wellFormed) {
+  uint32_t result = 0;
+  *wellFormed = true;
+  const KChar* current = start;
+  while (current < end) {
+    size_t ascii = utf16AsciiLength(current, end);
+    current += ascii;
+    result += ascii;
+    if (current == end) break;
+    KChar ch = *current++;
+    if (ch < 0x800) {
+      result += 2;
+    } else if (isLeadSurrogate(ch) && current < end && isTrailSurrogate(*current)) {
+      current++;
+      result += 4;
+    } else {
+      if (isLeadSurrogate(ch) || isTrailSurrogate(ch)) *wellFormed = false;
+      result += 3;
+    }
+  }
+  return result;
+}
+
+uint8_t* EncodeUtf16ToUtf8(const KChar* start, const KChar* end, uint8_t* result) {
+  const KChar* current = start;
+  while (current < end) {
+    size_t ascii = utf16AsciiLength(current, end);
+    narrow(current, ascii, result);
+    current += ascii;
+    result += ascii;
+    if (current == end) break;
+    uint32_t codePoint = *current++;
+    if (isLeadSurrogate(codePoint) && current < end && isTrailSurrogate(*current)) {
+      codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (*current++ - 0xdc00);
+    } else if (isLeadSurrogate(codePoint) || isTrailSurrogate(codePoint)) {
+      codePoint = kReplacementChar;
+    }
+    result = appendUtf8(codePoint, result);
+  }
+  return result;
+}
+
+uint32_t Latin1Utf8Length(const uint8_t* start, const uint8_t* end) {
+  uint32_t result = end - start;
+  const uint8_t* current = start;
+  while (current < end) {
+    current += asciiLength(current, end);
+    if (current == end) break;
+    // Non-ASCII character takes two bytes.
+    result++;
+    current++;
+  }
+  return result;
+}
+
+uint8_t* EncodeLatin1ToUtf8(const uint8_t* start, const uint8_t* end, uint8_t* result) {
+  const uint8_t* current = start;
+  while (current < end) {
+    size_t ascii = asciiLength(current, end);
+    memcpy(result, current, ascii);
+    current += ascii;
+    result += ascii;
+    if (current == end) break;
+    result = appendUtf8(*current++, result);
+  }
+  return result;
+}
+
+bool Utf16FitsLatin1(const KChar* start, const KChar* end) {
+  return utf16Length(start, end, 0xff00) == static_cast<size_t>(end - start);
+}
+
+void NarrowUtf16ToLatin1(const KChar* start, const KChar* end, uint8_t* result) {
+  narrow(start, end - start, result);
+}
+
+void InflateLatin1ToUtf16(const uint8_t* start, const uint8_t* end, KChar* result) {
+  widen(start, end - start, result);
+}
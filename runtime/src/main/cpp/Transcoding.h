@@ -0,0 +1,48 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+#ifndef RUNTIME_TRANSCODING_H
+#define RUNTIME_TRANSCODING_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Types.h"
+
+// Conversions between UTF-8, UTF-16 and Latin-1, vectorized over ASCII runs with SSE2 or NEON
+// when available, and scalar otherwise. Callers compute the result length first, then convert
+// directly into the result array.
+
+struct Utf8Scan {
+  // Input is well-formed UTF-8, so the counts below are valid.
+  bool wellFormed;
+  // All code points are below U+0100.
+  bool latin1;
+  // Length of the input in UTF-16 code units.
+  uint32_t utf16Length;
+};
+
+// Validates UTF-8, rejecting overlong forms, surrogates and code points above U+10FFFF.
+Utf8Scan ScanUtf8(const uint8_t* start, const uint8_t* end);
+// Decode well-formed UTF-8, Latin-1 decoding also requires all code points to be below U+0100.
+void DecodeUtf8ToUtf16(const uint8_t* start, const uint8_t* end, KChar* result);
+void DecodeUtf8ToLatin1(const uint8_t* start, const uint8_t* end, uint8_t* result);
+
+// Length of UTF-8 encoding of UTF-16 with lone surrogates replaced by U+FFFD, wellFormed is
+// set to false if there are such.
+uint32_t Utf16Utf8Length(const KChar* start, const KChar* end, bool* wellFormed);
+// Encodes UTF-16 replacing lone surrogates by U+FFFD, returns the end of the result.
+uint8_t* EncodeUtf16ToUtf8(const KChar* start, const KChar* end, uint8_t* result);
+
+uint32_t Latin1Utf8Length(const uint8_t* start, const uint8_t* end);
+uint8_t* EncodeLatin1ToUtf8(const uint8_t* start, const uint8_t* end, uint8_t* result);
+
+// If all UTF-16 code units are below U+0100.
+bool Utf16FitsLatin1(const KChar* start, const KChar* end);
+// Narrowing requires all code units to be below U+0100.
+void NarrowUtf16ToLatin1(const KChar* start, const KChar* end, uint8_t* result);
+void InflateLatin1ToUtf16(const uint8_t* start, const uint8_t* end, KChar* result);
+
+#endif  // RUNTIME_TRANSCODING_H
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include "Memory.h"
+#include "Parking.h"
 #include "Types.h"
 
 namespace {
@@ -30,20 +31,6 @@ inline WeakReferenceCounter* asWeakReferenceCounter(ObjHeader* obj) {
   return reinterpret_cast<WeakReferenceCounter*>(obj);
 }
 
-#if !KONAN_NO_THREADS
-
-inline void lock(int32_t* address) {
-    RuntimeAssert(*address == 0 || *address == 1, "Incorrect lock state");
-    while (__sync_val_compare_and_swap(address, 0, 1) == 1);
-}
-
-inline void unlock(int32_t* address) {
-    int old = __sync_val_compare_and_swap(address, 1, 0);
-    RuntimeAssert(old == 1, "Incorrect lock state");
-}
-
-#endif
-
 }  // namespace
 
 extern "C" {
@@ -94,10 +81,9 @@ void WeakReferenceCounterClear(ObjHeader* counter) {
   *referredAddress = nullptr;
 #else
   int32_t* lockAddress = &asWeakReferenceCounter(counter)->lock;
-  // Spinlock.
-  lock(lockAddress);
+  ParkingLock(lockAddress);
   *referredAddress = nullptr;
-  unlock(lockAddress);
+  ParkingUnlock(lockAddress);
 #endif
 }
 
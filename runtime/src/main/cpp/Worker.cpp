@@ -23,7 +23,14 @@
 #include <stdio.h>
 
 #if WITH_WORKERS
+#include <limits.h>
 #include <pthread.h>
+#include <sched.h>
+#if KONAN_LINUX || KONAN_ANDROID
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "PthreadUtils.h"
 #endif
 
@@ -31,6 +38,9 @@
 #include "Exceptions.h"
 #include "KAssert.h"
 #include "Memory.h"
+#include "Natives.h"
+#include "Parking.h"
+#include "Porting.h"
 #include "Runtime.h"
 #include "Types.h"
 #include "Worker.h"
@@ -40,6 +50,8 @@ extern "C" {
 RUNTIME_NORETURN void ThrowWorkerInvalidState();
 RUNTIME_NORETURN void ThrowWorkerUnsupported();
 OBJ_GETTER(WorkerLaunchpad, KRef);
+OBJ_GETTER(WorkerPoolProducerLaunchpad, KRef, KInt);
+OBJ_GETTER(WorkerPoolJobLaunchpad, KRef, KRef);
 
 }  // extern "C"
 
@@ -81,6 +93,8 @@ struct Job {
   union {
     struct {
       KRef (*function)(KRef, ObjHeader**);
+      // Stable pointer to the frozen job lambda, called instead of function if not null.
+      KNativePtr operation;
       KNativePtr argument;
       Future* future;
       KInt transferMode;
@@ -98,14 +112,578 @@ struct Job {
   };
 };
 
-struct JobCompare {
-  bool operator() (const Job& lhs, const Job& rhs) const {
-    RuntimeAssert(lhs.kind == JOB_EXECUTE_AFTER && rhs.kind == JOB_EXECUTE_AFTER, "Must be delayed jobs");
-    return lhs.executeAfter.whenExecute < rhs.executeAfter.whenExecute;
+// Marks delayed job cancelled by other worker, whose operation must be disposed by the owner.
+constexpr KLong kCancelledJob = -1;
+// Handle of the job which cannot be cancelled.
+constexpr KLong kInvalidTimerHandle = -1;
+
+// Used to keep data written by different threads on different cache lines.
+constexpr size_t kCacheLineSize = 64;
+// Number of shards in the worker and future tables, must be power of two.
+constexpr KInt kStateShards = 64;
+// How many released futures each shard keeps for reuse.
+constexpr size_t kFuturePoolSize = 32;
+// Initial capacity of the work-stealing deque, must be power of two.
+constexpr int64_t kInitialDequeCapacity = 256;
+// Upper bound on the number of jobs moved from the pool's shared queue to the thread's deque at once.
+constexpr size_t kInjectedBatch = 32;
+// Upper bound on the number of threads in the worker pool.
+constexpr KInt kMaxPoolSize = 1024;
+// Resolution of the timer wheel.
+constexpr KLong kTimerTickMicros = 128;
+// Timer wheel has one level of 2^kTimerInnerBits slots for the nearest timers, and kTimerOuterLevels
+// levels of 2^kTimerOuterBits slots, each slot of the level spanning the whole previous level.
+constexpr int kTimerInnerBits = 8;
+constexpr int kTimerOuterBits = 6;
+constexpr int kTimerOuterLevels = 5;
+constexpr int kTimerInnerSlots = 1 << kTimerInnerBits;
+constexpr int kTimerOuterSlots = 1 << kTimerOuterBits;
+constexpr int kTimerSlots = kTimerInnerSlots + kTimerOuterLevels * kTimerOuterSlots;
+// Part of the timer's generation kept in its handle, so that handles are never negative.
+constexpr uint32_t kTimerGenerationMask = 0x7fffffff;
+
+// Worker thread keeps the priority of the thread which started it.
+constexpr KInt kInheritPriority = INT_MIN;
+// Range of priorities, as nice values.
+constexpr KInt kHighestPriority = -20;
+constexpr KInt kLowestPriority = 19;
+#if KONAN_LINUX || KONAN_ANDROID
+// MPOL_PREFERRED from linux/mempolicy.h.
+constexpr int kPreferredMemoryPolicy = 1;
+#endif
+
+// Placement and scheduling of the worker thread, see WorkerOptions.kt.
+struct ThreadOptions {
+  KStdVector<int> cpus;
+  KInt numaNode = -1;
+  KLong stackSize = 0;
+  KInt priority = kInheritPriority;
+};
+
+// CPUs the process may run on.
+KStdVector<int> availableCpus() {
+  KStdVector<int> result;
+#if KONAN_LINUX || KONAN_ANDROID
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) result.push_back(cpu);
+    }
+  }
+  if (result.size() > 0) return result;
+#endif
+  int32_t processors = konan::availableProcessors();
+  for (int cpu = 0; cpu < processors; cpu++) result.push_back(cpu);
+  return result;
+}
+
+#if KONAN_LINUX || KONAN_ANDROID
+// Reads CPU list in sysfs format, such as "0-3,8,10-11".
+bool readCpuList(const char* path, KStdVector<int>* cpus) {
+  FILE* file = fopen(path, "r");
+  if (file == nullptr) return false;
+  int first, last;
+  char separator;
+  while (fscanf(file, "%d", &first) == 1) {
+    last = first;
+    if (fscanf(file, "%c", &separator) == 1 && separator == '-') {
+      if (fscanf(file, "%d", &last) != 1) break;
+      if (fscanf(file, "%c", &separator) != 1) separator = '\n';
+    }
+    for (int cpu = first; cpu <= last; cpu++) cpus->push_back(cpu);
+    if (separator != ',') break;
+  }
+  fclose(file);
+  return true;
+}
+
+bool numaNodeCpus(int node, KStdVector<int>* cpus) {
+  char path[64];
+  konan::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+  return readCpuList(path, cpus);
+}
+#endif  // KONAN_LINUX || KONAN_ANDROID
+
+// Nodes are numbered from zero, machine without NUMA information is seen as a single node.
+KInt numaNodeCount() {
+  KInt result = 0;
+#if KONAN_LINUX || KONAN_ANDROID
+  char path[64];
+  while (true) {
+    konan::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", result);
+    if (access(path, F_OK) != 0) break;
+    result++;
+  }
+#endif  // KONAN_LINUX || KONAN_ANDROID
+  return result == 0 ? 1 : result;
+}
+
+// Available CPUs of the node, or all available CPUs for the negative node.
+KStdVector<int> nodeCpus(KInt node) {
+  KStdVector<int> available = availableCpus();
+  if (node < 0) return available;
+#if KONAN_LINUX || KONAN_ANDROID
+  KStdVector<int> cpus;
+  if (numaNodeCpus(node, &cpus)) {
+    KStdVector<int> result;
+    for (int cpu : cpus) {
+      for (int availableCpu : available) {
+        if (cpu == availableCpu) {
+          result.push_back(cpu);
+          break;
+        }
+      }
+    }
+    return result;
+  }
+#endif  // KONAN_LINUX || KONAN_ANDROID
+  return node == 0 ? available : KStdVector<int>();
+}
+
+// Applied by the worker thread itself before runtime initialization, so that memory of its MemoryState
+// is allocated after the placement. Best effort, i.e. raising priority without privileges is ignored.
+void applyThreadOptions(const ThreadOptions& options) {
+  KStdVector<int> cpus = options.cpus;
+  if (options.numaNode >= 0) {
+    KStdVector<int> onNode = nodeCpus(options.numaNode);
+    if (cpus.size() == 0) {
+      cpus = onNode;
+    } else {
+      KStdVector<int> both;
+      for (int cpu : cpus) {
+        for (int nodeCpu : onNode) {
+          if (cpu == nodeCpu) both.push_back(cpu);
+        }
+      }
+      cpus.swap(both);
+    }
+#if (KONAN_LINUX || KONAN_ANDROID) && defined(SYS_set_mempolicy)
+    // Prefer node's memory for pages first touched by this thread.
+    constexpr int kBitsPerWord = sizeof(unsigned long) * 8;
+    unsigned long nodeMask[(CPU_SETSIZE + kBitsPerWord - 1) / kBitsPerWord] = { 0 };
+    if (options.numaNode < CPU_SETSIZE) {
+      nodeMask[options.numaNode / kBitsPerWord] |= 1UL << (options.numaNode % kBitsPerWord);
+      syscall(SYS_set_mempolicy, kPreferredMemoryPolicy, nodeMask, CPU_SETSIZE);
+    }
+#endif
+  }
+#if KONAN_LINUX || KONAN_ANDROID
+  if (cpus.size() > 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
   }
+  if (options.priority != kInheritPriority) {
+    setpriority(PRIO_PROCESS, syscall(SYS_gettid), options.priority);
+  }
+#else
+  if (options.priority != kInheritPriority) {
+    // Map nice value to the priority range of the current scheduling policy.
+    int policy;
+    struct sched_param param;
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+      int lowest = sched_get_priority_min(policy);
+      int highest = sched_get_priority_max(policy);
+      param.sched_priority = highest -
+          (options.priority - kHighestPriority) * (highest - lowest) / (kLowestPriority - kHighestPriority);
+      pthread_setschedparam(pthread_self(), policy, &param);
+    }
+  }
+#endif  // KONAN_LINUX || KONAN_ANDROID
+}
+
+struct JobNode {
+  JobNode* next;
+  Job job;
 };
 
-typedef KStdOrderedSet<Job, JobCompare> DelayedJobSet;
+/**
+ * Intrusive multi-producer single-consumer queue (see D. Vyukov's "Intrusive MPSC node-based queue").
+ * Producers only exchange the head, so they never wait for each other or for the consumer.
+ * Producer preempted between the exchange and linking makes the queue look empty for a while,
+ * the consumer relies on the worker's counter of incoming jobs to see something is coming.
+ */
+class JobQueue {
+ public:
+  JobQueue() : head_(&stub_), tail_(&stub_) {
+    stub_.next = nullptr;
+  }
+
+  void push(JobNode* node) {
+    push(node, node);
+  }
+
+  // Pushes nodes linked from first to last at once.
+  void push(JobNode* first, JobNode* last) {
+    last->next = nullptr;
+    JobNode* previous = __atomic_exchange_n(&head_, last, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&previous->next, first, __ATOMIC_RELEASE);
+  }
+
+  // Only called by the consumer.
+  JobNode* pop() {
+    JobNode* tail = tail_;
+    JobNode* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (tail == &stub_) {
+      if (next == nullptr) return nullptr;
+      tail_ = next;
+      tail = next;
+      next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    if (tail != __atomic_load_n(&head_, __ATOMIC_ACQUIRE)) return nullptr;
+    // The last node can only be taken with the stub behind it.
+    push(&stub_);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next != nullptr) {
+      tail_ = next;
+      return tail;
+    }
+    return nullptr;
+  }
+
+ private:
+  JobNode* head_;
+  char padding_[kCacheLineSize];
+  JobNode* tail_;
+  JobNode stub_;
+};
+
+/**
+ * Hierarchical timing wheel (see G. Varghese and T. Lauck, "Hashed and Hierarchical Timing Wheels"),
+ * holding operations scheduled with a delay. Timer is put into the slot of the inner level if it expires
+ * within the inner level's span, otherwise into the slot of the first outer level spanning it, and is moved
+ * to the lower levels as time passes. Timers are allocated from the array, so that both insertion and
+ * cancellation by handle are O(1) and don't allocate memory in the steady state.
+ */
+class TimerWheel {
+ public:
+  TimerWheel() : currentTick_(konan::getTimeMicros() / kTimerTickMicros) {
+    for (int slot = 0; slot < kTimerSlots; slot++) heads_[slot] = -1;
+    for (auto& word : occupied_) word = 0;
+  }
+
+  size_t size() const { return size_; }
+
+  // Returns handle of the timer, or kInvalidTimerHandle if the operation is due already.
+  KLong add(KLong whenExecute, KNativePtr operation, bool frozen) {
+    if (tickOf(whenExecute) <= currentTick_) return kInvalidTimerHandle;
+    int32_t index;
+    if (free_ >= 0) {
+      index = free_;
+      free_ = timers_[index].next;
+    } else {
+      index = timers_.size();
+      timers_.push_back(Timer());
+      timers_[index].generation = 0;
+    }
+    Timer& timer = timers_[index];
+    timer.whenExecute = whenExecute;
+    timer.operation = operation;
+    timer.frozen = frozen;
+    place(index);
+    size_++;
+    return (static_cast<KLong>(timer.generation & kTimerGenerationMask) << 32) | static_cast<uint32_t>(index);
+  }
+
+  // Returns true, along with the operation, if the timer was still pending.
+  bool cancel(KLong handle, KNativePtr* operation, bool* frozen) {
+    if (handle < 0) return false;
+    uint32_t index = static_cast<uint32_t>(handle);
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (index >= timers_.size()) return false;
+    Timer& timer = timers_[index];
+    if (timer.slot < 0 || (timer.generation & kTimerGenerationMask) != generation) return false;
+    *operation = timer.operation;
+    *frozen = timer.frozen;
+    unlink(index);
+    release(index);
+    return true;
+  }
+
+  // Calls `due` for every operation to be executed by `now`. Returns how many microseconds to wait for
+  // the next timer event, or -1 if there are no timers.
+  template <typename F>
+  KLong expire(KLong now, F due) {
+    int64_t nowTick = now / kTimerTickMicros;
+    while (currentTick_ < nowTick) {
+      if (size_ == 0) {
+        currentTick_ = nowTick;
+        break;
+      }
+      // Slots between the current and the next event are empty, so they are skipped at once.
+      int64_t next = nextEventTick();
+      if (next > nowTick) {
+        currentTick_ = nowTick;
+        break;
+      }
+      currentTick_ = next;
+      for (int level = kTimerOuterLevels; level >= 1; level--) {
+        int shift = levelShift(level);
+        if ((next & ((static_cast<int64_t>(1) << shift) - 1)) == 0)
+          cascade(outerSlot(level, next >> shift));
+      }
+      int slot = next & (kTimerInnerSlots - 1);
+      int32_t index = heads_[slot];
+      while (index >= 0) {
+        int32_t following = timers_[index].next;
+        unlink(index);
+        if (timers_[index].whenExecute <= now) {
+          due(timers_[index].operation);
+          release(index);
+        } else {
+          // Timers too far in the future are placed at the end of the wheel.
+          place(index);
+        }
+        index = following;
+      }
+    }
+    if (size_ == 0) return -1;
+    KLong result = nextEventTick() * kTimerTickMicros - now;
+    return result > 0 ? result : 1;
+  }
+
+  template <typename F>
+  void clear(F dispose) {
+    for (auto& timer : timers_) {
+      if (timer.slot >= 0) dispose(timer.operation);
+    }
+  }
+
+ private:
+  struct Timer {
+    KLong whenExecute;
+    KNativePtr operation;
+    uint32_t generation;
+    // Links in the slot list, or in the free list.
+    int32_t next;
+    int32_t prev;
+    // Slot of the timer, or -1 if the timer is free.
+    int16_t slot = -1;
+    bool frozen;
+  };
+
+  static int64_t tickOf(KLong whenExecute) {
+    // Round up, so that timers never expire early.
+    return whenExecute / kTimerTickMicros + (whenExecute % kTimerTickMicros != 0 ? 1 : 0);
+  }
+
+  static int levelShift(int level) {
+    return kTimerInnerBits + (level - 1) * kTimerOuterBits;
+  }
+
+  static int outerSlot(int level, int64_t index) {
+    return kTimerInnerSlots + (level - 1) * kTimerOuterSlots + (index & (kTimerOuterSlots - 1));
+  }
+
+  void place(int32_t index) {
+    Timer& timer = timers_[index];
+    int64_t tick = tickOf(timer.whenExecute);
+    if (tick <= currentTick_) tick = currentTick_ + 1;
+    int64_t delta = tick - currentTick_;
+    int slot;
+    if (delta < kTimerInnerSlots) {
+      slot = tick & (kTimerInnerSlots - 1);
+    } else {
+      int level = 1;
+      while (level < kTimerOuterLevels && delta >= (static_cast<int64_t>(1) << levelShift(level + 1)))
+        level++;
+      int64_t limit = static_cast<int64_t>(1) << (levelShift(level) + kTimerOuterBits);
+      // Beyond the wheel, revisited once the last slot is cascaded.
+      if (delta >= limit) tick = currentTick_ + limit - 1;
+      slot = outerSlot(level, tick >> levelShift(level));
+    }
+    timer.slot = slot;
+    timer.prev = -1;
+    timer.next = heads_[slot];
+    if (timer.next >= 0) timers_[timer.next].prev = index;
+    heads_[slot] = index;
+    occupied_[slot >> 6] |= static_cast<uint64_t>(1) << (slot & 63);
+  }
+
+  void unlink(int32_t index) {
+    Timer& timer = timers_[index];
+    if (timer.prev >= 0)
+      timers_[timer.prev].next = timer.next;
+    else
+      heads_[timer.slot] = timer.next;
+    if (timer.next >= 0) timers_[timer.next].prev = timer.prev;
+    if (heads_[timer.slot] < 0) occupied_[timer.slot >> 6] &= ~(static_cast<uint64_t>(1) << (timer.slot & 63));
+  }
+
+  void release(int32_t index) {
+    Timer& timer = timers_[index];
+    timer.slot = -1;
+    timer.operation = nullptr;
+    timer.generation++;
+    timer.next = free_;
+    free_ = index;
+    size_--;
+  }
+
+  void cascade(int slot) {
+    int32_t index = heads_[slot];
+    heads_[slot] = -1;
+    occupied_[slot >> 6] &= ~(static_cast<uint64_t>(1) << (slot & 63));
+    while (index >= 0) {
+      int32_t next = timers_[index].next;
+      place(index);
+      index = next;
+    }
+  }
+
+  // Finds the first occupied slot among `count` slots of the level starting at `start`, going around.
+  int findOccupied(int firstSlot, int slots, int start, int count) const {
+    for (int done = 0; done < count;) {
+      int position = (start + done) & (slots - 1);
+      int slot = firstSlot + position;
+      // Level's slots are aligned to words, and never span more than the level.
+      int bits = 64 - (slot & 63);
+      if (bits > slots - position) bits = slots - position;
+      uint64_t word = occupied_[slot >> 6] >> (slot & 63);
+      if (bits < 64) word &= (static_cast<uint64_t>(1) << bits) - 1;
+      if (word != 0) {
+        int found = done + __builtin_ctzll(word);
+        return found < count ? found : -1;
+      }
+      done += bits;
+    }
+    return -1;
+  }
+
+  // The first tick after the current one when some inner slot expires or some outer slot is cascaded.
+  int64_t nextEventTick() const {
+    int64_t result = INT64_MAX;
+    int found = findOccupied(0, kTimerInnerSlots, (currentTick_ + 1) & (kTimerInnerSlots - 1), kTimerInnerSlots - 1);
+    if (found >= 0) result = currentTick_ + 1 + found;
+    for (int level = 1; level <= kTimerOuterLevels; level++) {
+      int shift = levelShift(level);
+      int64_t block = currentTick_ >> shift;
+      found = findOccupied(outerSlot(level, 0), kTimerOuterSlots, (block + 1) & (kTimerOuterSlots - 1), kTimerOuterSlots);
+      if (found < 0) continue;
+      int64_t tick = (block + 1 + found) << shift;
+      if (tick < result) result = tick;
+    }
+    return result;
+  }
+
+  int64_t currentTick_;
+  size_t size_ = 0;
+  int32_t free_ = -1;
+  KStdVector<Timer> timers_;
+  int32_t heads_[kTimerSlots];
+  uint64_t occupied_[(kTimerSlots + 63) / 64];
+};
+
+struct PoolJob {
+  // Stable pointer to the frozen job function.
+  KNativePtr function;
+  KNativePtr argument;
+  Future* future;
+  KInt transferMode;
+};
+
+/**
+ * Chase-Lev work-stealing deque (see "Correct and Efficient Work-Stealing for Weak Memory Models"
+ * by N. M. Le et al.). Only the owner pushes and takes jobs at the bottom, any thread could steal from the top.
+ */
+class WorkStealingDeque {
+ public:
+  WorkStealingDeque() : top_(0), bottom_(0) {
+    array_ = allocateArray(kInitialDequeCapacity);
+  }
+
+  ~WorkStealingDeque() {
+    konanFreeMemory(array_);
+    for (auto* array : retired_) konanFreeMemory(array);
+  }
+
+  // Only called by the owner.
+  void push(PoolJob* job) {
+    int64_t bottom = __atomic_load_n(&bottom_, __ATOMIC_RELAXED);
+    int64_t top = __atomic_load_n(&top_, __ATOMIC_ACQUIRE);
+    Array* array = __atomic_load_n(&array_, __ATOMIC_RELAXED);
+    if (bottom - top > array->mask) array = grow(array, top, bottom);
+    __atomic_store_n(&array->jobs[bottom & array->mask], job, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+  }
+
+  // Only called by the owner.
+  PoolJob* take() {
+    int64_t bottom = __atomic_load_n(&bottom_, __ATOMIC_RELAXED) - 1;
+    Array* array = __atomic_load_n(&array_, __ATOMIC_RELAXED);
+    __atomic_store_n(&bottom_, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n(&top_, __ATOMIC_RELAXED);
+    PoolJob* result = nullptr;
+    if (top <= bottom) {
+      result = __atomic_load_n(&array->jobs[bottom & array->mask], __ATOMIC_RELAXED);
+      if (top == bottom) {
+        // The last job, compete with thieves for it.
+        if (!__atomic_compare_exchange_n(&top_, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+          result = nullptr;
+        __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+      }
+    } else {
+      __atomic_store_n(&bottom_, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return result;
+  }
+
+  // Returns nullptr if the deque is empty, or if the race for the job is lost and `lost` is set.
+  PoolJob* steal(bool* lost) {
+    int64_t top = __atomic_load_n(&top_, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n(&bottom_, __ATOMIC_ACQUIRE);
+    if (top >= bottom) return nullptr;
+    Array* array = __atomic_load_n(&array_, __ATOMIC_ACQUIRE);
+    PoolJob* result = __atomic_load_n(&array->jobs[top & array->mask], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&top_, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+      *lost = true;
+      return nullptr;
+    }
+    return result;
+  }
+
+  bool empty() const {
+    return __atomic_load_n(&bottom_, __ATOMIC_SEQ_CST) <= __atomic_load_n(&top_, __ATOMIC_SEQ_CST);
+  }
+
+ private:
+  struct Array {
+    int64_t mask;
+    PoolJob* jobs[1];
+  };
+
+  static Array* allocateArray(int64_t capacity) {
+    auto* array = reinterpret_cast<Array*>(konanAllocMemory(sizeof(Array) + (capacity - 1) * sizeof(PoolJob*)));
+    array->mask = capacity - 1;
+    return array;
+  }
+
+  Array* grow(Array* array, int64_t top, int64_t bottom) {
+    Array* result = allocateArray((array->mask + 1) * 2);
+    for (int64_t index = top; index < bottom; index++) {
+      result->jobs[index & result->mask] = array->jobs[index & array->mask];
+    }
+    // Thieves may still read from the old array, so it is only released with the deque.
+    retired_.push_back(array);
+    __atomic_store_n(&array_, result, __ATOMIC_RELEASE);
+    return result;
+  }
+
+  int64_t top_;
+  char padding_[kCacheLineSize];
+  int64_t bottom_;
+  Array* array_;
+  KStdVector<Array*> retired_;
+};
 
 }  // namespace
 
@@ -122,19 +700,34 @@ class Worker {
 
   ~Worker();
 
-  void startEventLoop();
+  // Options are only used by the thread started in startEventLoop().
+  void startEventLoop(const ThreadOptions& options);
+
+  const ThreadOptions& threadOptions() const { return threadOptions_; }
 
+  // Could be called on any thread.
   void putJob(Job job, bool toFront);
-  void putDelayedJob(Job job);
+  // Puts regular jobs in order, waking the worker up once.
+  void putJobs(const Job* jobs, KInt count);
+  // Returns handle of the delayed job.
+  KLong putDelayedJob(KNativePtr operation, KLong whenExecute, bool frozen);
+  bool cancelDelayedJob(KLong handle);
 
   bool waitDelayed(bool blocking);
 
   Job getJob(bool blocking);
 
+  bool hasJobsLocked() const {
+    return queue_.size() != 0 || __atomic_load_n(&incomingSize_, __ATOMIC_SEQ_CST) != 0;
+  }
+
   KLong checkDelayedLocked();
 
   bool waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining);
 
+  // Spins for a short while with lock_ released, returns true if jobs arrived meanwhile.
+  bool spinForJobsLocked();
+
   JobKind processQueueElement(bool blocking);
 
   bool park(KLong timeoutMicroseconds, bool process);
@@ -152,8 +745,19 @@ class Worker {
  private:
   KInt id_;
   WorkerKind kind_;
+  // Regular jobs, put without any locks.
+  JobQueue incoming_;
+  // Number of jobs being put to or in incoming_.
+  KInt incomingSize_ = 0;
+  // If the worker waits for jobs on cond_, so producers must signal it.
+  bool waiting_ = false;
+  ThreadOptions threadOptions_;
+  // Jobs to be processed before incoming ones: urgent jobs and delayed jobs already due, guarded by lock_.
   KStdDeque<Job> queue_;
-  DelayedJobSet delayed_;
+  // Size of queue_, could be read without the lock.
+  size_t queueSize_ = 0;
+  // Jobs to be executed later, guarded by lock_.
+  TimerWheel delayed_;
   // Stable pointer with worker's name.
   KNativePtr name_;
   // Lock and condition for waiting on the queue.
@@ -201,9 +805,104 @@ class Locker {
   pthread_mutex_t* lock_;
 };
 
+/**
+ * Set of futures, collecting the ones completed. Unlike waiting for any future, only the selector's
+ * own waiters are woken up, and they don't need to check the state of every future.
+ * Referenced by its entry in State and by every registered future not yet completed.
+ */
+class CompletionQueue {
+ public:
+  explicit CompletionQueue(KInt id) : id_(id) {
+    pthread_mutex_init(&lock_, nullptr);
+    pthread_cond_init(&cond_, nullptr);
+  }
+
+  ~CompletionQueue() {
+    pthread_mutex_destroy(&lock_);
+    pthread_cond_destroy(&cond_);
+  }
+
+  KInt id() const { return id_; }
+
+  void addRef() {
+    __atomic_add_fetch(&refCount_, 1, __ATOMIC_RELAXED);
+  }
+
+  void release() {
+    if (__atomic_sub_fetch(&refCount_, 1, __ATOMIC_ACQ_REL) == 0) konanDestructInstance(this);
+  }
+
+  void registerFuture() {
+    Locker locker(&lock_);
+    pending_++;
+  }
+
+  // Called if the future could not be registered after all.
+  void unregisterFuture() {
+    Locker locker(&lock_);
+    pending_--;
+  }
+
+  // Called once registered future is completed.
+  void complete(KInt futureId) {
+    Locker locker(&lock_);
+    if (closed_) return;
+    ready_.push_back(futureId);
+    pthread_cond_signal(&cond_);
+  }
+
+  // Waits until some registered future completes, or timeout elapses, and takes all the completed ones.
+  void take(KInt millis, KStdVector<KInt>* result) {
+    Locker locker(&lock_);
+    if (ready_.size() == 0 && pending_ > 0 && !closed_ && millis != 0) {
+      if (millis < 0) {
+        while (ready_.size() == 0 && !closed_) pthread_cond_wait(&cond_, &lock_);
+      } else {
+        uint64_t nsDelta = millis * 1000000LL;
+        WaitOnCondVar(&cond_, &lock_, nsDelta);
+      }
+    }
+    result->assign(ready_.begin(), ready_.end());
+    pending_ -= ready_.size();
+    ready_.clear();
+  }
+
+  KInt pending() {
+    Locker locker(&lock_);
+    return pending_;
+  }
+
+  void close() {
+    Locker locker(&lock_);
+    closed_ = true;
+    ready_.clear();
+    pthread_cond_broadcast(&cond_);
+  }
+
+ private:
+  KInt id_;
+  KInt refCount_ = 1;
+  // Registered futures not yet taken.
+  KInt pending_ = 0;
+  bool closed_ = false;
+  // Ids of completed futures, in order of completion.
+  KStdDeque<KInt> ready_;
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+};
+
+// Either completion queue or the operation to be executed on the worker, once the future completes.
+struct FutureListener {
+  CompletionQueue* queue;
+  KInt workerId;
+  KNativePtr operation;
+};
+
+void notifyListener(const FutureListener& listener, KInt futureId);
+
 class Future {
  public:
-  Future(KInt id) : state_(SCHEDULED), id_(id) {
+  Future() : state_(INVALID), id_(0), result_(nullptr) {
     pthread_mutex_init(&lock_, nullptr);
     pthread_cond_init(&cond_, nullptr);
   }
@@ -223,7 +922,16 @@ class Future {
     }
   }
 
+  // Called on the new or the cleared future, before it is published.
+  void reset(KInt id) {
+    state_ = SCHEDULED;
+    id_ = id;
+  }
+
   OBJ_GETTER0(consumeResultUnlocked) {
+    // Short jobs often complete while we spin, so their result is taken without sleeping on the condition.
+    SpinBackoff backoff;
+    while (__atomic_load_n(&state_, __ATOMIC_ACQUIRE) == SCHEDULED && backoff.spin()) {}
     Locker locker(&lock_);
     while (state_ == SCHEDULED) {
       pthread_cond_wait(&cond_, &lock_);
@@ -240,6 +948,14 @@ class Future {
 
   void cancelUnlocked();
 
+  // Returns false if the future is already completed, then the caller must notify the listener itself.
+  bool addListenerUnlocked(const FutureListener& listener) {
+    Locker locker(&lock_);
+    if (state_ != SCHEDULED) return false;
+    listeners_.push_back(listener);
+    return true;
+  }
+
   // Those are called with the lock taken.
   KInt state() const { return state_; }
   KInt id() const { return id_; }
@@ -251,58 +967,198 @@ class Future {
   KInt id_;
   // Stable pointer with future's result.
   KNativePtr result_;
+  // Notified on completion, guarded by lock_.
+  KStdVector<FutureListener> listeners_;
   // Lock and condition for waiting on the future.
   pthread_mutex_t lock_;
   pthread_cond_t cond_;
+
+  void notifyListenersUnlocked(KStdVector<FutureListener>& listeners, KInt id);
+};
+
+class WorkerPool;
+
+struct PoolThread {
+  PoolThread(WorkerPool* pool, KInt index) : pool(pool), index(index), random(index * 2654435761u + 1) {}
+
+  WorkerPool* pool;
+  KInt index;
+  pthread_t thread = 0;
+  bool started = false;
+  // Registered with the GC before the thread starts, destroyed with the thread's runtime.
+  Worker* worker = nullptr;
+  // State of the generator choosing victims to steal from.
+  uint32_t random;
+  WorkStealingDeque deque;
+};
+
+THREAD_LOCAL_VARIABLE PoolThread* g_poolThread = nullptr;
+
+/**
+ * Fixed set of threads sharing CPU-bound jobs. Every thread runs jobs from its own deque first, then ones
+ * submitted from outside of the pool, and then steals from a random busy thread. Jobs submitted by the pool
+ * jobs go to the deque of the current thread, so nested parallelism stays local when possible.
+ */
+class WorkerPool {
+ public:
+  WorkerPool(KInt id, KInt size, bool errorReporting);
+
+  ~WorkerPool();
+
+  KInt id() const { return id_; }
+
+  KInt size() const { return size_; }
+
+  // Returns false if some thread could not be started, the pool must be terminated then.
+  bool start();
+
+  // Could be called on any thread.
+  void submit(PoolJob** jobs, KInt count);
+
+  // Runs jobs on the current pool thread until the future is ready or no job could be found.
+  void helpUntilDone(KInt futureId);
+
+  // Waits for all the jobs to complete and stops the threads.
+  void terminate();
+
+  void run(PoolThread* self);
+
+ private:
+  PoolJob* findJob(PoolThread* self);
+  PoolJob* takeInjected(PoolThread* self);
+  PoolJob* steal(PoolThread* self);
+  bool hasWork() const;
+  void runJob(PoolJob* job);
+  void wakeUp(KInt count);
+
+  KInt id_;
+  KInt size_;
+  bool errorReporting_;
+  KStdVector<PoolThread*> threads_;
+  // Jobs submitted from outside of the pool, guarded by injectedLock_.
+  pthread_mutex_t injectedLock_;
+  KStdDeque<PoolJob*> injected_;
+  // Size of injected_, could be read without the lock.
+  size_t injectedSize_ = 0;
+  // Lock and condition for idle threads.
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+  KInt sleepers_ = 0;
+  bool terminating_ = false;
+};
+
+class ReadLocker {
+ public:
+  explicit ReadLocker(pthread_rwlock_t* lock) : lock_(lock) {
+    pthread_rwlock_rdlock(lock_);
+  }
+  ~ReadLocker() {
+     pthread_rwlock_unlock(lock_);
+  }
+
+ private:
+  pthread_rwlock_t* lock_;
 };
 
+class WriteLocker {
+ public:
+  explicit WriteLocker(pthread_rwlock_t* lock) : lock_(lock) {
+    pthread_rwlock_wrlock(lock_);
+  }
+  ~WriteLocker() {
+     pthread_rwlock_unlock(lock_);
+  }
+
+ private:
+  pthread_rwlock_t* lock_;
+};
+
+struct WorkerShard {
+  pthread_rwlock_t lock;
+  KStdUnorderedMap<KInt, Worker*> workers;
+  char padding[kCacheLineSize];
+};
+
+struct FutureShard {
+  pthread_rwlock_t lock;
+  KStdUnorderedMap<KInt, Future*> futures;
+  // Released futures kept for reuse.
+  KStdVector<Future*> pool;
+  char padding[kCacheLineSize];
+};
+
+/**
+ * Workers and futures are kept in tables sharded by id, so that producers putting jobs to different
+ * workers, or to the same worker, mostly don't touch the same lock. Job submission only takes
+ * the worker's shard for reading, which keeps the worker alive while the job is put into its lock-free
+ * queue, and the future's shard for writing. Process-wide lock_ only guards rare operations.
+ */
 class State {
  public:
   State() {
     pthread_mutex_init(&lock_, nullptr);
     pthread_cond_init(&cond_, nullptr);
+    for (auto& shard : workerShards_) pthread_rwlock_init(&shard.lock, nullptr);
+    for (auto& shard : futureShards_) pthread_rwlock_init(&shard.lock, nullptr);
+    pthread_rwlock_init(&poolsLock_, nullptr);
+    pthread_rwlock_init(&selectorsLock_, nullptr);
 
     currentWorkerId_ = 1;
     currentFutureId_ = 1;
     currentVersion_ = 0;
+    versionWaiters_ = 0;
   }
 
   ~State() {
     // TODO: some sanity check here?
+    for (auto& shard : futureShards_) {
+      for (auto* future : shard.pool) konanDestructInstance(future);
+      pthread_rwlock_destroy(&shard.lock);
+    }
+    for (auto& shard : workerShards_) pthread_rwlock_destroy(&shard.lock);
+    pthread_rwlock_destroy(&poolsLock_);
+    pthread_rwlock_destroy(&selectorsLock_);
     pthread_mutex_destroy(&lock_);
     pthread_cond_destroy(&cond_);
   }
 
   Worker* addWorkerUnlocked(bool errorReporting, KRef customName, WorkerKind kind) {
-    Worker* worker = nullptr;
+    Worker* worker = konanConstructInstance<Worker>(nextWorkerId(), errorReporting, customName, kind);
+    if (worker == nullptr) return nullptr;
     {
-      Locker locker(&lock_);
-      worker = konanConstructInstance<Worker>(nextWorkerId(), errorReporting, customName, kind);
-      if (worker == nullptr) return nullptr;
-      workers_[worker->id()] = worker;
+      auto& shard = workerShard(worker->id());
+      WriteLocker locker(&shard.lock);
+      shard.workers[worker->id()] = worker;
     }
     GC_RegisterWorker(worker);
     return worker;
   }
 
   void removeWorkerUnlocked(KInt id) {
-    Locker locker(&lock_);
-    auto it = workers_.find(id);
-    if (it == workers_.end()) return;
-    Worker* worker = it->second;
+    Worker* worker = nullptr;
+    {
+      auto& shard = workerShard(id);
+      WriteLocker locker(&shard.lock);
+      auto it = shard.workers.find(id);
+      if (it == shard.workers.end()) return;
+      worker = it->second;
+      shard.workers.erase(it);
+    }
     if (worker->kind() == WorkerKind::kNative) {
+      Locker locker(&lock_);
       terminating_native_workers_[id] = worker->thread();
     }
-    workers_.erase(it);
   }
 
   void destroyWorkerUnlocked(Worker* worker) {
     {
-      Locker locker(&lock_);
       auto id = worker->id();
-      auto it = workers_.find(id);
-      if (it != workers_.end()) {
-        workers_.erase(it);
+      auto& shard = workerShard(id);
+      // Also waits for producers still putting jobs to the worker.
+      WriteLocker locker(&shard.lock);
+      auto it = shard.workers.find(id);
+      if (it != shard.workers.end()) {
+        shard.workers.erase(it);
       }
     }
     GC_UnregisterWorker(worker);
@@ -311,16 +1167,14 @@ class State {
 
   Future* addJobToWorkerUnlocked(
       KInt id, KNativePtr jobFunction, KNativePtr jobArgument, bool toFront, KInt transferMode) {
-    Future* future = nullptr;
-    Worker* worker = nullptr;
-    Locker locker(&lock_);
+    auto& shard = workerShard(id);
+    ReadLocker locker(&shard.lock);
 
-    auto it = workers_.find(id);
-    if (it == workers_.end()) return nullptr;
-    worker = it->second;
+    auto it = shard.workers.find(id);
+    if (it == shard.workers.end()) return nullptr;
+    Worker* worker = it->second;
 
-    future = konanConstructInstance<Future>(nextFutureId());
-    futures_[future->id()] = future;
+    Future* future = addFuture();
 
     Job job;
     if (jobFunction == nullptr) {
@@ -330,6 +1184,7 @@ class State {
     } else {
       job.kind = JOB_REGULAR;
       job.regularJob.function = reinterpret_cast<KRef (*)(KRef, ObjHeader**)>(jobFunction);
+      job.regularJob.operation = nullptr;
       job.regularJob.argument = jobArgument;
       job.regularJob.future = future;
       job.regularJob.transferMode = transferMode;
@@ -340,27 +1195,179 @@ class State {
     return future;
   }
 
-  bool executeJobAfterInWorkerUnlocked(KInt id, KRef operation, KLong afterMicroseconds) {
-    Worker* worker = nullptr;
-    Locker locker(&lock_);
+  // Takes ownership of the stable pointers if succeeded, futures of the jobs get consecutive ids from *first.
+  bool addJobsToWorkerUnlocked(KInt id, const KNativePtr* operations, const KNativePtr* arguments, KInt count,
+      KInt transferMode, KInt* first) {
+    auto& shard = workerShard(id);
+    ReadLocker locker(&shard.lock);
+
+    auto it = shard.workers.find(id);
+    if (it == shard.workers.end()) return false;
+
+    KStdVector<Future*> futures(count);
+    *first = addFuturesUnlocked(count, futures.data());
+    KStdVector<Job> jobs(count);
+    for (KInt index = 0; index < count; index++) {
+      Job& job = jobs[index];
+      job.kind = JOB_REGULAR;
+      job.regularJob.function = nullptr;
+      job.regularJob.operation = operations[index];
+      job.regularJob.argument = arguments[index];
+      job.regularJob.future = futures[index];
+      job.regularJob.transferMode = transferMode;
+    }
+    it->second->putJobs(jobs.data(), count);
+    return true;
+  }
+
+  WorkerPool* addPoolUnlocked(KInt size, bool errorReporting) {
+    WorkerPool* pool = konanConstructInstance<WorkerPool>(nextWorkerId(), size, errorReporting);
+    if (pool == nullptr) return nullptr;
+    WriteLocker locker(&poolsLock_);
+    pools_[pool->id()] = pool;
+    return pool;
+  }
+
+  // Removed pool is not visible for submission from outside anymore.
+  WorkerPool* removePoolUnlocked(KInt id) {
+    WriteLocker locker(&poolsLock_);
+    auto it = pools_.find(id);
+    if (it == pools_.end()) return nullptr;
+    WorkerPool* pool = it->second;
+    pools_.erase(it);
+    return pool;
+  }
 
-    auto it = workers_.find(id);
-    if (it == workers_.end()) {
+  bool submitToPoolUnlocked(KInt id, PoolJob** jobs, KInt count) {
+    // Jobs submitted by the pool's own jobs don't need the lookup, and work even when termination is requested.
+    if (::g_poolThread != nullptr && ::g_poolThread->pool->id() == id) {
+      ::g_poolThread->pool->submit(jobs, count);
+      return true;
+    }
+    ReadLocker locker(&poolsLock_);
+    auto it = pools_.find(id);
+    if (it == pools_.end()) return false;
+    it->second->submit(jobs, count);
+    return true;
+  }
+
+  KInt poolSizeUnlocked(KInt id) {
+    ReadLocker locker(&poolsLock_);
+    auto it = pools_.find(id);
+    if (it == pools_.end()) ThrowWorkerInvalidState();
+    return it->second->size();
+  }
+
+  // Allocates futures with consecutive ids, returns the first one.
+  KInt addFuturesUnlocked(KInt count, Future** futures) {
+    KInt first = __atomic_fetch_add(&currentFutureId_, count, __ATOMIC_RELAXED);
+    KInt shards = count < kStateShards ? count : kStateShards;
+    for (KInt shardIndex = 0; shardIndex < shards; shardIndex++) {
+      auto& shard = futureShard(first + shardIndex);
+      WriteLocker locker(&shard.lock);
+      for (KInt index = shardIndex; index < count; index += kStateShards) {
+        futures[index] = addFutureLocked(shard, first + index);
+      }
+    }
+    return first;
+  }
+
+  // Takes ownership of the operation's stable pointer if succeeded.
+  bool executeOperationInWorkerUnlocked(KInt id, KNativePtr operation) {
+    auto& shard = workerShard(id);
+    ReadLocker locker(&shard.lock);
+
+    auto it = shard.workers.find(id);
+    if (it == shard.workers.end()) {
       return false;
     }
-    worker = it->second;
+    Job job;
+    job.kind = JOB_EXECUTE_AFTER;
+    job.executeAfter.operation = operation;
+    job.executeAfter.whenExecute = 0;
+    it->second->putJob(job, false);
+    return true;
+  }
+
+  KInt addSelectorUnlocked() {
+    CompletionQueue* queue = konanConstructInstance<CompletionQueue>(nextWorkerId());
+    WriteLocker locker(&selectorsLock_);
+    selectors_[queue->id()] = queue;
+    return queue->id();
+  }
+
+  // Returns the queue with the reference taken, or nullptr.
+  CompletionQueue* findSelectorUnlocked(KInt id) {
+    ReadLocker locker(&selectorsLock_);
+    auto it = selectors_.find(id);
+    if (it == selectors_.end()) return nullptr;
+    it->second->addRef();
+    return it->second;
+  }
+
+  bool removeSelectorUnlocked(KInt id) {
+    CompletionQueue* queue = nullptr;
+    {
+      WriteLocker locker(&selectorsLock_);
+      auto it = selectors_.find(id);
+      if (it == selectors_.end()) return false;
+      queue = it->second;
+      selectors_.erase(it);
+    }
+    queue->close();
+    queue->release();
+    return true;
+  }
+
+  bool addFutureListenerUnlocked(KInt id, const FutureListener& listener) {
+    {
+      auto& shard = futureShard(id);
+      ReadLocker locker(&shard.lock);
+      auto it = shard.futures.find(id);
+      if (it == shard.futures.end()) return false;
+      if (it->second->addListenerUnlocked(listener)) return true;
+    }
+    // Notified without the shard lock, as notification could take the worker shard lock, and adding a job
+    // to the worker takes the future shard lock under it.
+    notifyListener(listener, id);
+    return true;
+  }
+
+  bool executeJobAfterInWorkerUnlocked(KInt id, KRef operation, KLong afterMicroseconds, KLong* handle) {
+    auto& shard = workerShard(id);
+    ReadLocker locker(&shard.lock);
+
+    auto it = shard.workers.find(id);
+    if (it == shard.workers.end()) {
+      return false;
+    }
+    Worker* worker = it->second;
     Job job;
     job.kind = JOB_EXECUTE_AFTER;
     job.executeAfter.operation = CreateStablePointer(operation);
+    job.executeAfter.whenExecute = 0;
     if (afterMicroseconds == 0) {
       worker->putJob(job, false);
+      *handle = kInvalidTimerHandle;
     } else {
-      job.executeAfter.whenExecute = konan::getTimeMicros() + afterMicroseconds;
-      worker->putDelayedJob(job);
+      KLong now = konan::getTimeMicros();
+      KLong whenExecute = afterMicroseconds < INT64_MAX - now ? now + afterMicroseconds : INT64_MAX;
+      *handle = worker->putDelayedJob(job.executeAfter.operation, whenExecute, isPermanentOrFrozen(operation));
     }
     return true;
   }
 
+  bool cancelDelayedJobUnlocked(KInt id, KLong handle) {
+    auto& shard = workerShard(id);
+    ReadLocker locker(&shard.lock);
+
+    auto it = shard.workers.find(id);
+    if (it == shard.workers.end()) {
+      return false;
+    }
+    return it->second->cancelDelayedJob(handle);
+  }
+
   // Returns `true` if something was indeed processed.
   bool processQueueUnlocked(KInt id) {
     // Can only process queue of the current worker.
@@ -376,30 +1383,36 @@ class State {
   }
 
   KInt stateOfFutureUnlocked(KInt id) {
-    Locker locker(&lock_);
-    auto it = futures_.find(id);
-    if (it == futures_.end()) return INVALID;
+    auto& shard = futureShard(id);
+    ReadLocker locker(&shard.lock);
+    auto it = shard.futures.find(id);
+    if (it == shard.futures.end()) return INVALID;
     return it->second->state();
   }
 
   OBJ_GETTER(consumeFutureUnlocked, KInt id) {
     Future* future = nullptr;
+    auto& shard = futureShard(id);
     {
-      Locker locker(&lock_);
-      auto it = futures_.find(id);
-      if (it == futures_.end()) ThrowWorkerInvalidState();
+      ReadLocker locker(&shard.lock);
+      auto it = shard.futures.find(id);
+      if (it == shard.futures.end()) ThrowWorkerInvalidState();
       future = it->second;
-
     }
 
     KRef result = future->consumeResultUnlocked(OBJ_RESULT);
 
     {
-       Locker locker(&lock_);
-       auto it = futures_.find(id);
-       if (it != futures_.end()) {
-         futures_.erase(it);
-         konanDestructInstance(future);
+       WriteLocker locker(&shard.lock);
+       auto it = shard.futures.find(id);
+       if (it != shard.futures.end()) {
+         shard.futures.erase(it);
+         if (shard.pool.size() < kFuturePoolSize) {
+           future->clear();
+           shard.pool.push_back(future);
+         } else {
+           konanDestructInstance(future);
+         }
        }
     }
 
@@ -407,12 +1420,12 @@ class State {
   }
 
   OBJ_GETTER(getWorkerNameUnlocked, KInt id) {
-    Worker* worker = nullptr;
     ObjHolder nameHolder;
     {
-      Locker locker(&lock_);
-      auto it = workers_.find(id);
-      if (it == workers_.end()) {
+      auto& shard = workerShard(id);
+      ReadLocker locker(&shard.lock);
+      auto it = shard.workers.find(id);
+      if (it == shard.workers.end()) {
         ThrowWorkerInvalidState();
       }
       DerefStablePointer(it->second->name(), nameHolder.slot());
@@ -422,34 +1435,37 @@ class State {
 
   KBoolean waitForAnyFuture(KInt version, KInt millis) {
     Locker locker(&lock_);
-    if (version != currentVersion_) return false;
+    __atomic_add_fetch(&versionWaiters_, 1, __ATOMIC_SEQ_CST);
+    if (version != __atomic_load_n(&currentVersion_, __ATOMIC_SEQ_CST)) {
+      __atomic_sub_fetch(&versionWaiters_, 1, __ATOMIC_SEQ_CST);
+      return false;
+    }
 
     if (millis < 0) {
       pthread_cond_wait(&cond_, &lock_);
-      return true;
+    } else {
+      uint64_t nsDelta = millis * 1000000LL;
+      WaitOnCondVar(&cond_, &lock_, nsDelta);
     }
-
-    uint64_t nsDelta = millis * 1000000LL;
-    WaitOnCondVar(&cond_, &lock_, nsDelta);
+    __atomic_sub_fetch(&versionWaiters_, 1, __ATOMIC_SEQ_CST);
     return true;
   }
 
   void signalAnyFuture() {
-    {
+    __atomic_add_fetch(&currentVersion_, 1, __ATOMIC_SEQ_CST);
+    // Waiter either sees the new version, or is already counted and waits on the condition.
+    if (__atomic_load_n(&versionWaiters_, __ATOMIC_SEQ_CST) != 0) {
       Locker locker(&lock_);
-      currentVersion_++;
+      pthread_cond_broadcast(&cond_);
     }
-    pthread_cond_broadcast(&cond_);
   }
 
   KInt versionToken() {
-    Locker locker(&lock_);
-    return currentVersion_;
+    return __atomic_load_n(&currentVersion_, __ATOMIC_SEQ_CST);
   }
 
-  // All those called with lock taken.
-  KInt nextWorkerId() { return currentWorkerId_++; }
-  KInt nextFutureId() { return currentFutureId_++; }
+  KInt nextWorkerId() { return __atomic_fetch_add(&currentWorkerId_, 1, __ATOMIC_RELAXED); }
+  KInt nextFutureId() { return __atomic_fetch_add(&currentFutureId_, 1, __ATOMIC_RELAXED); }
 
   void destroyWorkerThreadDataUnlocked(KInt id) {
     Locker locker(&lock_);
@@ -481,10 +1497,13 @@ class State {
 
   void checkNativeWorkersLeakLocked() {
     size_t remainingNativeWorkers = 0;
-    for (const auto& kvp : workers_) {
-      Worker* worker = kvp.second;
-      if (worker->kind() == WorkerKind::kNative) {
-        ++remainingNativeWorkers;
+    for (auto& shard : workerShards_) {
+      ReadLocker locker(&shard.lock);
+      for (const auto& kvp : shard.workers) {
+        Worker* worker = kvp.second;
+        if (worker->kind() == WorkerKind::kNative) {
+          ++remainingNativeWorkers;
+        }
       }
     }
 
@@ -498,14 +1517,46 @@ class State {
   }
 
  private:
+  WorkerShard& workerShard(KInt id) { return workerShards_[id & (kStateShards - 1)]; }
+  FutureShard& futureShard(KInt id) { return futureShards_[id & (kStateShards - 1)]; }
+
+  Future* addFuture() {
+    KInt id = nextFutureId();
+    auto& shard = futureShard(id);
+    WriteLocker locker(&shard.lock);
+    return addFutureLocked(shard, id);
+  }
+
+  Future* addFutureLocked(FutureShard& shard, KInt id) {
+    Future* future = nullptr;
+    if (shard.pool.size() > 0) {
+      future = shard.pool.back();
+      shard.pool.pop_back();
+    } else {
+      future = konanConstructInstance<Future>();
+    }
+    future->reset(id);
+    shard.futures[id] = future;
+    return future;
+  }
+
+  // Guards terminating_native_workers_ and waiting for futures.
   pthread_mutex_t lock_;
   pthread_cond_t cond_;
-  KStdUnorderedMap<KInt, Future*> futures_;
-  KStdUnorderedMap<KInt, Worker*> workers_;
+  WorkerShard workerShards_[kStateShards];
+  FutureShard futureShards_[kStateShards];
   KStdUnorderedMap<KInt, pthread_t> terminating_native_workers_;
+  // Worker pools, only changed on start and termination.
+  pthread_rwlock_t poolsLock_;
+  KStdUnorderedMap<KInt, WorkerPool*> pools_;
+  // Future selectors.
+  pthread_rwlock_t selectorsLock_;
+  KStdUnorderedMap<KInt, CompletionQueue*> selectors_;
   KInt currentWorkerId_;
   KInt currentFutureId_;
   KInt currentVersion_;
+  // Number of threads in waitForAnyFuture().
+  KInt versionWaiters_;
 };
 
 State* theState() {
@@ -527,38 +1578,108 @@ State* theState() {
 }
 
 void Future::storeResultUnlocked(KNativePtr result, bool ok) {
+  KStdVector<FutureListener> listeners;
+  KInt id;
   {
     Locker locker(&lock_);
-    state_ = ok ? COMPUTED : THROWN;
+    __atomic_store_n(&state_, ok ? COMPUTED : THROWN, __ATOMIC_RELEASE);
     result_ = result;
+    listeners.swap(listeners_);
+    // Future could be consumed and reused as soon as the lock is released.
+    id = id_;
     // Beware here: although manual clearly says that pthread_cond_broadcast() could be called outside
     // of the taken lock, it's not on macOS (as of 10.13.1). If moved outside of the lock,
     // some notifications are missing.
     pthread_cond_broadcast(&cond_);
   }
+  notifyListenersUnlocked(listeners, id);
   theState()->signalAnyFuture();
 }
 
 void Future::cancelUnlocked() {
+  KStdVector<FutureListener> listeners;
+  KInt id;
   {
     Locker locker(&lock_);
-    state_ = CANCELLED;
+    __atomic_store_n(&state_, CANCELLED, __ATOMIC_RELEASE);
     result_ = nullptr;
+    listeners.swap(listeners_);
+    id = id_;
     pthread_cond_broadcast(&cond_);
   }
+  notifyListenersUnlocked(listeners, id);
   theState()->signalAnyFuture();
 }
 
+void Future::notifyListenersUnlocked(KStdVector<FutureListener>& listeners, KInt id) {
+  for (const auto& listener : listeners) {
+    notifyListener(listener, id);
+  }
+}
+
+void notifyListener(const FutureListener& listener, KInt futureId) {
+  if (listener.queue != nullptr) {
+    listener.queue->complete(futureId);
+    listener.queue->release();
+    return;
+  }
+  if (!theState()->executeOperationInWorkerUnlocked(listener.workerId, listener.operation)) {
+    // Worker is already gone, nobody will run the operation.
+    DisposeStablePointer(listener.operation);
+  }
+}
+
 // Defined in RuntimeUtils.kt.
 extern "C" void ReportUnhandledException(KRef e);
 
 KInt startWorker(KBoolean errorReporting, KRef customName) {
   Worker* worker = theState()->addWorkerUnlocked(errorReporting != 0, customName, WorkerKind::kNative);
   if (worker == nullptr) return -1;
-  worker->startEventLoop();
+  worker->startEventLoop(ThreadOptions());
   return worker->id();
 }
 
+KInt startWorkerWithOptions(KBoolean errorReporting, KRef customName, KRef cpus, KInt numaNode, KLong stackSize,
+                            KInt priority) {
+  ThreadOptions options;
+  KStdVector<int> available = nodeCpus(numaNode);
+  if (numaNode < -1 || numaNode >= numaNodeCount() || available.size() == 0) ThrowIllegalArgumentException();
+  if (cpus != nullptr) {
+    const ArrayHeader* array = cpus->array();
+    for (uint32_t index = 0; index < array->count_; index++) {
+      KInt cpu = *IntArrayAddressOfElementAt(array, index);
+      bool found = false;
+      for (int availableCpu : available) found = found || cpu == availableCpu;
+      if (!found) ThrowIllegalArgumentException();
+      options.cpus.push_back(cpu);
+    }
+    if (options.cpus.size() == 0) ThrowIllegalArgumentException();
+  }
+  if (stackSize < 0) ThrowIllegalArgumentException();
+  if (priority != kInheritPriority && (priority < kHighestPriority || priority > kLowestPriority))
+    ThrowIllegalArgumentException();
+  options.numaNode = numaNode;
+  options.stackSize = stackSize;
+  options.priority = priority;
+  Worker* worker = theState()->addWorkerUnlocked(errorReporting != 0, customName, WorkerKind::kNative);
+  if (worker == nullptr) return -1;
+  worker->startEventLoop(options);
+  return worker->id();
+}
+
+KInt numaNodes() {
+  return numaNodeCount();
+}
+
+OBJ_GETTER(cpusOfNode, KInt node) {
+  KStdVector<int> cpus = nodeCpus(node);
+  ArrayHeader* result = AllocArrayInstance(theIntArrayTypeInfo, cpus.size(), OBJ_RESULT)->array();
+  for (size_t index = 0; index < cpus.size(); index++) {
+    *IntArrayAddressOfElementAt(result, index) = cpus[index];
+  }
+  RETURN_OBJ(result->obj());
+}
+
 KInt currentWorker() {
   if (g_worker == nullptr) ThrowWorkerInvalidState();
   return ::g_worker->id();
@@ -574,9 +1695,54 @@ KInt execute(KInt id, KInt transferMode, KRef producer, KNativePtr jobFunction)
   return future->id();
 }
 
-void executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
-  if (!theState()->executeJobAfterInWorkerUnlocked(id, job, afterMicroseconds))
+// Arguments are transferred with a single check, so they may share objects, as all the jobs run on the same worker.
+KInt executeBatch(KInt id, KInt transferMode, KInt count, KRef producer, KRef function) {
+  if (count <= 0) ThrowIllegalArgumentException();
+  KStdVector<ObjHeader*> roots;
+  KStdVector<KNativePtr> arguments;
+  roots.reserve(count);
+  arguments.reserve(count);
+  try {
+    for (KInt index = 0; index < count; index++) {
+      ObjHolder holder;
+      WorkerPoolProducerLaunchpad(producer, index, holder.slot());
+      // Stable pointer keeps the argument alive once the holder is gone.
+      arguments.push_back(CreateStablePointer(holder.obj()));
+      roots.push_back(holder.obj());
+    }
+  } catch (...) {
+    for (auto argument : arguments) DisposeStablePointer(argument);
+    throw;
+  }
+  if (!ClearSubgraphsReferences(roots.data(), count, transferMode == CHECKED)) {
+    for (auto argument : arguments) DisposeStablePointer(argument);
+    ThrowWorkerInvalidState();
+  }
+
+  KStdVector<KNativePtr> operations(count);
+  for (KInt index = 0; index < count; index++) {
+    operations[index] = CreateStablePointer(function);
+  }
+  KInt first = 0;
+  if (!theState()->addJobsToWorkerUnlocked(id, operations.data(), arguments.data(), count, transferMode, &first)) {
+    for (KInt index = 0; index < count; index++) {
+      DisposeStablePointer(operations[index]);
+      DisposeStablePointer(arguments[index]);
+    }
+    ThrowWorkerInvalidState();
+  }
+  return first;
+}
+
+KLong executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
+  KLong handle = kInvalidTimerHandle;
+  if (!theState()->executeJobAfterInWorkerUnlocked(id, job, afterMicroseconds, &handle))
     ThrowWorkerInvalidState();
+  return handle;
+}
+
+KBoolean cancelDelayed(KInt id, KLong handle) {
+  return theState()->cancelDelayedJobUnlocked(id, handle);
 }
 
 KBoolean processQueue(KInt id) {
@@ -628,12 +1794,209 @@ KNativePtr detachObjectGraphInternal(KInt transferMode, KRef producer) {
    }
 }
 
+KNativePtr detachObjectRegionInternal(KInt transferMode, KRef producer) {
+  void* region = CreateObjectRegion();
+  ObjHolder result;
+  bool thrownFromRegion = false;
+  EnterObjectRegion(region, true);
+  try {
+    WorkerLaunchpad(producer, result.slot());
+  } catch (ExceptionObjHolder& e) {
+    if (!IsInObjectRegion(region, e.obj())) {
+      LeaveObjectRegion(region);
+      ReleaseObjectRegion(region);
+      throw;
+    }
+    // Exception allocated in the region cannot outlive it, so it is replaced once its holder is gone.
+    thrownFromRegion = true;
+  } catch (...) {
+    LeaveObjectRegion(region);
+    ReleaseObjectRegion(region);
+    throw;
+  }
+  LeaveObjectRegion(region);
+  if (thrownFromRegion) {
+    ReleaseObjectRegion(region);
+    ThrowWorkerInvalidState();
+  }
+  bool sealed = SealObjectRegion(region, result.obj(), transferMode == CHECKED);
+  result.clear();
+  if (!sealed) {
+    ReleaseObjectRegion(region);
+    ThrowWorkerInvalidState();
+  }
+  return region;
+}
+
+OBJ_GETTER(consumeObjectRegionInternal, KNativePtr region, KRef consumer) {
+  ObjHolder root;
+  ObjectRegionRoot(region, root.slot());
+  // Region objects stored anywhere by the consumer, including the objects of its result, are counted.
+  EnterObjectRegion(region, false);
+  try {
+    WorkerPoolJobLaunchpad(consumer, root.obj(), OBJ_RESULT);
+  } catch (...) {
+    root.clear();
+    LeaveObjectRegion(region);
+    ReleaseObjectRegion(region);
+    throw;
+  }
+  root.clear();
+  LeaveObjectRegion(region);
+  bool escapes = IsInObjectRegion(region, *OBJ_RESULT);
+  if (escapes) UpdateReturnRef(OBJ_RESULT, nullptr);
+  if (!ReleaseObjectRegion(region) || escapes) {
+    UpdateReturnRef(OBJ_RESULT, nullptr);
+    ThrowWorkerInvalidState();
+  }
+  return *OBJ_RESULT;
+}
+
+void onFutureComplete(KInt id, KInt workerId, KRef operation) {
+  FutureListener listener = { nullptr, workerId, CreateStablePointer(operation) };
+  if (!theState()->addFutureListenerUnlocked(id, listener)) {
+    DisposeStablePointer(listener.operation);
+    ThrowWorkerInvalidState();
+  }
+}
+
+KInt createSelector() {
+  return theState()->addSelectorUnlocked();
+}
+
+void registerInSelector(KInt id, KInt futureId) {
+  CompletionQueue* queue = theState()->findSelectorUnlocked(id);
+  if (queue == nullptr) ThrowWorkerInvalidState();
+  queue->registerFuture();
+  // Reference taken above is passed to the listener.
+  FutureListener listener = { queue, 0, nullptr };
+  if (!theState()->addFutureListenerUnlocked(futureId, listener)) {
+    queue->unregisterFuture();
+    queue->release();
+    ThrowWorkerInvalidState();
+  }
+}
+
+OBJ_GETTER(selectFromSelector, KInt id, KInt millis) {
+  CompletionQueue* queue = theState()->findSelectorUnlocked(id);
+  if (queue == nullptr) ThrowWorkerInvalidState();
+  KStdVector<KInt> ready;
+  queue->take(millis, &ready);
+  queue->release();
+  ArrayHeader* result = AllocArrayInstance(theIntArrayTypeInfo, ready.size(), OBJ_RESULT)->array();
+  for (size_t index = 0; index < ready.size(); index++) {
+    *IntArrayAddressOfElementAt(result, index) = ready[index];
+  }
+  RETURN_OBJ(result->obj());
+}
+
+KInt pendingInSelector(KInt id) {
+  CompletionQueue* queue = theState()->findSelectorUnlocked(id);
+  if (queue == nullptr) ThrowWorkerInvalidState();
+  KInt result = queue->pending();
+  queue->release();
+  return result;
+}
+
+void closeSelector(KInt id) {
+  if (!theState()->removeSelectorUnlocked(id)) ThrowWorkerInvalidState();
+}
+
+KInt startPool(KInt size, KBoolean errorReporting) {
+  if (size <= 0) size = konan::availableProcessors();
+  if (size > kMaxPoolSize) size = kMaxPoolSize;
+  WorkerPool* pool = theState()->addPoolUnlocked(size, errorReporting != 0);
+  if (pool == nullptr) return -1;
+  if (!pool->start()) {
+    theState()->removePoolUnlocked(pool->id());
+    pool->terminate();
+    konanDestructInstance(pool);
+    ThrowIllegalStateException();
+  }
+  return pool->id();
+}
+
+KInt poolSize(KInt id) {
+  return theState()->poolSizeUnlocked(id);
+}
+
+KInt executeBatchInPool(KInt id, KInt transferMode, KInt count, KRef producer, KRef function) {
+  if (count <= 0) ThrowIllegalArgumentException();
+  KStdVector<PoolJob*> jobs;
+  jobs.reserve(count);
+  try {
+    for (KInt index = 0; index < count; index++) {
+      ObjHolder holder;
+      WorkerPoolProducerLaunchpad(producer, index, holder.slot());
+      KNativePtr argument = transfer(&holder, transferMode);
+      PoolJob* job = konanConstructInstance<PoolJob>();
+      job->function = CreateStablePointer(function);
+      job->argument = argument;
+      job->transferMode = transferMode;
+      jobs.push_back(job);
+    }
+  } catch (...) {
+    for (auto* job : jobs) {
+      DisposeStablePointer(job->function);
+      DisposeStablePointer(job->argument);
+      konanDestructInstance(job);
+    }
+    throw;
+  }
+
+  KStdVector<Future*> futures(count);
+  KInt first = theState()->addFuturesUnlocked(count, futures.data());
+  for (KInt index = 0; index < count; index++) {
+    jobs[index]->future = futures[index];
+  }
+  if (!theState()->submitToPoolUnlocked(id, jobs.data(), count)) {
+    for (auto* job : jobs) {
+      DisposeStablePointer(job->function);
+      DisposeStablePointer(job->argument);
+      job->future->cancelUnlocked();
+      konanDestructInstance(job);
+    }
+    ThrowWorkerInvalidState();
+  }
+  return first;
+}
+
+void awaitInPool(KInt id, KInt futureId) {
+  // Other threads just block on the future.
+  if (::g_poolThread == nullptr || ::g_poolThread->pool->id() != id) return;
+  ::g_poolThread->pool->helpUntilDone(futureId);
+}
+
+void terminatePool(KInt id) {
+  // Pool's thread cannot wait for itself.
+  if (::g_poolThread != nullptr && ::g_poolThread->pool->id() == id) ThrowWorkerInvalidState();
+  WorkerPool* pool = theState()->removePoolUnlocked(id);
+  if (pool == nullptr) ThrowWorkerInvalidState();
+  pool->terminate();
+  konanDestructInstance(pool);
+}
+
 #else
 
 KInt startWorker(KBoolean errorReporting, KRef customName) {
   ThrowWorkerUnsupported();
 }
 
+KInt startWorkerWithOptions(KBoolean errorReporting, KRef customName, KRef cpus, KInt numaNode, KLong stackSize,
+                            KInt priority) {
+  ThrowWorkerUnsupported();
+}
+
+KInt numaNodes() {
+  return 1;
+}
+
+OBJ_GETTER(cpusOfNode, KInt node) {
+  ArrayHeader* result = AllocArrayInstance(theIntArrayTypeInfo, node > 0 ? 0 : 1, OBJ_RESULT)->array();
+  if (node <= 0) *IntArrayAddressOfElementAt(result, 0) = 0;
+  RETURN_OBJ(result->obj());
+}
+
 KInt stateOfFuture(KInt id) {
   ThrowWorkerUnsupported();
 }
@@ -642,7 +2005,15 @@ KInt execute(KInt id, KInt transferMode, KRef producer, KNativePtr jobFunction)
   ThrowWorkerUnsupported();
 }
 
-void executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
+KInt executeBatch(KInt id, KInt transferMode, KInt count, KRef producer, KRef function) {
+  ThrowWorkerUnsupported();
+}
+
+KLong executeAfter(KInt id, KRef job, KLong afterMicroseconds) {
+  ThrowWorkerUnsupported();
+}
+
+KBoolean cancelDelayed(KInt id, KLong handle) {
   ThrowWorkerUnsupported();
 }
 
@@ -686,6 +2057,58 @@ KNativePtr detachObjectGraphInternal(KInt transferMode, KRef producer) {
    ThrowWorkerUnsupported();
 }
 
+KNativePtr detachObjectRegionInternal(KInt transferMode, KRef producer) {
+  ThrowWorkerUnsupported();
+}
+
+OBJ_GETTER(consumeObjectRegionInternal, KNativePtr region, KRef consumer) {
+  ThrowWorkerUnsupported();
+}
+
+void onFutureComplete(KInt id, KInt workerId, KRef operation) {
+  ThrowWorkerUnsupported();
+}
+
+KInt createSelector() {
+  ThrowWorkerUnsupported();
+}
+
+void registerInSelector(KInt id, KInt futureId) {
+  ThrowWorkerUnsupported();
+}
+
+OBJ_GETTER(selectFromSelector, KInt id, KInt millis) {
+  ThrowWorkerUnsupported();
+}
+
+KInt pendingInSelector(KInt id) {
+  ThrowWorkerUnsupported();
+}
+
+void closeSelector(KInt id) {
+  ThrowWorkerUnsupported();
+}
+
+KInt startPool(KInt size, KBoolean errorReporting) {
+  ThrowWorkerUnsupported();
+}
+
+KInt poolSize(KInt id) {
+  ThrowWorkerUnsupported();
+}
+
+KInt executeBatchInPool(KInt id, KInt transferMode, KInt count, KRef producer, KRef function) {
+  ThrowWorkerUnsupported();
+}
+
+void awaitInPool(KInt id, KInt futureId) {
+  ThrowWorkerUnsupported();
+}
+
+void terminatePool(KInt id) {
+  ThrowWorkerUnsupported();
+}
+
 #endif  // WITH_WORKERS
 
 }  // namespace
@@ -746,11 +2169,12 @@ void WorkerResume(Worker* worker) {
 
 #if WITH_WORKERS
 
-Worker::~Worker() {
-  // Cleanup jobs in the queue.
-  for (auto job : queue_) {
+namespace {
+
+void disposeJob(Job job) {
     switch (job.kind) {
       case JOB_REGULAR:
+        DisposeStablePointer(job.regularJob.operation);
         DisposeStablePointer(job.regularJob.argument);
         job.regularJob.future->cancelUnlocked();
         break;
@@ -769,12 +2193,23 @@ Worker::~Worker() {
         break;
       }
     }
-  }
+}
 
-  for (auto job : delayed_) {
-    RuntimeAssert(job.kind == JOB_EXECUTE_AFTER, "Must be delayed");
-    DisposeStablePointer(job.executeAfter.operation);
+}  // namespace
+
+Worker::~Worker() {
+  // Cleanup jobs in the queues, nobody could put new ones at this point.
+  for (auto job : queue_) {
+    disposeJob(job);
   }
+  while (JobNode* node = incoming_.pop()) {
+    disposeJob(node->job);
+    konanDestructInstance(node);
+  }
+
+  delayed_.clear([](KNativePtr operation) {
+    DisposeStablePointer(operation);
+  });
 
   if (name_ != nullptr) DisposeStablePointer(name_);
 
@@ -787,6 +2222,7 @@ namespace {
 void* workerRoutine(void* argument) {
   Worker* worker = reinterpret_cast<Worker*>(argument);
 
+  applyThreadOptions(worker->threadOptions());
   WorkerResume(worker);
   Kotlin_initRuntimeIfNeeded();
 
@@ -803,23 +2239,89 @@ void* workerRoutine(void* argument) {
 
 }  // namespace
 
-void Worker::startEventLoop() {
-  pthread_create(&thread_, nullptr, workerRoutine, this);
+void Worker::startEventLoop(const ThreadOptions& options) {
+  threadOptions_ = options;
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  if (options.stackSize > 0) {
+    size_t minStackSize = konan::minThreadStackSize();
+    size_t stackSize = static_cast<size_t>(options.stackSize) < minStackSize ? minStackSize : options.stackSize;
+    // Some platforms require stack size to be a multiple of the page size.
+    size_t pageSize = konan::pageSize();
+    stackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+    pthread_attr_setstacksize(&attributes, stackSize);
+  }
+  pthread_create(&thread_, &attributes, workerRoutine, this);
+  pthread_attr_destroy(&attributes);
 }
 
 void Worker::putJob(Job job, bool toFront) {
-  Locker locker(&lock_);
-  if (toFront)
+  if (toFront) {
+    Locker locker(&lock_);
     queue_.push_front(job);
-  else
-    queue_.push_back(job);
-  pthread_cond_signal(&cond_);
+    __atomic_store_n(&queueSize_, queue_.size(), __ATOMIC_SEQ_CST);
+    pthread_cond_signal(&cond_);
+    return;
+  }
+  putJobs(&job, 1);
+}
+
+void Worker::putJobs(const Job* jobs, KInt count) {
+  JobNode* first = nullptr;
+  JobNode* last = nullptr;
+  for (KInt index = 0; index < count; index++) {
+    JobNode* node = konanConstructInstance<JobNode>();
+    node->job = jobs[index];
+    if (last == nullptr)
+      first = node;
+    else
+      last->next = node;
+    last = node;
+  }
+  __atomic_add_fetch(&incomingSize_, count, __ATOMIC_SEQ_CST);
+  incoming_.push(first, last);
+  // Worker sets waiting_ and then checks incomingSize_, so it either sees the job or gets signalled.
+  if (__atomic_load_n(&waiting_, __ATOMIC_SEQ_CST)) {
+    Locker locker(&lock_);
+    pthread_cond_signal(&cond_);
+  }
 }
 
-void Worker::putDelayedJob(Job job) {
+KLong Worker::putDelayedJob(KNativePtr operation, KLong whenExecute, bool frozen) {
   Locker locker(&lock_);
-  delayed_.insert(job);
+  KLong handle = delayed_.add(whenExecute, operation, frozen);
+  if (handle == kInvalidTimerHandle) {
+    Job job;
+    job.kind = JOB_EXECUTE_AFTER;
+    job.executeAfter.operation = operation;
+    job.executeAfter.whenExecute = whenExecute;
+    queue_.push_back(job);
+    __atomic_store_n(&queueSize_, queue_.size(), __ATOMIC_SEQ_CST);
+  }
   pthread_cond_signal(&cond_);
+  return handle;
+}
+
+bool Worker::cancelDelayedJob(KLong handle) {
+  KNativePtr operation = nullptr;
+  bool frozen = false;
+  {
+    Locker locker(&lock_);
+    if (!delayed_.cancel(handle, &operation, &frozen)) return false;
+    if (!frozen && ::g_worker != this) {
+      // Only the owner could dispose operation which is not frozen.
+      Job job;
+      job.kind = JOB_EXECUTE_AFTER;
+      job.executeAfter.operation = operation;
+      job.executeAfter.whenExecute = kCancelledJob;
+      queue_.push_back(job);
+      __atomic_store_n(&queueSize_, queue_.size(), __ATOMIC_SEQ_CST);
+      pthread_cond_signal(&cond_);
+      return true;
+    }
+  }
+  DisposeStablePointer(operation);
+  return true;
 }
 
 bool Worker::waitDelayed(bool blocking) {
@@ -830,44 +2332,86 @@ bool Worker::waitDelayed(bool blocking) {
 }
 
 Job Worker::getJob(bool blocking) {
-  Locker locker(&lock_);
   RuntimeAssert(!terminated_, "Must not be terminated");
-  if (queue_.size() == 0 && !blocking) return Job { .kind = JOB_NONE };
-  waitForQueueLocked(-1, nullptr);
-  auto result = queue_.front();
-  queue_.pop_front();
-  return result;
+  while (true) {
+    if (__atomic_load_n(&queueSize_, __ATOMIC_SEQ_CST) != 0) {
+      Locker locker(&lock_);
+      if (queue_.size() != 0) {
+        auto result = queue_.front();
+        queue_.pop_front();
+        __atomic_store_n(&queueSize_, queue_.size(), __ATOMIC_SEQ_CST);
+        return result;
+      }
+    }
+    if (JobNode* node = incoming_.pop()) {
+      __atomic_sub_fetch(&incomingSize_, 1, __ATOMIC_SEQ_CST);
+      auto result = node->job;
+      konanDestructInstance(node);
+      return result;
+    }
+    if (__atomic_load_n(&incomingSize_, __ATOMIC_SEQ_CST) != 0) {
+      // Some producer is in the middle of putting the job.
+      sched_yield();
+      continue;
+    }
+    if (!blocking) return Job { .kind = JOB_NONE };
+    Locker locker(&lock_);
+    waitForQueueLocked(-1, nullptr);
+  }
 }
 
 KLong Worker::checkDelayedLocked() {
   if (delayed_.size() == 0) {
     return -1;
   }
-  auto it = delayed_.begin();
-  auto job = *it;
-  RuntimeAssert(job.kind == JOB_EXECUTE_AFTER, "Must be delayed job");
-  auto now = konan::getTimeMicros();
-  if (job.executeAfter.whenExecute <= now) {
-    delayed_.erase(it);
+  KLong now = konan::getTimeMicros();
+  bool expired = false;
+  KLong remaining = delayed_.expire(now, [this, now, &expired](KNativePtr operation) {
+    Job job;
+    job.kind = JOB_EXECUTE_AFTER;
+    job.executeAfter.operation = operation;
+    job.executeAfter.whenExecute = now;
     queue_.push_back(job);
+    expired = true;
+  });
+  if (expired) {
+    __atomic_store_n(&queueSize_, queue_.size(), __ATOMIC_SEQ_CST);
     return 0;
-  } else {
-    return job.executeAfter.whenExecute - now;
   }
+  return remaining;
+}
+
+bool Worker::spinForJobsLocked() {
+  pthread_mutex_unlock(&lock_);
+  SpinBackoff backoff;
+  bool arrived = false;
+  while (!arrived && backoff.spin()) {
+    arrived = __atomic_load_n(&queueSize_, __ATOMIC_SEQ_CST) != 0 ||
+        __atomic_load_n(&incomingSize_, __ATOMIC_SEQ_CST) != 0;
+  }
+  pthread_mutex_lock(&lock_);
+  return arrived;
 }
 
 bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining) {
-  while (queue_.size() == 0) {
+  bool spun = false;
+  while (!hasJobsLocked()) {
     KLong closestToRunMicroseconds = checkDelayedLocked();
     if (closestToRunMicroseconds == 0) {
         continue;
     }
+    // Jobs put right away are handed off without producer signalling the condition and us sleeping on it.
+    if (!spun && timeoutMicroseconds != 0) {
+      spun = true;
+      if (spinForJobsLocked()) continue;
+    }
     if (timeoutMicroseconds >= 0) {
         closestToRunMicroseconds = (timeoutMicroseconds < closestToRunMicroseconds || closestToRunMicroseconds < 0)
           ? timeoutMicroseconds
           : closestToRunMicroseconds;
     }
-    if (closestToRunMicroseconds == 0) {
+    __atomic_store_n(&waiting_, true, __ATOMIC_SEQ_CST);
+    if (closestToRunMicroseconds == 0 || hasJobsLocked()) {
       // Just no wait at all here.
     } else if (closestToRunMicroseconds > 0) {
       // Protect from potential overflow, cutting at 10_000_000 seconds, aka 115 days.
@@ -883,7 +2427,8 @@ bool Worker::waitForQueueLocked(KLong timeoutMicroseconds, KLong* remaining) {
       pthread_cond_wait(&cond_, &lock_);
       if (remaining) *remaining = 0;
     }
-    if (timeoutMicroseconds >= 0) return queue_.size() != 0;
+    __atomic_store_n(&waiting_, false, __ATOMIC_SEQ_CST);
+    if (timeoutMicroseconds >= 0) return hasJobsLocked();
   }
   return true;
 }
@@ -933,6 +2478,10 @@ JobKind Worker::processQueueElement(bool blocking) {
       break;
     }
     case JOB_EXECUTE_AFTER: {
+      if (job.executeAfter.whenExecute == kCancelledJob) {
+        DisposeStablePointer(job.executeAfter.operation);
+        return JOB_NONE;
+      }
       ObjHolder operationHolder, dummyHolder;
       KRef obj = DerefStablePointer(job.executeAfter.operation, operationHolder.slot());
       try {
@@ -949,7 +2498,13 @@ JobKind Worker::processQueueElement(bool blocking) {
       KNativePtr result = nullptr;
       bool ok = true;
       try {
-        job.regularJob.function(argument, resultHolder.slot());
+        if (job.regularJob.operation != nullptr) {
+          ObjHolder operationHolder;
+          KRef operation = DerefStablePointer(job.regularJob.operation, operationHolder.slot());
+          WorkerPoolJobLaunchpad(operation, argument, resultHolder.slot());
+        } else {
+          job.regularJob.function(argument, resultHolder.slot());
+        }
         argumentHolder.clear();
         // Transfer the result.
         result = transfer(&resultHolder, job.regularJob.transferMode);
@@ -958,6 +2513,7 @@ JobKind Worker::processQueueElement(bool blocking) {
          if (errorReporting())
            ReportUnhandledException(e.obj());
        }
+       DisposeStablePointer(job.regularJob.operation);
        // Notify the future.
        job.regularJob.future->storeResultUnlocked(result, ok);
        break;
@@ -969,6 +2525,201 @@ JobKind Worker::processQueueElement(bool blocking) {
   return job.kind;
 }
 
+namespace {
+
+void* poolThreadRoutine(void* argument) {
+  PoolThread* self = reinterpret_cast<PoolThread*>(argument);
+  self->pool->run(self);
+  return nullptr;
+}
+
+}  // namespace
+
+WorkerPool::WorkerPool(KInt id, KInt size, bool errorReporting)
+    : id_(id), size_(size), errorReporting_(errorReporting) {
+  pthread_mutex_init(&injectedLock_, nullptr);
+  pthread_mutex_init(&lock_, nullptr);
+  pthread_cond_init(&cond_, nullptr);
+  threads_.reserve(size);
+  for (KInt index = 0; index < size; index++) {
+    threads_.push_back(konanConstructInstance<PoolThread>(this, index));
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  for (auto* job : injected_) {
+    DisposeStablePointer(job->function);
+    DisposeStablePointer(job->argument);
+    job->future->cancelUnlocked();
+    konanDestructInstance(job);
+  }
+  for (auto* thread : threads_) {
+    konanDestructInstance(thread);
+  }
+  pthread_mutex_destroy(&injectedLock_);
+  pthread_mutex_destroy(&lock_);
+  pthread_cond_destroy(&cond_);
+}
+
+bool WorkerPool::start() {
+  for (auto* thread : threads_) {
+    thread->worker = theState()->addWorkerUnlocked(errorReporting_, nullptr, WorkerKind::kOther);
+    if (thread->worker == nullptr) return false;
+    if (pthread_create(&thread->thread, nullptr, poolThreadRoutine, thread) != 0) {
+      theState()->destroyWorkerUnlocked(thread->worker);
+      thread->worker = nullptr;
+      return false;
+    }
+    thread->started = true;
+  }
+  return true;
+}
+
+void WorkerPool::submit(PoolJob** jobs, KInt count) {
+  if (::g_poolThread != nullptr && ::g_poolThread->pool == this) {
+    for (KInt index = 0; index < count; index++) {
+      ::g_poolThread->deque.push(jobs[index]);
+    }
+  } else {
+    Locker locker(&injectedLock_);
+    for (KInt index = 0; index < count; index++) {
+      injected_.push_back(jobs[index]);
+    }
+    __atomic_store_n(&injectedSize_, injected_.size(), __ATOMIC_SEQ_CST);
+  }
+  wakeUp(count);
+}
+
+void WorkerPool::wakeUp(KInt count) {
+  // Sleeping thread counts itself in sleepers_ and then checks for work, so it either sees the job or gets signalled.
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&sleepers_, __ATOMIC_SEQ_CST) == 0) return;
+  Locker locker(&lock_);
+  if (count > 1)
+    pthread_cond_broadcast(&cond_);
+  else
+    pthread_cond_signal(&cond_);
+}
+
+bool WorkerPool::hasWork() const {
+  if (__atomic_load_n(&injectedSize_, __ATOMIC_SEQ_CST) != 0) return true;
+  for (auto* thread : threads_) {
+    if (!thread->deque.empty()) return true;
+  }
+  return false;
+}
+
+PoolJob* WorkerPool::findJob(PoolThread* self) {
+  if (PoolJob* job = self->deque.take()) return job;
+  if (PoolJob* job = takeInjected(self)) return job;
+  return steal(self);
+}
+
+PoolJob* WorkerPool::takeInjected(PoolThread* self) {
+  if (__atomic_load_n(&injectedSize_, __ATOMIC_SEQ_CST) == 0) return nullptr;
+  Locker locker(&injectedLock_);
+  if (injected_.size() == 0) return nullptr;
+  PoolJob* result = injected_.front();
+  injected_.pop_front();
+  // Take a fair share of the rest, so that other threads could steal it without the lock.
+  size_t share = injected_.size() / size_;
+  if (share > kInjectedBatch) share = kInjectedBatch;
+  for (size_t index = 0; index < share; index++) {
+    self->deque.push(injected_.front());
+    injected_.pop_front();
+  }
+  __atomic_store_n(&injectedSize_, injected_.size(), __ATOMIC_SEQ_CST);
+  return result;
+}
+
+PoolJob* WorkerPool::steal(PoolThread* self) {
+  if (size_ < 2) return nullptr;
+  while (true) {
+    bool lost = false;
+    // Xorshift is good enough to spread thieves over victims.
+    uint32_t random = self->random;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    self->random = random;
+    KInt start = random % size_;
+    for (KInt index = 0; index < size_; index++) {
+      PoolThread* victim = threads_[(start + index) % size_];
+      if (victim == self) continue;
+      if (PoolJob* job = victim->deque.steal(&lost)) return job;
+    }
+    if (!lost) return nullptr;
+  }
+}
+
+void WorkerPool::runJob(PoolJob* job) {
+  GC_CollectorCallback(::g_poolThread->worker);
+  ObjHolder functionHolder;
+  ObjHolder argumentHolder;
+  ObjHolder resultHolder;
+  KRef function = DerefStablePointer(job->function, functionHolder.slot());
+  KRef argument = AdoptStablePointer(job->argument, argumentHolder.slot());
+  KNativePtr result = nullptr;
+  bool ok = true;
+  try {
+    WorkerPoolJobLaunchpad(function, argument, resultHolder.slot());
+    argumentHolder.clear();
+    result = transfer(&resultHolder, job->transferMode);
+  } catch (ExceptionObjHolder& e) {
+    ok = false;
+    if (errorReporting_)
+      ReportUnhandledException(e.obj());
+  }
+  DisposeStablePointer(job->function);
+  Future* future = job->future;
+  konanDestructInstance(job);
+  future->storeResultUnlocked(result, ok);
+}
+
+void WorkerPool::helpUntilDone(KInt futureId) {
+  RuntimeAssert(::g_poolThread != nullptr && ::g_poolThread->pool == this, "Must be called on the pool thread");
+  while (theState()->stateOfFutureUnlocked(futureId) == SCHEDULED) {
+    PoolJob* job = findJob(::g_poolThread);
+    // Awaited job is already being run by some other thread.
+    if (job == nullptr) return;
+    runJob(job);
+  }
+}
+
+void WorkerPool::run(PoolThread* self) {
+  ::g_poolThread = self;
+  // Runtime adopts the worker registered in start(), see workerRoutine().
+  WorkerResume(self->worker);
+  Kotlin_initRuntimeIfNeeded();
+
+  while (true) {
+    if (PoolJob* job = findJob(self)) {
+      runJob(job);
+      continue;
+    }
+    Locker locker(&lock_);
+    if (terminating_) break;
+    __atomic_add_fetch(&sleepers_, 1, __ATOMIC_SEQ_CST);
+    if (!hasWork()) pthread_cond_wait(&cond_, &lock_);
+    __atomic_sub_fetch(&sleepers_, 1, __ATOMIC_SEQ_CST);
+  }
+
+  ::g_poolThread = nullptr;
+  // See workerRoutine().
+  Kotlin_zeroOutTLSGlobals();
+}
+
+void WorkerPool::terminate() {
+  {
+    Locker locker(&lock_);
+    terminating_ = true;
+    pthread_cond_broadcast(&cond_);
+  }
+  for (auto* thread : threads_) {
+    if (thread->started) pthread_join(thread->thread, nullptr);
+  }
+}
+
 #endif  // WITH_WORKERS
 
 extern "C" {
@@ -977,6 +2728,19 @@ KInt Kotlin_Worker_startInternal(KBoolean noErrorReporting, KRef customName) {
   return startWorker(noErrorReporting, customName);
 }
 
+KInt Kotlin_Worker_startWithOptionsInternal(KBoolean errorReporting, KRef customName, KRef cpus, KInt numaNode,
+                                            KLong stackSize, KInt priority) {
+  return startWorkerWithOptions(errorReporting, customName, cpus, numaNode, stackSize, priority);
+}
+
+KInt Kotlin_Worker_numaNodesInternal() {
+  return numaNodes();
+}
+
+OBJ_GETTER(Kotlin_Worker_cpusInternal, KInt node) {
+  RETURN_RESULT_OF(cpusOfNode, node);
+}
+
 KInt Kotlin_Worker_currentInternal() {
   return currentWorker();
 }
@@ -989,8 +2753,16 @@ KInt Kotlin_Worker_executeInternal(KInt id, KInt transferMode, KRef producer, KN
   return execute(id, transferMode, producer, job);
 }
 
-void Kotlin_Worker_executeAfterInternal(KInt id, KRef job, KLong afterMicroseconds) {
-  executeAfter(id, job, afterMicroseconds);
+KInt Kotlin_Worker_executeBatchInternal(KInt id, KInt transferMode, KInt count, KRef producer, KRef job) {
+  return executeBatch(id, transferMode, count, producer, job);
+}
+
+KLong Kotlin_Worker_executeAfterInternal(KInt id, KRef job, KLong afterMicroseconds) {
+  return executeAfter(id, job, afterMicroseconds);
+}
+
+KBoolean Kotlin_Worker_cancelDelayedInternal(KInt id, KLong handle) {
+  return cancelDelayed(id, handle);
 }
 
 KBoolean Kotlin_Worker_processQueueInternal(KInt id) {
@@ -1029,6 +2801,58 @@ KNativePtr Kotlin_Worker_detachObjectGraphInternal(KInt transferMode, KRef produ
   return detachObjectGraphInternal(transferMode, producer);
 }
 
+KNativePtr Kotlin_Worker_detachObjectRegionInternal(KInt transferMode, KRef producer) {
+  return detachObjectRegionInternal(transferMode, producer);
+}
+
+OBJ_GETTER(Kotlin_Worker_consumeObjectRegionInternal, KNativePtr region, KRef consumer) {
+  RETURN_RESULT_OF(consumeObjectRegionInternal, region, consumer);
+}
+
+void Kotlin_Worker_onCompleteInternal(KInt id, KInt workerId, KRef operation) {
+  onFutureComplete(id, workerId, operation);
+}
+
+KInt Kotlin_FutureSelector_createInternal() {
+  return createSelector();
+}
+
+void Kotlin_FutureSelector_registerInternal(KInt id, KInt futureId) {
+  registerInSelector(id, futureId);
+}
+
+OBJ_GETTER(Kotlin_FutureSelector_selectInternal, KInt id, KInt millis) {
+  RETURN_RESULT_OF(selectFromSelector, id, millis);
+}
+
+KInt Kotlin_FutureSelector_pendingInternal(KInt id) {
+  return pendingInSelector(id);
+}
+
+void Kotlin_FutureSelector_closeInternal(KInt id) {
+  closeSelector(id);
+}
+
+KInt Kotlin_WorkerPool_startInternal(KInt size, KBoolean errorReporting) {
+  return startPool(size, errorReporting);
+}
+
+KInt Kotlin_WorkerPool_sizeInternal(KInt id) {
+  return poolSize(id);
+}
+
+KInt Kotlin_WorkerPool_executeBatchInternal(KInt id, KInt transferMode, KInt count, KRef producer, KRef job) {
+  return executeBatchInPool(id, transferMode, count, producer, job);
+}
+
+void Kotlin_WorkerPool_awaitInternal(KInt id, KInt futureId) {
+  awaitInPool(id, futureId);
+}
+
+void Kotlin_WorkerPool_terminateInternal(KInt id) {
+  terminatePool(id);
+}
+
 void Kotlin_Worker_freezeInternal(KRef object) {
   if (object != nullptr)
     FreezeSubgraph(object);
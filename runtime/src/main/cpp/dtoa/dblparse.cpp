@@ -23,7 +23,6 @@
 #include "../Exceptions.h"
 #include "../KString.h"
 #include "../Natives.h"
-#include "../utf8.h"
 
 #if defined(LINUX) || defined(FREEBSD) || defined(ZOS) || defined(MACOSX) || defined(AIX)
 #define USE_LL
@@ -640,12 +639,11 @@ OutOfMemory:
 
 KDouble Kotlin_native_FloatingPointParser_parseDoubleImpl (KString s, KInt e)
 {
-  const KChar* utf16 = CharArrayAddressOfElementAt(s, 0);
   KStdString utf8;
-  utf8.reserve(s->count_);
-  TRY_CATCH(utf8::utf16to8(utf16, utf16 + s->count_, back_inserter(utf8)),
-            utf8::unchecked::utf16to8(utf16, utf16 + s->count_, back_inserter(utf8)),
-            /* Illegal UTF-16 string. */ ThrowNumberFormatException());
+  if (!StringToUtf8(s, &utf8)) {
+    // Illegal UTF-16 string.
+    ThrowNumberFormatException();
+  }
   const char *str = utf8.c_str();
   auto dbl = createDouble (str, e);
 
@@ -227,7 +227,7 @@ public class AtomicReference<T> {
     // A spinlock to fix potential ARC race.
     private var lock: Int = 0
 
-    // Optimization for speeding up access.
+    // Unused, kept as the runtime relies on the layout of this class.
     private var cookie: Int = 0
 
     /**
@@ -302,7 +302,7 @@ public class FreezableAtomicReference<T>(private var value_: T) {
     // A spinlock to fix potential ARC race.
     private var lock: Int = 0
 
-    // Optimization for speeding up access.
+    // Unused, kept as the runtime relies on the layout of this class.
     private var cookie: Int = 0
 
     /**
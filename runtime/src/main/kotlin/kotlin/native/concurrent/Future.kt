@@ -65,9 +65,58 @@ public inline class Future<T> @PublishedApi internal constructor(val id: Int) {
     public val state: FutureState
         get() = FutureState.values()[stateOfFuture(id)]
 
+    /**
+     * Schedule [callback] for execution on [worker] once the future is completed, whatever the final state is.
+     * If the future is already completed, [callback] is scheduled right away. [callback] must be either frozen,
+     * or scheduled on the current worker, and it shall consume the future itself if the result is needed.
+     *
+     * @throws [IllegalStateException] if [callback] is not frozen and [worker] is not current,
+     * or if the future is in [FutureState.INVALID] state.
+     */
+    public fun onComplete(worker: Worker, callback: (Future<T>) -> Unit) {
+        val frozen = callback.isFrozen
+        if (currentInternal() != worker.id && !frozen) throw IllegalStateException("Callback for another worker must be frozen")
+        val future = this
+        val operation = { callback(future) }
+        onCompleteInternal(id, worker.id, if (frozen) operation.freeze() else operation)
+    }
+
     override public fun toString(): String = "future $id"
 }
 
+/**
+ * Futures with consecutive ids, such as ones of the jobs submitted with [Worker.executeBatch].
+ * Range is just the first id and the size, so no memory is allocated per future.
+ */
+@Frozen
+public class FutureRange<T> internal constructor(
+        @PublishedApi internal val first: Int,
+        /** Number of futures in the range. */
+        public val size: Int) {
+    /**
+     * Returns the future with the given [index].
+     *
+     * @throws [IndexOutOfBoundsException] if [index] is out of range.
+     */
+    public operator fun get(index: Int): Future<T> {
+        if (index < 0 || index >= size) throw IndexOutOfBoundsException("Index $index is out of range of size $size")
+        return Future<T>(first + index)
+    }
+
+    /**
+     * Performs the given [action] on each future in the order of indices.
+     */
+    public inline fun forEach(action: (Future<T>) -> Unit) {
+        for (index in 0 until size) action(Future<T>(first + index))
+    }
+
+    /**
+     * Returns list with all the futures in the range.
+     */
+    public fun toList(): List<Future<T>> = List(size) { Future<T>(first + it) }
+
+    override public fun toString(): String = "futures $first..${first + size - 1}"
+}
 
 @Deprecated("Use 'waitForMultipleFutures' top-level function instead", ReplaceWith("waitForMultipleFutures(this, millis)"), DeprecationLevel.ERROR)
 public fun <T> Collection<Future<T>>.waitForMultipleFutures(millis: Int): Set<Future<T>> = waitForMultipleFutures(this, millis)
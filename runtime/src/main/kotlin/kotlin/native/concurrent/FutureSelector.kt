@@ -0,0 +1,65 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+/**
+ * Set of futures, which returns futures as they complete.
+ *
+ * Unlike [waitForMultipleFutures], which has to check every future after each completion in the process,
+ * selector is notified only by the futures registered in it, so waiting for many futures is proportional to
+ * the number of completions. Selector could be used from any worker, and must be closed once not needed.
+ */
+@Suppress("NON_PUBLIC_PRIMARY_CONSTRUCTOR_OF_INLINE_CLASS")
+public inline class FutureSelector<T> @PublishedApi internal constructor(val id: Int) {
+    companion object {
+        /**
+         * Create new empty selector.
+         */
+        public fun <T> create(): FutureSelector<T> = FutureSelector(createSelectorInternal())
+    }
+
+    /**
+     * Register [future] in the selector. Already completed future is available for [select] right away.
+     *
+     * @throws [IllegalStateException] if the selector is closed or the future is in [FutureState.INVALID] state.
+     */
+    public fun register(future: Future<T>): Unit = registerInSelectorInternal(id, future.id)
+
+    /**
+     * Register all the [futures] in the selector.
+     */
+    public fun registerAll(futures: Collection<Future<T>>) {
+        for (future in futures) register(future)
+    }
+
+    /**
+     * Number of registered futures not yet returned by [select].
+     */
+    public val pending: Int
+        get() = pendingInSelectorInternal(id)
+
+    /**
+     * Wait until some registered future completes, and return all the futures completed since the last call,
+     * in order of completion. Completed futures are no longer tracked by the selector, and could be consumed.
+     * Returns immediately if no futures are pending.
+     *
+     * @param timeoutMillis how long to wait in milliseconds, waits forever if -1.
+     * @return completed futures, empty if timeout elapsed.
+     * @throws [IllegalStateException] if the selector is closed.
+     */
+    public fun select(timeoutMillis: Int = -1): List<Future<T>> {
+        if (timeoutMillis < -1) throw IllegalArgumentException("Timeout must be non-negative or -1")
+        val ready = selectInternal(id, timeoutMillis)
+        return List(ready.size) { Future<T>(ready[it]) }
+    }
+
+    /**
+     * Close the selector. Registered futures are not affected.
+     */
+    public fun close(): Unit = closeSelectorInternal(id)
+
+    override public fun toString(): String = "future selector $id"
+}
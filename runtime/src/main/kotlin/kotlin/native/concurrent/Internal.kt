@@ -27,6 +27,24 @@ external internal fun waitForAnyFuture(versionToken: Int, millis: Int): Boolean
 @SymbolName("Kotlin_Worker_versionToken")
 external internal fun versionToken(): Int
 
+@SymbolName("Kotlin_Worker_onCompleteInternal")
+external internal fun onCompleteInternal(id: Int, workerId: Int, operation: () -> Unit)
+
+@SymbolName("Kotlin_FutureSelector_createInternal")
+external internal fun createSelectorInternal(): Int
+
+@SymbolName("Kotlin_FutureSelector_registerInternal")
+external internal fun registerInSelectorInternal(id: Int, futureId: Int)
+
+@SymbolName("Kotlin_FutureSelector_selectInternal")
+external internal fun selectInternal(id: Int, millis: Int): IntArray
+
+@SymbolName("Kotlin_FutureSelector_pendingInternal")
+external internal fun pendingInSelectorInternal(id: Int): Int
+
+@SymbolName("Kotlin_FutureSelector_closeInternal")
+external internal fun closeSelectorInternal(id: Int)
+
 @kotlin.native.internal.ExportForCompiler
 internal fun executeImpl(worker: Worker, mode: TransferMode, producer: () -> Any?,
                          job: CPointer<CFunction<*>>): Future<Any?> =
@@ -35,6 +53,16 @@ internal fun executeImpl(worker: Worker, mode: TransferMode, producer: () -> Any
 @SymbolName("Kotlin_Worker_startInternal")
 external internal fun startInternal(errorReporting: Boolean, name: String?): Int
 
+@SymbolName("Kotlin_Worker_startWithOptionsInternal")
+external internal fun startWithOptionsInternal(
+        errorReporting: Boolean, name: String?, cpus: IntArray?, numaNode: Int, stackSize: Long, priority: Int): Int
+
+@SymbolName("Kotlin_Worker_cpusInternal")
+external internal fun cpusInternal(node: Int): IntArray
+
+@SymbolName("Kotlin_Worker_numaNodesInternal")
+external internal fun numaNodesInternal(): Int
+
 @SymbolName("Kotlin_Worker_currentInternal")
 external internal fun currentInternal(): Int
 
@@ -45,8 +73,15 @@ external internal fun requestTerminationInternal(id: Int, processScheduledJobs:
 external internal fun executeInternal(
         id: Int, mode: Int, producer: () -> Any?, job: CPointer<CFunction<*>>): Int
 
+@SymbolName("Kotlin_Worker_executeBatchInternal")
+external internal fun executeBatchInternal(
+        id: Int, mode: Int, count: Int, producer: (Int) -> Any?, job: (Any?) -> Any?): Int
+
 @SymbolName("Kotlin_Worker_executeAfterInternal")
-external internal fun executeAfterInternal(id: Int, operation: () -> Unit, afterMicroseconds: Long): Unit
+external internal fun executeAfterInternal(id: Int, operation: () -> Unit, afterMicroseconds: Long): Long
+
+@SymbolName("Kotlin_Worker_cancelDelayedInternal")
+external internal fun cancelDelayedInternal(id: Int, handle: Long): Boolean
 
 @SymbolName("Kotlin_Worker_processQueueInternal")
 external internal fun processQueueInternal(id: Int): Boolean
@@ -68,6 +103,28 @@ internal fun ThrowWorkerInvalidState(): Unit =
 @ExportForCppRuntime
 internal fun WorkerLaunchpad(function: () -> Any?) = function()
 
+@ExportForCppRuntime
+internal fun WorkerPoolProducerLaunchpad(producer: (Int) -> Any?, index: Int) = producer(index)
+
+@ExportForCppRuntime
+internal fun WorkerPoolJobLaunchpad(job: (Any?) -> Any?, argument: Any?) = job(argument)
+
+@SymbolName("Kotlin_WorkerPool_startInternal")
+external internal fun startPoolInternal(size: Int, errorReporting: Boolean): Int
+
+@SymbolName("Kotlin_WorkerPool_sizeInternal")
+external internal fun poolSizeInternal(id: Int): Int
+
+@SymbolName("Kotlin_WorkerPool_executeBatchInternal")
+external internal fun executeBatchInPoolInternal(
+        id: Int, mode: Int, count: Int, producer: (Int) -> Any?, job: (Any?) -> Any?): Int
+
+@SymbolName("Kotlin_WorkerPool_awaitInternal")
+external internal fun awaitInPoolInternal(id: Int, futureId: Int)
+
+@SymbolName("Kotlin_WorkerPool_terminateInternal")
+external internal fun terminatePoolInternal(id: Int)
+
 @PublishedApi
 @SymbolName("Kotlin_Worker_detachObjectGraphInternal")
 external internal fun detachObjectGraphInternal(mode: Int, producer: () -> Any?): NativePtr
@@ -76,6 +133,12 @@ external internal fun detachObjectGraphInternal(mode: Int, producer: () -> Any?)
 @SymbolName("Kotlin_Worker_attachObjectGraphInternal")
 external internal fun attachObjectGraphInternal(stable: NativePtr): Any?
 
+@SymbolName("Kotlin_Worker_detachObjectRegionInternal")
+external internal fun detachObjectRegionInternal(mode: Int, producer: () -> Any?): NativePtr
+
+@SymbolName("Kotlin_Worker_consumeObjectRegionInternal")
+external internal fun consumeObjectRegionInternal(region: NativePtr, consumer: (Any?) -> Any?): Any?
+
 @SymbolName("Kotlin_Worker_freezeInternal")
 internal external fun freezeInternal(it: Any?)
 
@@ -6,6 +6,7 @@
 package kotlin.native.concurrent
 
 import kotlin.native.internal.Frozen
+import kotlin.native.SymbolName
 
 @ThreadLocal
 private object CurrentThread {
@@ -16,10 +17,12 @@ private object CurrentThread {
 internal class Lock {
     private val locker_ = AtomicInt(0)
     private val reenterCount_ = AtomicInt(0)
+    // Number of threads parked waiting for the lock.
+    private val waiters_ = AtomicInt(0)
 
-    // TODO: make it properly reschedule instead of spinning.
     fun lock() {
         val lockData = CurrentThread.id.hashCode()
+        var attempt = 0
         loop@ do {
             val old = locker_.compareAndSwap(0, lockData)
             when (old) {
@@ -34,6 +37,8 @@ internal class Lock {
                     break@loop
                 }
             }
+            // Spin with backoff first, and then park until the owner unlocks.
+            waitWhileLocked(locker_, waiters_, old, attempt++)
         } while (true)
     }
 
@@ -44,10 +49,17 @@ internal class Lock {
             val lockData = CurrentThread.id.hashCode()
             val old = locker_.compareAndSwap(lockData, 0)
             assert(old == lockData)
+            wakeWaiter(locker_, waiters_)
         }
     }
 }
 
+@SymbolName("Kotlin_Lock_waitWhileLocked")
+private external fun waitWhileLocked(locker: AtomicInt, waiters: AtomicInt, lockData: Int, attempt: Int)
+
+@SymbolName("Kotlin_Lock_wakeWaiter")
+private external fun wakeWaiter(locker: AtomicInt, waiters: AtomicInt)
+
 internal inline fun <R> locked(lock: Lock, block: () -> R): R {
     lock.lock()
     try {
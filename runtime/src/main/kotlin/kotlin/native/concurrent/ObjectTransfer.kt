@@ -86,3 +86,42 @@ public inline fun <reified T> DetachedObjectGraph<T>.attach(): T {
     val result = attachObjectGraphInternal(rawStable) as T
     return result
 }
+
+/**
+ * Detached object region keeps an object graph allocated in an arena of its own instead of the heap.
+ * Region objects are not reference counted, so the region is passed to another worker as a whole in constant
+ * time, and then released at once by [consume], regardless of the graph size.
+ * Region objects cannot be frozen, and references to them must not outlive the region.
+ */
+@Frozen
+public class DetachedObjectRegion<T> internal constructor(pointer: NativePtr) {
+    internal val region = AtomicNativePtr(pointer)
+
+    /**
+     * Runs [producer], placing all objects it allocates into a new region, and seals the region with the result
+     * as its root. Singletons initialized by [producer] are allocated in the heap though.
+     * In [TransferMode.SAFE] mode region objects are checked to refer only to each other, permanent
+     * and frozen objects, which takes time linear in the region size, and not to be referred from the heap,
+     * for instance, if [producer] adds them to an existing collection. [TransferMode.UNSAFE] skips the checks.
+     * If [producer] throws, the region is released, and exception allocated in the region is replaced
+     * with [IllegalStateException].
+     */
+    public constructor(mode: TransferMode = TransferMode.SAFE, producer: () -> T)
+        : this(detachObjectRegionInternal(mode.value, producer as () -> Any?))
+}
+
+/**
+ * Passes the root of the region created by [DetachedObjectRegion] to [block], and then releases the region
+ * along with all its objects. If [block] keeps references to region objects anywhere, or returns one directly
+ * or via other objects, the region is never released, and [IllegalStateException] is thrown.
+ * Region can only be consumed once.
+ */
+public fun <T, R> DetachedObjectRegion<T>.consume(block: (T) -> R): R {
+    var pointer: NativePtr
+    do {
+        pointer = region.value
+    } while (!region.compareAndSet(pointer, NativePtr.NULL))
+    if (pointer == NativePtr.NULL) throw IllegalStateException("Region is already consumed")
+    @Suppress("UNCHECKED_CAST")
+    return consumeObjectRegionInternal(pointer, block as (Any?) -> Any?) as R
+}
@@ -41,6 +41,24 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
         public fun start(errorReporting: Boolean = true, name: String? = null): Worker
                 = Worker(startInternal(errorReporting, name))
 
+        /**
+         * Start new worker, like [start] does, with thread placement and scheduling controlled by [options].
+         *
+         * @param errorReporting controls if an uncaught exceptions in the worker will be printed out
+         * @param name defines the optional name of this worker, if none - default naming is used.
+         * @param options CPU affinity, NUMA node, stack size and priority of the worker thread.
+         * @return worker object, usable across multiple concurrent contexts.
+         * @throws [IllegalArgumentException] if CPU or NUMA node is not available to the process,
+         *   or other option is out of range.
+         */
+        public fun start(errorReporting: Boolean = true, name: String? = null, options: WorkerOptions): Worker
+                = Worker(startWithOptionsImpl(errorReporting, name, options))
+
+        /**
+         * Return CPUs and NUMA nodes available to the process, to distribute workers with [WorkerOptions].
+         */
+        public fun cpuTopology(): CpuTopology = cpuTopologyImpl()
+
         /**
          * Return the current worker. Worker context is accessible to any valid Kotlin context,
          * but only actual active worker produced with [Worker.start] automatically processes execution requests.
@@ -96,6 +114,24 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
              */
             throw RuntimeException("Shall not be called directly")
 
+    /**
+     * Plan [count] jobs for execution in the worker at once, argument of job with index `i` is produced
+     * by `producer(i)`. Arguments are checked for being an isolated object subgraph with a single
+     * reachability analysis, so they may share objects with each other, but not with the rest of the caller's
+     * object graph, and all the jobs are queued with a single wakeup of the worker.
+     * Unlike [execute], [job] is an ordinary lambda, so it must be frozen.
+     *
+     * @return range of the futures with the computation results, in the order of indices.
+     * @throws [IllegalArgumentException] if [count] is not positive.
+     * @throws [IllegalStateException] if [job] is not frozen, or arguments cannot be transferred.
+     */
+    public fun <T1, T2> executeBatch(mode: TransferMode, count: Int, producer: (Int) -> T1, job: (T1) -> T2): FutureRange<T2> {
+        if (count <= 0) throw IllegalArgumentException("Number of jobs must be positive")
+        if (!job.isFrozen) throw IllegalStateException("Job for the worker must be frozen")
+        @Suppress("UNCHECKED_CAST")
+        return FutureRange(executeBatchInternal(id, mode.value, count, producer, job as (Any?) -> Any?), count)
+    }
+
     /**
      * Plan job for further execution in the worker. [operation] parameter must be either frozen, or execution to be
      * planned on the current worker. Otherwise [IllegalStateException] will be thrown.
@@ -105,10 +141,27 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
      * @throws [IllegalStateException] if [operation] parameter is not frozen and worker is not current.
      */
     public fun executeAfter(afterMicroseconds: Long = 0, operation: () -> Unit): Unit {
+        checkExecuteAfter(afterMicroseconds, operation)
+        executeAfterInternal(id, operation, afterMicroseconds)
+    }
+
+    /**
+     * Same as [executeAfter], but the planned job could be cancelled before it is executed.
+     *
+     * @param afterMicroseconds defines after how many microseconds delay execution shall happen, 0 means immediately,
+     * @return handle allowing to cancel the delayed execution.
+     * @throws [IllegalArgumentException] on negative values of [afterMicroseconds].
+     * @throws [IllegalStateException] if [operation] parameter is not frozen and worker is not current.
+     */
+    public fun executeAfterCancellable(afterMicroseconds: Long = 0, operation: () -> Unit): DelayedJob {
+        checkExecuteAfter(afterMicroseconds, operation)
+        return DelayedJob(this, executeAfterInternal(id, operation, afterMicroseconds))
+    }
+
+    private fun checkExecuteAfter(afterMicroseconds: Long, operation: () -> Unit) {
         val current = currentInternal()
         if (current != id && !operation.isFrozen) throw IllegalStateException("Job for another worker must be frozen")
         if (afterMicroseconds < 0) throw IllegalArgumentException("Timeout parameter must be non-negative")
-        executeAfterInternal(id, operation, afterMicroseconds)
     }
 
     /**
@@ -169,6 +222,22 @@ public inline class Worker @PublishedApi internal constructor(val id: Int) {
     public fun asCPointer() : COpaquePointer? = id.toLong().toCPointer()
 }
 
+/**
+ * Handle of the job scheduled with [Worker.executeAfterCancellable]. Could be passed to other workers.
+ */
+@Frozen
+public class DelayedJob internal constructor(val worker: Worker, private val handle: Long) {
+    /**
+     * Cancel the job, if it is not executed yet. Jobs scheduled without delay cannot be cancelled.
+     *
+     * @return `true` if the job was cancelled, and `false` if it is already executed or is being executed,
+     * or if the worker is terminated.
+     */
+    public fun cancel(): Boolean = cancelDelayedInternal(worker.id, handle)
+
+    override public fun toString(): String = "Delayed job on $worker"
+}
+
 /**
  * Executes [block] with new [Worker] as resource, by starting the new worker, calling provided [block]
  * (in current context) with newly started worker as [this] and terminating worker after the block completes.
@@ -0,0 +1,48 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+/**
+ * Placement and scheduling parameters of the thread started with [Worker.start].
+ * Options are applied by the worker thread before it initializes the runtime, so memory of the worker,
+ * allocated after that, is local to [numaNode] when one is specified.
+ * CPU affinity and NUMA binding are only supported on Linux and Android, and ignored elsewhere.
+ * Options not permitted by the operating system, such as raising priority without privileges, are ignored.
+ *
+ * @param cpus CPUs the worker may run on, as listed by [CpuTopology.cpus], or `null` for no restriction.
+ * @param numaNode NUMA node to run on and to allocate memory from, or -1 for no binding.
+ * @param stackSize size of the worker thread stack in bytes, or 0 for the platform default.
+ * @param priority scheduling priority as a nice value from -20 (highest) to 19 (lowest),
+ *   or `null` to inherit the priority of the starting thread.
+ */
+public class WorkerOptions(
+        val cpus: IntArray? = null,
+        val numaNode: Int = -1,
+        val stackSize: Long = 0,
+        val priority: Int? = null
+)
+
+/**
+ * CPUs and NUMA nodes available to the process, see [Worker.cpuTopology].
+ * For example, to have a worker per core:
+ * ```
+ * val workers = Worker.cpuTopology().cpus.map { Worker.start(options = WorkerOptions(cpus = intArrayOf(it))) }
+ * ```
+ *
+ * @property cpus all CPUs the process may run on.
+ * @property nodes CPUs of each NUMA node, indexed by node. Machine without NUMA is seen as a single node.
+ */
+public class CpuTopology internal constructor(val cpus: IntArray, val nodes: List<IntArray>) {
+    override public fun toString(): String =
+            "CpuTopology(cpus=${cpus.size}, nodes=${nodes.joinToString { it.contentToString() }})"
+}
+
+internal fun cpuTopologyImpl(): CpuTopology =
+        CpuTopology(cpusInternal(-1), List(numaNodesInternal()) { cpusInternal(it) })
+
+internal fun startWithOptionsImpl(errorReporting: Boolean, name: String?, options: WorkerOptions): Int =
+        startWithOptionsInternal(errorReporting, name, options.cpus, options.numaNode, options.stackSize,
+                options.priority ?: Int.MIN_VALUE)
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.concurrent
+
+/**
+ * Pool of threads for CPU-bound jobs.
+ *
+ * Unlike [Worker], which processes its jobs one by one in the order of submission, the pool balances
+ * jobs between its threads: every thread has its own deque of jobs, and idle threads steal jobs
+ * from random busy ones. Jobs submitted from the pool's own jobs are put to the deque of the current thread,
+ * so nested parallelism is cheap.
+ *
+ * Job arguments and results are transferred the same way as for [Worker.execute], results are available
+ * via regular [Future]s, so [waitForMultipleFutures] works for them as well. Job functions are shared
+ * between threads, so they must be frozen.
+ */
+@Suppress("NON_PUBLIC_PRIMARY_CONSTRUCTOR_OF_INLINE_CLASS")
+public inline class WorkerPool @PublishedApi internal constructor(val id: Int) {
+    companion object {
+        /**
+         * Start new pool of threads.
+         *
+         * @param size number of threads in the pool, if not positive - number of available processors.
+         * @param errorReporting controls if uncaught exceptions in the jobs will be printed out.
+         * @return pool object, usable across multiple concurrent contexts.
+         */
+        public fun start(size: Int = 0, errorReporting: Boolean = true): WorkerPool =
+                WorkerPool(startPoolInternal(size, errorReporting))
+    }
+
+    /**
+     * Number of threads in the pool.
+     *
+     * @throws [IllegalStateException] if the pool is terminated.
+     */
+    public val size: Int
+        get() = poolSizeInternal(id)
+
+    /**
+     * Plan job for execution in the pool. Result of [producer] is transferred to the pool as
+     * with [Worker.execute].
+     *
+     * @return the future with the computation result of [job].
+     * @throws [IllegalStateException] if [job] is not frozen or the pool is terminated.
+     */
+    public fun <T1, T2> execute(mode: TransferMode, producer: () -> T1, job: (T1) -> T2): Future<T2> =
+            executeBatch(mode, 1, { producer() }, job)[0]
+
+    /**
+     * Plan [count] jobs for execution in the pool at once, argument of job with index `i` is produced
+     * by `producer(i)` and transferred to the pool as with [Worker.execute].
+     * This is cheaper than submitting jobs one by one.
+     *
+     * @return futures with the computation results, in the order of indices.
+     * @throws [IllegalArgumentException] if [count] is not positive.
+     * @throws [IllegalStateException] if [job] is not frozen or the pool is terminated.
+     */
+    public fun <T1, T2> executeBatch(mode: TransferMode, count: Int, producer: (Int) -> T1, job: (T1) -> T2): List<Future<T2>> {
+        if (count <= 0) throw IllegalArgumentException("Number of jobs must be positive")
+        if (!job.isFrozen) throw IllegalStateException("Job for the worker pool must be frozen")
+        @Suppress("UNCHECKED_CAST")
+        val first = executeBatchInPoolInternal(id, mode.value, count, producer, job as (Any?) -> Any?)
+        return List(count) { Future<T2>(first + it) }
+    }
+
+    /**
+     * Wait for the result of [future]. Being called from the pool's job, runs other jobs of the pool while
+     * waiting, so that jobs waiting for nested jobs do not block the pool.
+     */
+    public fun <T> await(future: Future<T>): T {
+        awaitInPoolInternal(id, future.id)
+        return future.result
+    }
+
+    /**
+     * Execute [body] for every index in [range] in parallel, and wait for all of them to complete.
+     * Indices are split into chunks of at least [grainSize] indices, to amortize the cost of scheduling.
+     *
+     * @throws [IllegalStateException] if [body] is not frozen, or failed for some index.
+     */
+    public fun parallelFor(range: IntRange, grainSize: Int = 1, body: (Int) -> Unit) {
+        if (range.isEmpty()) return
+        if (!body.isFrozen) throw IllegalStateException("Job for the worker pool must be frozen")
+        val job = { chunk: IntRange -> for (index in chunk) body(index) }.freeze()
+        awaitAll(executeChunks(range, grainSize, job)) {}
+    }
+
+    /**
+     * Apply [transform] to every index in [range] in parallel, and return the results in the order of indices.
+     * Indices are split into chunks of at least [grainSize] indices, to amortize the cost of scheduling.
+     * Results are transferred from the pool as with [TransferMode.SAFE].
+     *
+     * @throws [IllegalStateException] if [transform] is not frozen, or failed for some index.
+     */
+    public fun <T> parallelMap(range: IntRange, grainSize: Int = 1, transform: (Int) -> T): List<T> {
+        if (range.isEmpty()) return emptyList()
+        if (!transform.isFrozen) throw IllegalStateException("Job for the worker pool must be frozen")
+        val job = { chunk: IntRange -> chunk.map(transform) }.freeze()
+        val result = ArrayList<T>(range.last - range.first + 1)
+        awaitAll(executeChunks(range, grainSize, job)) { result.addAll(it) }
+        return result
+    }
+
+    // Consumes all the futures even if some of them failed, so that nothing is left in the runtime.
+    private inline fun <T> awaitAll(futures: List<Future<T>>, consumer: (T) -> Unit) {
+        var failure: IllegalStateException? = null
+        for (future in futures) {
+            try {
+                consumer(await(future))
+            } catch (e: IllegalStateException) {
+                if (failure == null) failure = e
+            }
+        }
+        if (failure != null) throw failure
+    }
+
+    private fun <T> executeChunks(range: IntRange, grainSize: Int, job: (IntRange) -> T): List<Future<T>> {
+        if (grainSize <= 0) throw IllegalArgumentException("Grain size must be positive")
+        val count = range.last.toLong() - range.first + 1
+        // Few chunks per thread is enough to balance the load.
+        val chunks = minOf((count + grainSize - 1) / grainSize, size * 4L).toInt()
+        val chunkSize = (count + chunks - 1) / chunks
+        val first = range.first
+        return executeBatch(TransferMode.SAFE, chunks, { index ->
+            val from = first + index * chunkSize
+            from.toInt()..minOf(from + chunkSize - 1, range.last.toLong()).toInt()
+        }, job)
+    }
+
+    /**
+     * Wait for all the submitted jobs to complete and stop the pool's threads.
+     *
+     * @throws [IllegalStateException] if the pool is already terminated, or if called from the pool's job.
+     */
+    public fun requestTermination(): Unit = terminatePoolInternal(id)
+
+    /**
+     * String representation of the pool.
+     */
+    override public fun toString(): String = "WorkerPool $id"
+}
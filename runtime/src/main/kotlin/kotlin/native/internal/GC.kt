@@ -85,6 +85,21 @@ object GC {
         get() = getThresholdAllocations()
         set(value) = setThresholdAllocations(value)
 
+    /**
+     * How many bytes of released containers the current thread keeps for reuse by later allocations.
+     * Zero disables reuse.
+     */
+    var containerCacheLimit: Long
+        get() = getContainerCacheLimit()
+        set(value) = setContainerCacheLimit(value)
+
+    /**
+     * How many bytes of released containers the current thread keeps for reuse now, never exceeds
+     * [containerCacheLimit].
+     */
+    val containerCacheSize: Long
+        get() = getContainerCacheSize()
+
     /**
      * If GC shall auto-tune thresholds, depending on how much time is spent in collection.
      */
@@ -100,6 +115,84 @@ object GC {
         get() = getCyclicCollectorEnabled()
         set(value) = setCyclicCollectorEnabled(value)
 
+    /**
+     * Number of threads analyzing the atomic rootset for cyclic garbage, zero if there is no cyclic collector.
+     * Rootset is split into partitions, which are analyzed by these threads in parallel.
+     * Threads are started once the first atomic reference is created.
+     * Non-positive values throw [IllegalArgumentException], too big values are clamped.
+     */
+    var cyclicCollectorThreads: Int
+        get() = getCyclicCollectorThreads()
+        set(value) = setCyclicCollectorThreads(value)
+
+    /**
+     * If trial deletion of local cycle candidates shall run on a background thread, so that
+     * GC pauses only include validation and release of the found cyclic garbage.
+     * Only supported in the strict memory model on platforms with threads,
+     * enabling it elsewhere throws [IllegalArgumentException].
+     */
+    var concurrentCycleCollection: Boolean
+        get() = getConcurrentCycleCollection()
+        set(value) = setConcurrentCycleCollection(value)
+
+    /**
+     * Desired maximal GC pause on the current thread in microseconds, zero (default) means pauses are not bounded.
+     * When set, cycle collection is split into slices spread over several collections, and GC threshold
+     * is tuned to keep pauses close to the target. Negative values throw [IllegalArgumentException].
+     */
+    var pauseTargetMicros: Long
+        get() = getPauseTarget()
+        set(value) = setPauseTarget(value)
+
+    /**
+     * If memory manager statistics of the current thread shall be collected, see [statistics].
+     * Disabling statistics resets all the counters.
+     */
+    var statisticsEnabled: Boolean
+        get() = getStatistics()
+        set(value) = setStatistics(value)
+
+    /**
+     * Returns snapshot of the memory manager statistics of the current thread.
+     * All the counters are zero, unless [statisticsEnabled] is set.
+     */
+    fun statistics(): GCStatistics {
+        val values = LongArray(GCStatistics.SIZE)
+        copyStatistics(values)
+        return GCStatistics(values)
+    }
+
+    /**
+     * Enables statistics on the current thread, and appends a JSON object describing each
+     * garbage collection to file at [path], one per line.
+     * Throws [IllegalArgumentException] if file cannot be opened. If writing fails later,
+     * an error is reported to the console and the stream is stopped.
+     */
+    @SymbolName("Kotlin_native_internal_GC_startStatisticsStream")
+    external fun startStatisticsStream(path: String)
+
+    /**
+     * Stops writing statistics started by [startStatisticsStream], statistics remain enabled.
+     */
+    @SymbolName("Kotlin_native_internal_GC_stopStatisticsStream")
+    external fun stopStatisticsStream()
+
+    /**
+     * Writes snapshot of the heap reachable from the current thread's stack, thread local and global
+     * references to file at [path], in a compact binary format, see `tools/scripts/heap_snapshot.py`
+     * for analysis. Throws [IllegalArgumentException] if file cannot be opened, and [IllegalStateException]
+     * if the snapshot cannot be written completely.
+     */
+    @SymbolName("Kotlin_native_internal_GC_dumpHeap")
+    external fun dumpHeap(path: String)
+
+    /**
+     * Returns given [percentile] (in range 0..100) of the recent GC pause durations on the current thread,
+     * in microseconds. Returns 0 if there were no collections yet.
+     */
+    @SymbolName("Kotlin_native_internal_GC_getPausePercentile")
+    external fun pausePercentileMicros(percentile: Double): Long
+
     @SymbolName("Kotlin_native_internal_GC_getThreshold")
     private external fun getThreshold(): Int
 
@@ -118,6 +211,15 @@ object GC {
     @SymbolName("Kotlin_native_internal_GC_setThresholdAllocations")
     private external fun setThresholdAllocations(value: Long)
 
+    @SymbolName("Kotlin_native_internal_GC_getContainerCacheLimit")
+    private external fun getContainerCacheLimit(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_setContainerCacheLimit")
+    private external fun setContainerCacheLimit(value: Long)
+
+    @SymbolName("Kotlin_native_internal_GC_getContainerCacheSize")
+    private external fun getContainerCacheSize(): Long
+
     @SymbolName("Kotlin_native_internal_GC_getTuneThreshold")
     private external fun getTuneThreshold(): Boolean
 
@@ -129,4 +231,31 @@ object GC {
 
     @SymbolName("Kotlin_native_internal_GC_setCyclicCollector")
     private external fun setCyclicCollectorEnabled(value: Boolean)
-}
\ No newline at end of file
+
+    @SymbolName("Kotlin_native_internal_GC_getCyclicCollectorThreads")
+    private external fun getCyclicCollectorThreads(): Int
+
+    @SymbolName("Kotlin_native_internal_GC_setCyclicCollectorThreads")
+    private external fun setCyclicCollectorThreads(value: Int)
+
+    @SymbolName("Kotlin_native_internal_GC_getPauseTarget")
+    private external fun getPauseTarget(): Long
+
+    @SymbolName("Kotlin_native_internal_GC_setPauseTarget")
+    private external fun setPauseTarget(value: Long)
+
+    @SymbolName("Kotlin_native_internal_GC_getStatistics")
+    private external fun getStatistics(): Boolean
+
+    @SymbolName("Kotlin_native_internal_GC_setStatistics")
+    private external fun setStatistics(value: Boolean)
+
+    @SymbolName("Kotlin_native_internal_GC_copyStatistics")
+    private external fun copyStatistics(values: LongArray)
+
+    @SymbolName("Kotlin_native_internal_GC_getConcurrentCycleCollection")
+    private external fun getConcurrentCycleCollection(): Boolean
+
+    @SymbolName("Kotlin_native_internal_GC_setConcurrentCycleCollection")
+    private external fun setConcurrentCycleCollection(value: Boolean)
+}
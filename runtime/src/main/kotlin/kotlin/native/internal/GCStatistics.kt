@@ -0,0 +1,73 @@
+/*
+ * Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+ * that can be found in the LICENSE file.
+ */
+
+package kotlin.native.internal
+
+/**
+ * Snapshot of the memory manager statistics of the current thread, see [GC.statistics].
+ * All durations are in microseconds.
+ */
+class GCStatistics internal constructor(private val values: LongArray) {
+    /** Number of garbage collections. */
+    val collections: Long get() = values[0]
+    /** Number of garbage collections, which also collected cycles. */
+    val cycleCollections: Long get() = values[1]
+    /** Total duration of garbage collection pauses. */
+    val totalPauseMicros: Long get() = values[2]
+    /** Longest garbage collection pause. */
+    val maxPauseMicros: Long get() = values[3]
+    /** Total time spent processing enqueued decrements of reference counters. */
+    val processDecrementsMicros: Long get() = values[4]
+    /** Total time spent releasing references from the stack. */
+    val decrementStackMicros: Long get() = values[5]
+    /** Total time spent destroying released objects. */
+    val finalizerQueueMicros: Long get() = values[6]
+    /** Total time spent collecting cyclic garbage. */
+    val collectCyclesMicros: Long get() = values[7]
+    /** How many times GC threshold was increased by autotuning. */
+    val thresholdAdjustments: Long get() = values[8]
+    /** How many times GC collect cycles threshold was increased by autotuning. */
+    val collectCyclesThresholdAdjustments: Long get() = values[9]
+    /** Number of allocated containers. */
+    val allocatedContainers: Long get() = values[10]
+    /** Number of bytes in allocated containers. */
+    val allocatedBytes: Long get() = values[11]
+    /** Number of containers, which memory was freed. */
+    val freedContainers: Long get() = values[12]
+    /** Reference counter increments of thread-local objects. */
+    val addRefs: Long get() = values[13]
+    /** Reference counter increments of frozen or shared objects, which require atomic operations. */
+    val atomicAddRefs: Long get() = values[14]
+    /** Reference counter decrements of thread-local objects. */
+    val releaseRefs: Long get() = values[15]
+    /** Reference counter decrements of frozen or shared objects, which require atomic operations. */
+    val atomicReleaseRefs: Long get() = values[16]
+    /** Number of containers placed in the nursery, included in [allocatedContainers]. */
+    val nurseryContainers: Long get() = values[17]
+    /** Number of nursery chunks allocated to replace the full ones still holding live containers. */
+    val nurseryChunks: Long get() = values[18]
+    /** How many times a full nursery chunk with no live containers was reused. */
+    val nurseryResets: Long get() = values[19]
+    /** Number of full nursery chunks of all threads, currently kept by their live containers. */
+    val retiredNurseryChunks: Long get() = values[20]
+
+    /**
+     * Number of allocated containers by size: element `i` counts containers of up to `16 shl i` bytes,
+     * the last element counts all bigger containers.
+     */
+    val allocationHistogram: LongArray
+        get() = values.copyOfRange(ALLOCATION_HISTOGRAM, SIZE)
+
+    override fun toString() =
+            "GCStatistics(collections=$collections, cycleCollections=$cycleCollections, " +
+            "totalPauseMicros=$totalPauseMicros, maxPauseMicros=$maxPauseMicros, " +
+            "allocatedContainers=$allocatedContainers, allocatedBytes=$allocatedBytes)"
+
+    internal companion object {
+        // Keep in sync with GcStatisticIndex in Memory.cpp.
+        const val ALLOCATION_HISTOGRAM = 21
+        const val SIZE = ALLOCATION_HISTOGRAM + 13
+    }
+}
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+#
+# Copyright 2010-2020 JetBrains s.r.o. Use of this source code is governed by the Apache 2.0 license
+# that can be found in the LICENSE file.
+#
+
+"""
+Analyzer for heap snapshots written by kotlin.native.internal.GC.dumpHeap().
+
+Computes dominator tree of the snapshot and prints containers retaining most of the memory,
+along with the per type census. Container A dominates container B if every path from roots to B
+goes through A, so retained size of A is what would be released together with A.
+
+Usage: heap_snapshot.py [--top N] snapshot.bin
+"""
+
+import argparse
+import sys
+from collections import defaultdict
+
+MAGIC = b"KNHEAP01"
+
+TAG_END = 0
+TAG_TYPE = 1
+TAG_CONTAINER = 2
+TAG_ROOT = 3
+
+ROOT_KINDS = {1: "stack", 2: "thread local", 3: "global"}
+
+FLAG_FROZEN = 1
+FLAG_SHARED = 2
+FLAG_AGGREGATING = 4
+
+
+class Snapshot:
+    def __init__(self):
+        self.types = {}
+        # Indexed by container id, id 0 is the virtual root referring to all the roots.
+        self.type_of = [None]
+        self.shallow = [0]
+        self.ref_count = [0]
+        self.flags = [0]
+        self.refs = [[]]
+        self.root_kinds = defaultdict(set)
+
+    def ensure(self, id):
+        while len(self.refs) <= id:
+            self.type_of.append(None)
+            self.shallow.append(0)
+            self.ref_count.append(0)
+            self.flags.append(0)
+            self.refs.append([])
+
+    def name(self, id):
+        if id == 0:
+            return "<roots>"
+        return self.types.get(self.type_of[id], "<unknown>")
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.position = 0
+
+    def byte(self):
+        value = self.data[self.position]
+        self.position += 1
+        return value
+
+    def varint(self):
+        result = 0
+        shift = 0
+        while True:
+            value = self.byte()
+            result |= (value & 0x7f) << shift
+            if value < 0x80:
+                return result
+            shift += 7
+
+    def bytes(self, size):
+        value = self.data[self.position:self.position + size]
+        self.position += size
+        return value
+
+
+def parse(data):
+    if data[:len(MAGIC)] != MAGIC:
+        raise ValueError("not a heap snapshot")
+    reader = Reader(data)
+    reader.position = len(MAGIC)
+    snapshot = Snapshot()
+    while True:
+        tag = reader.byte()
+        if tag == TAG_END:
+            return snapshot
+        elif tag == TAG_TYPE:
+            type_id = reader.varint()
+            snapshot.types[type_id] = reader.bytes(reader.varint()).decode("utf-8", "replace")
+        elif tag == TAG_CONTAINER:
+            id = reader.varint()
+            snapshot.ensure(id)
+            snapshot.type_of[id] = reader.varint()
+            snapshot.shallow[id] = reader.varint()
+            snapshot.ref_count[id] = reader.varint()
+            snapshot.flags[id] = reader.byte()
+            snapshot.refs[id] = [reader.varint() for _ in range(reader.varint())]
+        elif tag == TAG_ROOT:
+            kind = reader.byte()
+            id = reader.varint()
+            snapshot.ensure(id)
+            if not snapshot.root_kinds[id]:
+                snapshot.refs[0].append(id)
+            snapshot.root_kinds[id].add(ROOT_KINDS.get(kind, str(kind)))
+        else:
+            raise ValueError("unknown record %d at offset %d" % (tag, reader.position - 1))
+
+
+def dominators(snapshot):
+    """Cooper, Harvey, Kennedy: "A Simple, Fast Dominance Algorithm"."""
+    count = len(snapshot.refs)
+    # Iterative DFS computing postorder numbers.
+    order = []
+    postorder = [-1] * count
+    visited = [False] * count
+    visited[0] = True
+    stack = [(0, iter(snapshot.refs[0]))]
+    while stack:
+        node, children = stack[-1]
+        advanced = False
+        for child in children:
+            if not visited[child]:
+                visited[child] = True
+                stack.append((child, iter(snapshot.refs[child])))
+                advanced = True
+                break
+        if not advanced:
+            stack.pop()
+            postorder[node] = len(order)
+            order.append(node)
+    predecessors = [[] for _ in range(count)]
+    for node in order:
+        for child in snapshot.refs[node]:
+            predecessors[child].append(node)
+
+    idom = [-1] * count
+    idom[0] = 0
+
+    def intersect(a, b):
+        while a != b:
+            while postorder[a] < postorder[b]:
+                a = idom[a]
+            while postorder[b] < postorder[a]:
+                b = idom[b]
+        return a
+
+    changed = True
+    while changed:
+        changed = False
+        for node in reversed(order):
+            if node == 0:
+                continue
+            new_idom = -1
+            for predecessor in predecessors[node]:
+                if idom[predecessor] == -1:
+                    continue
+                new_idom = predecessor if new_idom == -1 else intersect(predecessor, new_idom)
+            if idom[node] != new_idom:
+                idom[node] = new_idom
+                changed = True
+    return order, idom
+
+
+def retained_sizes(snapshot, order, idom):
+    retained = list(snapshot.shallow)
+    # Postorder visits dominated nodes before their dominators.
+    for node in order:
+        if node != 0:
+            retained[idom[node]] += retained[node]
+    return retained
+
+
+def describe(snapshot, id):
+    flags = snapshot.flags[id]
+    attributes = []
+    if flags & FLAG_FROZEN:
+        attributes.append("frozen")
+    if flags & FLAG_SHARED:
+        attributes.append("shared")
+    if flags & FLAG_AGGREGATING:
+        attributes.append("aggregating")
+    attributes.extend(sorted(snapshot.root_kinds.get(id, ())))
+    suffix = " [%s]" % ", ".join(attributes) if attributes else ""
+    return "#%d %s rc=%d%s" % (id, snapshot.name(id), snapshot.ref_count[id], suffix)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Analyze Kotlin/Native heap snapshot.")
+    parser.add_argument("--top", type=int, default=20, help="number of entries to print")
+    parser.add_argument("snapshot")
+    args = parser.parse_args()
+
+    with open(args.snapshot, "rb") as file:
+        snapshot = parse(file.read())
+    order, idom = dominators(snapshot)
+    retained = retained_sizes(snapshot, order, idom)
+
+    print("Containers: %d, total size: %d bytes" % (len(order) - 1, retained[0]))
+
+    print("\nBiggest retainers:")
+    print("%12s %12s  %s" % ("retained", "shallow", "container (dominator)"))
+    nodes = sorted((node for node in order if node != 0), key=lambda node: -retained[node])
+    for node in nodes[:args.top]:
+        print("%12d %12d  %s (%s)" % (retained[node], snapshot.shallow[node], describe(snapshot, node),
+                                       "#%d" % idom[node] if idom[node] != 0 else "root"))
+
+    print("\nTypes:")
+    print("%10s %12s %12s  %s" % ("count", "shallow", "retained", "type"))
+    census = defaultdict(lambda: [0, 0, 0])
+    dominated = defaultdict(list)
+    for node in order:
+        if node != 0:
+            dominated[idom[node]].append(node)
+    # Walk the dominator tree, counting retained size only for the topmost containers of each type
+    # to avoid double counting, so track how many containers of each type are on the current path.
+    on_path = defaultdict(int)
+    stack = [(0, False)]
+    while stack:
+        node, leaving = stack.pop()
+        name = snapshot.name(node)
+        if leaving:
+            on_path[name] -= 1
+            continue
+        if node != 0:
+            entry = census[name]
+            entry[0] += 1
+            entry[1] += snapshot.shallow[node]
+            if on_path[name] == 0:
+                entry[2] += retained[node]
+        on_path[name] += 1
+        stack.append((node, True))
+        stack.extend((child, False) for child in dominated[node])
+    for name, (count, shallow, retained_by_type) in sorted(census.items(), key=lambda item: -item[1][2])[:args.top]:
+        print("%10d %12d %12d  %s" % (count, shallow, retained_by_type, name))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())